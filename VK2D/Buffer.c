@@ -18,8 +18,9 @@
 
 #include "VK2D/Renderer.h"
 #include "VK2D/Opaque.h"
+#include "VK2D/UploadBatch.h"
 
-VK2DBuffer vk2dBufferCreate(VK2DLogicalDevice dev, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags mem) {
+static VK2DBuffer _vk2dBufferCreate(VK2DLogicalDevice dev, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags mem, VmaAllocationCreateFlags flags, VmaAllocationInfo *allocationInfo, bool transferShared) {
 	VK2DRenderer gRenderer = vk2dRendererGetPointer();
 	if (gRenderer == NULL || vk2dStatusFatal())
 	    return NULL;
@@ -31,9 +32,16 @@ VK2DBuffer vk2dBufferCreate(VK2DLogicalDevice dev, VkDeviceSize size, VkBufferUs
 		buf->size = size;
 		buf->offset = 0;
 		VkBufferCreateInfo bufferCreateInfo = vk2dInitBufferCreateInfo(size, usage, &dev->pd->QueueFamily.graphicsFamily, 1);
+		uint32_t queueFamilies[] = {dev->pd->QueueFamily.graphicsFamily, dev->pd->QueueFamily.transferFamily};
+		if (transferShared && dev->transferQueue != VK_NULL_HANDLE) {
+			bufferCreateInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+			bufferCreateInfo.pQueueFamilyIndices = queueFamilies;
+			bufferCreateInfo.queueFamilyIndexCount = 2;
+		}
 		VmaAllocationCreateInfo allocationCreateInfo = {0};
 		allocationCreateInfo.requiredFlags = mem;
-		VkResult result = vmaCreateBuffer(gRenderer->vma, &bufferCreateInfo, &allocationCreateInfo, &buf->buf, &buf->mem, VK_NULL_HANDLE);
+		allocationCreateInfo.flags = flags;
+		VkResult result = vmaCreateBuffer(gRenderer->vma, &bufferCreateInfo, &allocationCreateInfo, &buf->buf, &buf->mem, allocationInfo);
 		if (result == VK_ERROR_OUT_OF_DEVICE_MEMORY) {
             vk2dRaise(VK2D_STATUS_OUT_OF_VRAM, "VMA out of video memory for buffer of size %0.2fkb.", (float)size / 1024.0f);
             free((void *)buf);
@@ -50,41 +58,31 @@ VK2DBuffer vk2dBufferCreate(VK2DLogicalDevice dev, VkDeviceSize size, VkBufferUs
 	return buf;
 }
 
-VK2DBuffer vk2dBufferLoad(VK2DLogicalDevice dev, VkDeviceSize size, VkBufferUsageFlags usage, void *data, bool mainThread) {
-	VK2DRenderer gRenderer = vk2dRendererGetPointer();
-    if (gRenderer == NULL || vk2dStatusFatal())
-        return NULL;
-
-	// Create staging buffer
-	VK2DBuffer stageBuffer = vk2dBufferCreate(dev,
-			size,
-			VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+VK2DBuffer vk2dBufferCreate(VK2DLogicalDevice dev, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags mem) {
+	return _vk2dBufferCreate(dev, size, usage, mem, 0, VK_NULL_HANDLE, false);
+}
 
-	if (stageBuffer == NULL)
-	    return NULL;
+VK2DBuffer vk2dBufferCreateTransferShared(VK2DLogicalDevice dev, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags mem) {
+	return _vk2dBufferCreate(dev, size, usage, mem, 0, VK_NULL_HANDLE, true);
+}
 
-	// Map data
-	void *location;
-	VkResult result = vmaMapMemory(gRenderer->vma, stageBuffer->mem, &location);
-	if (result != VK_SUCCESS) {
-	    vk2dRaise(VK2D_STATUS_VULKAN_ERROR, "Failed to map memory, VMA error %i.", result);
-	    vk2dBufferFree(stageBuffer);
-	    return NULL;
+VK2DBuffer vk2dBufferCreateMapped(VK2DLogicalDevice dev, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags mem, void **mapped, bool *coherent, bool transferShared) {
+	VK2DRenderer gRenderer = vk2dRendererGetPointer();
+	*mapped = NULL;
+	*coherent = false;
+	VmaAllocationInfo allocationInfo = {0};
+	VK2DBuffer buf = _vk2dBufferCreate(dev, size, usage, mem, VMA_ALLOCATION_CREATE_MAPPED_BIT, &allocationInfo, transferShared);
+	if (buf != NULL) {
+		VkMemoryPropertyFlags properties;
+		vmaGetAllocationMemoryProperties(gRenderer->vma, buf->mem, &properties);
+		*mapped = allocationInfo.pMappedData;
+		*coherent = (properties & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) != 0;
 	}
-	memcpy(location, data, size);
-	vmaUnmapMemory(gRenderer->vma, stageBuffer->mem);
-
-	// Create the actual vbo
-	VK2DBuffer ret = vk2dBufferCreate(dev,
-			size,
-			usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-	if (ret != NULL)
-	    vk2dBufferCopy(stageBuffer, ret, mainThread);
-	vk2dBufferFree(stageBuffer);
+	return buf;
+}
 
-	return ret;
+VK2DBuffer vk2dBufferLoad(VK2DLogicalDevice dev, VkDeviceSize size, VkBufferUsageFlags usage, void *data, bool mainThread) {
+	return vk2dBufferLoad2(dev, size, usage, data, 0, NULL, mainThread);
 }
 
 VK2DBuffer vk2dBufferLoad2(VK2DLogicalDevice dev, VkDeviceSize size, VkBufferUsageFlags usage, void *data, VkDeviceSize size2, void *data2, bool mainThread) {
@@ -92,36 +90,16 @@ VK2DBuffer vk2dBufferLoad2(VK2DLogicalDevice dev, VkDeviceSize size, VkBufferUsa
     if (gRenderer == NULL || vk2dStatusFatal())
         return NULL;
 
-	// Create staging buffer
-	VK2DBuffer stageBuffer = vk2dBufferCreate(dev,
-											  size + size2,
-											  VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-											  VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-	if (stageBuffer == NULL)
-	    return NULL;
-
-	// Map data
-	void *location;
-	VkResult result = vmaMapMemory(gRenderer->vma, stageBuffer->mem, &location);
-    if (result != VK_SUCCESS) {
-        vk2dRaise(VK2D_STATUS_VULKAN_ERROR, "Failed to map memory, VMA error %i.", result);
-        vk2dBufferFree(stageBuffer);
-        return NULL;
-    }
-	memcpy(location, data, size);
-	uint8_t *ll = location;
-	memcpy(ll + size, data2, size2);
-	vmaUnmapMemory(gRenderer->vma, stageBuffer->mem);
-
-	// Create the buffer
-	VK2DBuffer ret = vk2dBufferCreate(dev,
-									  size + size2,
-									  usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-									  VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-    if (ret != NULL)
-	    vk2dBufferCopy(stageBuffer, ret, mainThread);
-
-	vk2dBufferFree(stageBuffer);
+	// The data is staged in the device's staging ring, main thread uploads don't wait since anything
+	// that uses the buffer is submitted to the same queue after it
+	VK2DBuffer ret = NULL;
+	VK2DUploadBatch batch = vk2dUploadBatchCreate(dev, mainThread);
+	if (batch != NULL) {
+		ret = vk2dUploadBatchAddBuffer(batch, usage, data, size, data2, size2);
+		if (!mainThread)
+			vk2dUploadBatchFlush(batch);
+		vk2dUploadBatchFree(batch);
+	}
 
 	return ret;
 }
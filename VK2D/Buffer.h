@@ -19,12 +19,37 @@ extern "C" {
 /// \return Returns the new buffer or NULL if it failed
 VK2DBuffer vk2dBufferCreate(VK2DLogicalDevice dev, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags mem);
 
+/// \brief Creates a new buffer in host-visible memory that stays mapped for its whole lifetime
+/// \param dev Device to get the memory from (will use graphics indices)
+/// \param size Size in bytes of the new buffer
+/// \param usage How the buffer will be used
+/// \param mem Required memory properties, must include host visible
+/// \param mapped Will be filled with the host pointer to the buffer's memory
+/// \param coherent Will be filled with whether or not the memory is host coherent, if it isn't writes must be flushed with vmaFlushAllocation
+/// \param transferShared If true the buffer may also be used on the device's transfer queue without ownership transfers
+/// \return Returns the new buffer or NULL if it failed
+VK2DBuffer vk2dBufferCreateMapped(VK2DLogicalDevice dev, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags mem, void **mapped, bool *coherent, bool transferShared);
+
+/// \brief Creates a new buffer that may be used on both the graphics and transfer queues without ownership transfers
+/// \param dev Device to get the memory from
+/// \param size Size in bytes of the new buffer
+/// \param usage How the buffer will be used
+/// \param mem Required memory properties (device local, host visible, etc...)
+/// \return Returns the new buffer or NULL if it failed
+///
+/// This is the same as vk2dBufferCreate if the device has no transfer queue.
+VK2DBuffer vk2dBufferCreateTransferShared(VK2DLogicalDevice dev, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags mem);
+
 /// \brief Creates a buffer and loads some data into high-performance memory
 /// \param dev Device to get the memory from
 /// \param size Size in bytes of data
 /// \param usage Usage of the buffer
 /// \param data Data to put into high performance memory
+/// \param mainThread Whether or not this is called on the main thread
 /// \return Returns a new buffer with the data loaded or NULL if it failed
+///
+/// The data is staged in the logical device's staging ring. On the main thread this returns as
+/// soon as the copy is submitted, anything submitted to the main queue afterwards sees the data.
 VK2DBuffer vk2dBufferLoad(VK2DLogicalDevice dev, VkDeviceSize size, VkBufferUsageFlags usage, void *data, bool mainThread);
 
 /// \brief Creates a buffer and loads 2 pieces of data into the same high-performance buffer
@@ -34,6 +59,7 @@ VK2DBuffer vk2dBufferLoad(VK2DLogicalDevice dev, VkDeviceSize size, VkBufferUsag
 /// \param data Data to put into high performance memory
 /// \param size2 Size of the 2nd piece of data that will be put into the same buffer
 /// \param data2 Actual data2
+/// \param mainThread Whether or not this is called on the main thread
 /// \return Returns a new buffer with the data loaded or NULL if it failed
 VK2DBuffer vk2dBufferLoad2(VK2DLogicalDevice dev, VkDeviceSize size, VkBufferUsageFlags usage, void *data, VkDeviceSize size2, void *data2, bool mainThread);
 
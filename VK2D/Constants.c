@@ -30,6 +30,16 @@ const int32_t VK2D_PIPELINE_ID_NONE = INT32_MAX;
 
 const uint32_t VK2D_DEFAULT_ARRAY_EXTENSION = 5;
 
+const uint32_t VK2D_MINIMUM_BATCH_REGION = 1024;
+
+const uint32_t VK2D_DEFAULT_DRAW_QUEUE_SIZE = 1024;
+
+const uint32_t VK2D_DEFAULT_SHAPE_BATCH_SIZE = 1024;
+
+const VkDeviceSize VK2D_DESCRIPTOR_BUFFER_MAX_PAGE_SIZE = 64 * 1024 * 1024;
+
+const uint32_t VK2D_PIPELINE_CACHE_MAGIC = 0x504B3256; // "V2KP"
+
 const uint32_t VK2D_NO_LOCATION = UINT32_MAX;
 
 const VK2DTexture VK2D_TARGET_SCREEN = NULL;
@@ -38,6 +48,10 @@ const VK2DCameraIndex VK2D_DEFAULT_CAMERA = 0;
 
 const VK2DShadowObject VK2D_INVALID_SHADOW_OBJECT = -1;
 
+const VK2DSprite VK2D_INVALID_SPRITE = -1;
+
+const VK2DAssetGroup VK2D_INVALID_ASSET_GROUP = -1;
+
 const vec4 VK2D_DEFAULT_COLOUR_MOD = {1, 1, 1, 1};
 
 const float VK2D_CIRCLE_VERTICES = 72;
@@ -37,6 +37,21 @@ extern const int32_t VK2D_PIPELINE_ID_NONE;
 /// How many array slots to allocate at a time with realloc (to avoid constantly reallocating memory)
 extern const uint32_t VK2D_DEFAULT_ARRAY_EXTENSION;
 
+/// Minimum number of draw commands a sprite batch needs room for before it will start on a fresh descriptor buffer page instead of the tail of a used one
+extern const uint32_t VK2D_MINIMUM_BATCH_REGION;
+
+/// Number of draws the deferred draw queue has room for before it needs to grow
+extern const uint32_t VK2D_DEFAULT_DRAW_QUEUE_SIZE;
+
+/// Number of shapes the primitive batch has room for before it needs to grow
+extern const uint32_t VK2D_DEFAULT_SHAPE_BATCH_SIZE;
+
+/// Largest size descriptor buffer pages will grow to on their own, larger allocations still get oversize pages
+extern const VkDeviceSize VK2D_DESCRIPTOR_BUFFER_MAX_PAGE_SIZE;
+
+/// Identifies pipeline cache files written by VK2D
+extern const uint32_t VK2D_PIPELINE_CACHE_MAGIC;
+
 /// Used to specify that a variable is not present in a shader
 extern const uint32_t VK2D_NO_LOCATION;
 
@@ -53,6 +68,36 @@ extern const float VK2D_CIRCLE_VERTICES;
 /// Maximum number of frames to be processed at once - You generally want this and VK2D_DEVICE_COMMAND_POOLS to be the same
 #define VK2D_MAX_FRAMES_IN_FLIGHT 2
 
+/// Maximum number of long-lived dynamic uniform sets a descriptor buffer page keeps, one per layout/binding/range combination
+#define VK2D_DESCRIPTOR_BUFFER_DYNAMIC_SETS 8
+
+/// Number of assets that can wait in the loader threads' queue at once, must be a power of two
+#define VK2D_ASSET_QUEUE_SIZE 1024
+
+/// Maximum number of asset loader threads
+#define VK2D_MAX_LOAD_THREADS 16
+
+/// Starting size in bytes of the logical device's main thread staging ring
+#define VK2D_STAGING_RING_SIZE (8 * 1024 * 1024)
+
+/// Starting size in bytes of each loader thread's staging ring
+#define VK2D_LOAD_STAGING_RING_SIZE (4 * 1024 * 1024)
+
+/// Maximum number of submissions a staging ring tracks at once before it waits on the oldest
+#define VK2D_STAGING_RING_SPANS 32
+
+/// Alignment of each upload in a staging ring, must be a power of two
+#define VK2D_STAGING_RING_ALIGNMENT 16
+
+/// Number of assets a loader thread batches up before it submits their uploads
+#define VK2D_UPLOAD_BATCH_ASSETS 64
+
+/// How many assets per loader thread are moved from the load groups into the asset queue at a time
+#define VK2D_ASSET_QUEUE_AHEAD 2
+
+/// Maximum number of extra threads that compile pipelines in parallel when the renderer starts or resets
+#define VK2D_MAX_PIPELINE_WORKERS 7
+
 /// First 33 digits of pi
 #define VK2D_PI 3.14159265358979323846264338327950
 
@@ -70,6 +115,12 @@ extern const VK2DCameraIndex VK2D_DEFAULT_CAMERA;
 
 extern VK2DShadowObject VK2D_INVALID_SHADOW_OBJECT;
 
+/// Sprite handle representing no sprite, returned when a sprite batch is full
+extern const VK2DSprite VK2D_INVALID_SPRITE;
+
+/// Asset group handle representing no group, returned when nothing could be queued
+extern const VK2DAssetGroup VK2D_INVALID_ASSET_GROUP;
+
 /************************ Colours ************************/
 /// The colour black
 extern const vec4 VK2D_BLACK;
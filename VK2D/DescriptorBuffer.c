@@ -12,51 +12,155 @@
 
 #include <stdlib.h>
 
+// Usage every descriptor buffer page is created with
+static const VkBufferUsageFlags VK2D_DESCRIPTOR_BUFFER_USAGE = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
+
+// Memory that can be written by the host and read by the device without a copy
+static const VkMemoryPropertyFlags VK2D_DESCRIPTOR_BUFFER_DIRECT_MEMORY = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+
+// Largest device-local, host-visible heap that is assumed to be the small legacy BAR window on discrete GPUs
+static const VkDeviceSize VK2D_LEGACY_BAR_SIZE = 256 * 1024 * 1024;
+
+// Checks if pages can live in memory that is both device-local and host-visible, which is the case on integrated
+// GPUs, software implementations, and discrete GPUs with resizable BAR. The small BAR window discrete GPUs have
+// without resizable BAR is left alone since it's slow to read from and other things may need it.
+static bool _vk2dDescriptorBufferSupportsDirectWrite(VkDeviceSize pageSize) {
+    VK2DRenderer gRenderer = vk2dRendererGetPointer();
+    VkBufferCreateInfo bufferCreateInfo = vk2dInitBufferCreateInfo(pageSize, VK2D_DESCRIPTOR_BUFFER_USAGE, &gRenderer->pd->QueueFamily.graphicsFamily, 1);
+    VmaAllocationCreateInfo allocationCreateInfo = {0};
+    allocationCreateInfo.requiredFlags = VK2D_DESCRIPTOR_BUFFER_DIRECT_MEMORY;
+    uint32_t memoryType;
+    if (vmaFindMemoryTypeIndexForBufferInfo(gRenderer->vma, &bufferCreateInfo, &allocationCreateInfo, &memoryType) != VK_SUCCESS)
+        return false;
+    if (gRenderer->pd->props.deviceType != VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU)
+        return true;
+    const VkPhysicalDeviceMemoryProperties *memoryProperties;
+    vmaGetMemoryProperties(gRenderer->vma, &memoryProperties);
+    return memoryProperties->memoryHeaps[memoryProperties->memoryTypes[memoryType].heapIndex].size > VK2D_LEGACY_BAR_SIZE;
+}
+
+// Buffer the host writes a page through
+static VK2DBuffer _vk2dDescriptorBufferHostBuffer(_VK2DDescriptorBufferInternal *page) {
+    return page->stageBuffer != NULL ? page->stageBuffer : page->deviceBuffer;
+}
+
+// Creates the buffers for a page that can hold capacity bytes
+static bool _vk2dDescriptorBufferCreatePage(VK2DDescriptorBuffer db, _VK2DDescriptorBufferInternal *page, VkDeviceSize capacity) {
+	// Create the new buffers, pages written in place don't need a staging buffer. Whichever buffer
+	// the host writes to stays mapped for as long as the page exists.
+	page->size = 0;
+	page->capacity = capacity;
+	page->idleFrames = 0;
+	page->dynamicPool = VK_NULL_HANDLE;
+	page->dynamicSetCount = 0;
+	if (db->directWrite) {
+		page->stageBuffer = NULL;
+		page->deviceBuffer = vk2dBufferCreateMapped(
+				db->dev,
+				capacity,
+				VK2D_DESCRIPTOR_BUFFER_USAGE,
+				VK2D_DESCRIPTOR_BUFFER_DIRECT_MEMORY,
+				&page->hostData,
+				&page->coherent,
+				false);
+	} else {
+		page->stageBuffer = vk2dBufferCreateMapped(
+				db->dev,
+				capacity,
+				VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
+				&page->hostData,
+				&page->coherent,
+				true);
+		page->deviceBuffer = vk2dBufferCreateTransferShared(
+				db->dev,
+				capacity,
+				VK2D_DESCRIPTOR_BUFFER_USAGE,
+				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+	}
+
+	if ((page->stageBuffer == NULL && !db->directWrite) || page->deviceBuffer == NULL) {
+        vk2dBufferFree(page->stageBuffer);
+        vk2dBufferFree(page->deviceBuffer);
+        return false;
+    }
+	return true;
+}
+
+static void _vk2dDescriptorBufferFreePage(VK2DDescriptorBuffer db, _VK2DDescriptorBufferInternal *page) {
+	if (page->dynamicPool != VK_NULL_HANDLE)
+		vkDestroyDescriptorPool(db->dev->dev, page->dynamicPool, VK_NULL_HANDLE);
+	vk2dBufferFree(page->deviceBuffer);
+	vk2dBufferFree(page->stageBuffer);
+}
+
+// Makes sure the barrier list can hold a barrier for every standard and oversize page
+static bool _vk2dDescriptorBufferResizeBarriers(VK2DDescriptorBuffer db) {
+	VkBufferMemoryBarrier *barriers = realloc(db->memoryBarriers, sizeof(VkBufferMemoryBarrier) * (db->bufferListSize + db->oversizeListSize));
+	if (barriers == NULL) {
+		vk2dRaise(VK2D_STATUS_OUT_OF_RAM, "Failed to reallocate memory barrier list.");
+		return false;
+	}
+	db->memoryBarriers = barriers;
+	return true;
+}
+
 static _VK2DDescriptorBufferInternal *_vk2dDescriptorBufferAppendBuffer(VK2DDescriptorBuffer db) {
 	VK2DRenderer gRenderer = vk2dRendererGetPointer();
     if (vk2dStatusFatal() || gRenderer == NULL)
         return NULL;
 	// Potentially increase the size of the buffer list
 	if (db->bufferCount == db->bufferListSize) {
-		db->buffers = realloc(db->buffers, sizeof(_VK2DDescriptorBufferInternal) * (db->bufferListSize + VK2D_DEFAULT_ARRAY_EXTENSION));
-		db->memoryBarriers = realloc(db->memoryBarriers, sizeof(VkBufferMemoryBarrier) * (db->bufferListSize + VK2D_DEFAULT_ARRAY_EXTENSION));
-		db->bufferListSize += VK2D_DEFAULT_ARRAY_EXTENSION;
-		if (db->buffers == NULL || db->memoryBarriers == NULL) {
+		_VK2DDescriptorBufferInternal *buffers = realloc(db->buffers, sizeof(_VK2DDescriptorBufferInternal) * (db->bufferListSize + VK2D_DEFAULT_ARRAY_EXTENSION));
+		if (buffers == NULL) {
 		    vk2dRaise(VK2D_STATUS_OUT_OF_RAM, "Failed to reallocate buffers list.");
+		    return NULL;
 		}
+		db->buffers = buffers;
+		db->bufferListSize += VK2D_DEFAULT_ARRAY_EXTENSION;
+		if (!_vk2dDescriptorBufferResizeBarriers(db))
+			return NULL;
 	}
 
-	if (vk2dStatusFatal())
-	    return NULL;
-
 	// Find a spot in the buffer list for the new buffer
 	_VK2DDescriptorBufferInternal *buffer = &db->buffers[db->bufferCount];
+	if (!_vk2dDescriptorBufferCreatePage(db, buffer, db->pageSize))
+		return NULL;
 	db->bufferCount++;
+	return buffer;
+}
 
-	// Create the new buffers
-	buffer->size = 0;
-	buffer->stageBuffer = vk2dBufferCreate(
-			db->dev,
-			db->pageSize,
-			VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
-	buffer->deviceBuffer = vk2dBufferCreate(
-			db->dev,
-			db->pageSize,
-			VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
-			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-
-	if (buffer->stageBuffer == NULL || buffer->deviceBuffer == NULL) {
-        db->bufferCount--;
-        vk2dBufferFree(buffer->stageBuffer);
-        vk2dBufferFree(buffer->deviceBuffer);
-        return NULL;
-    }
+// Finds an oversize page nothing has been placed in this frame that can hold size bytes, creating one if there are none
+static _VK2DDescriptorBufferInternal *_vk2dDescriptorBufferGetOversizePage(VK2DDescriptorBuffer db, VkDeviceSize size) {
+	// Reuse the smallest free page that fits
+	_VK2DDescriptorBufferInternal *best = NULL;
+	for (int i = 0; i < db->oversizeCount; i++) {
+		_VK2DDescriptorBufferInternal *page = &db->oversizePages[i];
+		if (page->size == 0 && page->capacity >= size && (best == NULL || page->capacity < best->capacity))
+			best = page;
+	}
+	if (best != NULL)
+		return best;
 
-	return buffer;
+	if (db->oversizeCount == db->oversizeListSize) {
+		_VK2DDescriptorBufferInternal *pages = realloc(db->oversizePages, sizeof(_VK2DDescriptorBufferInternal) * (db->oversizeListSize + VK2D_DEFAULT_ARRAY_EXTENSION));
+		if (pages == NULL) {
+			vk2dRaise(VK2D_STATUS_OUT_OF_RAM, "Failed to reallocate oversize page list.");
+			return NULL;
+		}
+		db->oversizePages = pages;
+		db->oversizeListSize += VK2D_DEFAULT_ARRAY_EXTENSION;
+		if (!_vk2dDescriptorBufferResizeBarriers(db))
+			return NULL;
+	}
+	_VK2DDescriptorBufferInternal *page = &db->oversizePages[db->oversizeCount];
+	if (!_vk2dDescriptorBufferCreatePage(db, page, size))
+		return NULL;
+	db->oversizeCount++;
+	return page;
 }
 
-VK2DDescriptorBuffer vk2dDescriptorBufferCreate(VkDeviceSize vramPageSize) {
+VK2DDescriptorBuffer vk2dDescriptorBufferCreate(VkDeviceSize vramPageSize, VK2DDescriptorBufferMode mode, uint32_t idleFrames) {
     if (vk2dStatusFatal() || vk2dRendererGetPointer() == NULL)
         return NULL;
 	VK2DDescriptorBuffer db = calloc(1, sizeof(struct VK2DDescriptorBuffer_t));
@@ -67,7 +171,15 @@ VK2DDescriptorBuffer vk2dDescriptorBufferCreate(VkDeviceSize vramPageSize) {
 
 	db->dev = vk2dRendererGetDevice();
 	db->pageSize = vramPageSize;
+	db->regionPage = -1;
+	db->mode = mode;
+	db->currentPage = 0;
+	db->pagesInUse = 1;
+	db->idleFrames = idleFrames;
+	db->directWrite = _vk2dDescriptorBufferSupportsDirectWrite(vramPageSize);
 	if (_vk2dDescriptorBufferAppendBuffer(db) == NULL) {
+	    free(db->buffers);
+	    free(db->memoryBarriers);
 	    free(db);
 	    return NULL;
 	}
@@ -78,37 +190,136 @@ void vk2dDescriptorBufferFree(VK2DDescriptorBuffer db) {
     if (vk2dStatusFatal() || vk2dRendererGetPointer() == NULL)
         return;
 	if (db != NULL) {
-		for (int i = 0; i < db->bufferCount; i++) {
-			vk2dBufferFree(db->buffers[i].deviceBuffer);
-			vk2dBufferFree(db->buffers[i].stageBuffer);
-		}
+		for (int i = 0; i < db->bufferCount; i++)
+			_vk2dDescriptorBufferFreePage(db, &db->buffers[i]);
+		for (int i = 0; i < db->oversizeCount; i++)
+			_vk2dDescriptorBufferFreePage(db, &db->oversizePages[i]);
 		free(db->buffers);
+		free(db->oversizePages);
 		free(db->memoryBarriers);
 		free(db);
 	}
 }
 
+// Frees pages that have sat idle too long and standard pages smaller than the current page size,
+// only safe to call when the GPU is done with the previous use of this descriptor buffer
+static void _vk2dDescriptorBufferTrim(VK2DDescriptorBuffer db) {
+	int kept = 0;
+	for (int i = 0; i < db->bufferCount; i++) {
+		_VK2DDescriptorBufferInternal *page = &db->buffers[i];
+		if (page->capacity < db->pageSize || page->idleFrames >= db->idleFrames)
+			_vk2dDescriptorBufferFreePage(db, page);
+		else
+			db->buffers[kept++] = *page;
+	}
+	db->bufferCount = kept;
+
+	kept = 0;
+	for (int i = 0; i < db->oversizeCount; i++) {
+		_VK2DDescriptorBufferInternal *page = &db->oversizePages[i];
+		if (page->capacity <= db->pageSize || page->idleFrames >= db->idleFrames)
+			_vk2dDescriptorBufferFreePage(db, page);
+		else
+			db->oversizePages[kept++] = *page;
+	}
+	db->oversizeCount = kept;
+
+	// There must always be a page under the cursor
+	if (db->bufferCount == 0)
+		_vk2dDescriptorBufferAppendBuffer(db);
+}
+
 void vk2dDescriptorBufferBeginFrame(VK2DDescriptorBuffer db, VkCommandBuffer copyCommandBuffer) {
 	VK2DRenderer gRenderer = vk2dRendererGetPointer();
 	if (vk2dStatusFatal() || gRenderer == NULL)
         return;
 	db->copyCommandBuffer = copyCommandBuffer;
+	db->regionPage = -1;
+	db->currentPage = 0;
+	db->pagesInUse = 1;
+	memset(&db->stats, 0, sizeof(struct VK2DDescriptorBufferStats));
+	_vk2dDescriptorBufferTrim(db);
 
-	for (int i = 0; i < db->bufferCount; i++) {
-        // Map this buffer to ram
+	// Pages are persistently mapped so they only need to be emptied
+	for (int i = 0; i < db->bufferCount; i++)
 		db->buffers[i].size = 0;
-		VkResult result = vmaMapMemory(gRenderer->vma, db->buffers[i].stageBuffer->mem, &db->buffers[i].hostData);
-		if (result != VK_SUCCESS) {
-            vk2dRaise(VK2D_STATUS_VULKAN_ERROR, "Failed to map memory, VMA error %i.", result);
-            return;
-		}
-	}
+	for (int i = 0; i < db->oversizeCount; i++)
+		db->oversizePages[i].size = 0;
 }
 
 static VkDeviceSize maxTwo(VkDeviceSize s1, VkDeviceSize s2) {
     return s1 > s2 ? s1 : s2;
 }
 
+// Rounds a size up to the next multiple of the alignment required for buffer offsets
+static VkDeviceSize _vk2dDescriptorBufferAlign(VkDeviceSize size) {
+    VK2DRenderer gRenderer = vk2dRendererGetPointer();
+    // We may only move size in accordance with minUniformBufferOffsetAlignment
+    const VkDeviceSize alignment = maxTwo(gRenderer->pd->props.limits.minStorageBufferOffsetAlignment, gRenderer->pd->props.limits.minUniformBufferOffsetAlignment);
+    if (size % alignment != 0)
+        return ((size / alignment) + 1) * alignment;
+    return size;
+}
+
+// Moves the cursor to a page with at least size bytes free, appending a new page if none have room
+static _VK2DDescriptorBufferInternal *_vk2dDescriptorBufferAdvance(VK2DDescriptorBuffer db, VkDeviceSize size) {
+    // In ring mode every other page in use gets one look, in order from the cursor, before moving on
+    if (db->mode == VK2D_DESCRIPTOR_BUFFER_MODE_RING) {
+        for (int i = 1; i < db->pagesInUse; i++) {
+            const int page = (db->currentPage + i) % db->pagesInUse;
+            if (size <= db->buffers[page].capacity - db->buffers[page].size) {
+                db->currentPage = page;
+                return &db->buffers[page];
+            }
+        }
+    }
+
+    // Pages from previous frames are already empty
+    if (db->pagesInUse < db->bufferCount) {
+        db->currentPage = db->pagesInUse++;
+        return &db->buffers[db->currentPage];
+    }
+
+    // If no buffer exists, make a new one
+    _VK2DDescriptorBufferInternal *spot = _vk2dDescriptorBufferAppendBuffer(db);
+    if (spot == NULL)
+        return NULL;
+    db->currentPage = db->bufferCount - 1;
+    db->pagesInUse = db->bufferCount;
+    return spot;
+}
+
+// Returns the page under the cursor if it has size bytes free, otherwise moves the cursor on
+static _VK2DDescriptorBufferInternal *_vk2dDescriptorBufferGetPage(VK2DDescriptorBuffer db, VkDeviceSize size) {
+    _VK2DDescriptorBufferInternal *spot = &db->buffers[db->currentPage];
+    if (size <= spot->capacity - spot->size)
+        return spot;
+    return _vk2dDescriptorBufferAdvance(db, size);
+}
+
+// Bumps size bytes off of a page, returning the page and filling offset, or NULL if it fails. Allocations
+// that don't fit in a standard page get a dedicated oversize page to themselves.
+static _VK2DDescriptorBufferInternal *_vk2dDescriptorBufferAllocate(VK2DDescriptorBuffer db, VkDeviceSize size, VkDeviceSize *offset) {
+    const VkDeviceSize aligned = _vk2dDescriptorBufferAlign(size);
+    _VK2DDescriptorBufferInternal *spot;
+    if (size >= db->pageSize) {
+        spot = _vk2dDescriptorBufferGetOversizePage(db, aligned);
+        if (spot == NULL)
+            return NULL;
+        *offset = 0;
+        spot->size = aligned;
+    } else {
+        spot = _vk2dDescriptorBufferGetPage(db, size);
+        if (spot == NULL)
+            return NULL;
+        *offset = spot->size;
+        spot->size = aligned < spot->capacity - spot->size ? spot->size + aligned : spot->capacity;
+    }
+    db->stats.allocations++;
+    db->stats.bytesRequested += size;
+    return spot;
+}
+
 void vk2dDescriptorBufferCopyData(VK2DDescriptorBuffer db, void *data, VkDeviceSize size, VkBuffer *outBuffer, VkDeviceSize *offset) {
     VK2DRenderer gRenderer = vk2dRendererGetPointer();
     *outBuffer = VK_NULL_HANDLE;
@@ -116,89 +327,182 @@ void vk2dDescriptorBufferCopyData(VK2DDescriptorBuffer db, void *data, VkDeviceS
     if (vk2dStatusFatal() || gRenderer == NULL)
         return;
 
-    if (size < db->pageSize) {
-        // Find a buffer with enough space
-        _VK2DDescriptorBufferInternal *spot = NULL;
-        for (int i = 0; i < db->bufferCount && spot == NULL; i++) {
-            if (size <= db->pageSize - db->buffers[i].size) {
-                spot = &db->buffers[i];
-            }
-        }
+    _VK2DDescriptorBufferInternal *spot = _vk2dDescriptorBufferAllocate(db, size, offset);
+    if (spot != NULL) {
+        memcpy((uint8_t*)spot->hostData + *offset, data, size);
+        *outBuffer = spot->deviceBuffer->buf;
+    }
+}
 
-        // If no buffer exists, make a new one
-        if (spot == NULL) {
-            spot = _vk2dDescriptorBufferAppendBuffer(db);
-            if (spot != NULL) {
-                spot->size = 0;
-                VkResult result = vmaMapMemory(gRenderer->vma, spot->stageBuffer->mem, &spot->hostData);
-                if (result != VK_SUCCESS) {
-                    vk2dRaise(VK2D_STATUS_VULKAN_ERROR, "Failed to map memory, VMA error %i.", result);
-                    return;
-                }
-            } else {
-                return;
-            }
-        }
+void vk2dDescriptorBufferReserveSpace(VK2DDescriptorBuffer db, VkDeviceSize size, VkBuffer *outBuffer, VkDeviceSize *offset) {
+    VK2DRenderer gRenderer = vk2dRendererGetPointer();
+    *outBuffer = VK_NULL_HANDLE;
+    *offset = 0;
+    if (vk2dStatusFatal() || gRenderer == NULL)
+        return;
 
-        // Copy data over
-        uint8_t *np = spot->hostData;
-        memcpy(np + spot->size, data, size);
+    _VK2DDescriptorBufferInternal *spot = _vk2dDescriptorBufferAllocate(db, size, offset);
+    if (spot != NULL)
         *outBuffer = spot->deviceBuffer->buf;
-        *offset = spot->size;
+}
 
-        // We may only move size in accordance with minUniformBufferOffsetAlignment
-        const VkDeviceSize alignment = maxTwo(gRenderer->pd->props.limits.minStorageBufferOffsetAlignment, gRenderer->pd->props.limits.minUniformBufferOffsetAlignment);
-        if (size % alignment != 0) {
-            spot->size += ((size / alignment) + 1) * alignment;
-        } else {
-            spot->size += size;
+void vk2dDescriptorBufferReserveBatch(VK2DDescriptorBuffer db, const VkDeviceSize *sizes, uint32_t count, VkBuffer *outBuffers, VkDeviceSize *offsets) {
+    VK2DRenderer gRenderer = vk2dRendererGetPointer();
+    for (uint32_t i = 0; i < count; i++) {
+        outBuffers[i] = VK_NULL_HANDLE;
+        offsets[i] = 0;
+    }
+    if (count == 0)
+        return;
+    if (vk2dStatusFatal() || gRenderer == NULL)
+        return;
+
+    // Carve every range out of one page if they fit together, otherwise each gets placed on its own
+    VkDeviceSize total = 0;
+    for (uint32_t i = 0; i < count; i++)
+        total += _vk2dDescriptorBufferAlign(sizes[i]);
+    if (total < db->pageSize) {
+        VkDeviceSize offset;
+        _VK2DDescriptorBufferInternal *spot = _vk2dDescriptorBufferAllocate(db, total, &offset);
+        if (spot == NULL)
+            return;
+        db->stats.allocations += count - 1;
+        db->stats.bytesRequested -= total;
+        for (uint32_t i = 0; i < count; i++) {
+            outBuffers[i] = spot->deviceBuffer->buf;
+            offsets[i] = offset;
+            offset += _vk2dDescriptorBufferAlign(sizes[i]);
+            db->stats.bytesRequested += sizes[i];
         }
+    } else {
+        for (uint32_t i = 0; i < count; i++)
+            vk2dDescriptorBufferReserveSpace(db, sizes[i], &outBuffers[i], &offsets[i]);
     }
 }
 
-void vk2dDescriptorBufferReserveSpace(VK2DDescriptorBuffer db, VkDeviceSize size, VkBuffer *outBuffer, VkDeviceSize *offset) {
+void *vk2dDescriptorBufferBeginRegion(VK2DDescriptorBuffer db, VkDeviceSize minSize, VkDeviceSize maxSize, VkDeviceSize *outSize, VkBuffer *outBuffer, VkDeviceSize *offset) {
     VK2DRenderer gRenderer = vk2dRendererGetPointer();
+    *outSize = 0;
     *outBuffer = VK_NULL_HANDLE;
     *offset = 0;
     if (vk2dStatusFatal() || gRenderer == NULL)
-        return;
+        return NULL;
+    if (db->regionPage != -1) {
+        vk2dRaise(VK2D_STATUS_BAD_ASSET, "Descriptor buffer region opened while another is still open.");
+        return NULL;
+    }
 
-    if (size < db->pageSize) {
-        // Find a buffer with enough space
-        _VK2DDescriptorBufferInternal *spot = NULL;
-        for (int i = 0; i < db->bufferCount && spot == NULL; i++) {
-            if (size <= db->pageSize - db->buffers[i].size) {
-                spot = &db->buffers[i];
-            }
-        }
+    if (minSize < db->pageSize) {
+        _VK2DDescriptorBufferInternal *spot = _vk2dDescriptorBufferGetPage(db, minSize);
+        if (spot == NULL)
+            return NULL;
 
-        // If no buffer exists, make a new one
-        if (spot == NULL) {
-            spot = _vk2dDescriptorBufferAppendBuffer(db);
-            if (spot != NULL) {
-                spot->size = 0;
-                VkResult result = vmaMapMemory(gRenderer->vma, spot->stageBuffer->mem, &spot->hostData);
-                if (result != VK_SUCCESS) {
-                    vk2dRaise(VK2D_STATUS_VULKAN_ERROR, "Failed to map memory, VMA error %i.", result);
-                    return;
-                }
-            } else {
-                return;
-            }
-        }
+        // The region takes whatever is left of the page up to maxSize, the unused tail is given back on end
+        const VkDeviceSize available = spot->capacity - spot->size;
+        const VkDeviceSize alignedMax = _vk2dDescriptorBufferAlign(maxSize);
+        db->regionPage = db->currentPage;
+        db->regionOffset = spot->size;
+        db->regionSize = available < alignedMax ? available : alignedMax;
+        spot->size += db->regionSize;
+        db->stats.allocations++;
 
-        // Copy data over
+        *outSize = db->regionSize;
         *outBuffer = spot->deviceBuffer->buf;
-        *offset = spot->size;
+        *offset = db->regionOffset;
+        return (uint8_t*)spot->hostData + db->regionOffset;
+    }
+    return NULL;
+}
+
+void vk2dDescriptorBufferEndRegion(VK2DDescriptorBuffer db, VkDeviceSize used) {
+    if (db->regionPage == -1)
+        return;
+    _VK2DDescriptorBufferInternal *spot = &db->buffers[db->regionPage];
+    db->stats.bytesRequested += used;
+
+    // Only shrink the page if nothing was placed after the region while it was open
+    if (spot->size == db->regionOffset + db->regionSize) {
+        const VkDeviceSize aligned = _vk2dDescriptorBufferAlign(used);
+        spot->size = db->regionOffset + (aligned < db->regionSize ? aligned : db->regionSize);
+    }
+    db->regionPage = -1;
+}
+
+// Finds the standard or oversize page whose device buffer is buffer
+static _VK2DDescriptorBufferInternal *_vk2dDescriptorBufferFindPage(VK2DDescriptorBuffer db, VkBuffer buffer) {
+    for (int i = 0; i < db->bufferCount; i++)
+        if (db->buffers[i].deviceBuffer->buf == buffer)
+            return &db->buffers[i];
+    for (int i = 0; i < db->oversizeCount; i++)
+        if (db->oversizePages[i].deviceBuffer->buf == buffer)
+            return &db->oversizePages[i];
+    return NULL;
+}
 
-        // We may only move size in accordance with minUniformBufferOffsetAlignment
-        const VkDeviceSize alignment = maxTwo(gRenderer->pd->props.limits.minStorageBufferOffsetAlignment, gRenderer->pd->props.limits.minUniformBufferOffsetAlignment);
-        if (size % alignment != 0) {
-            spot->size += ((size / alignment) + 1) * alignment;
-        } else {
-            spot->size += size;
+VkDescriptorSet vk2dDescriptorBufferGetDynamicSet(VK2DDescriptorBuffer db, VkBuffer buffer, VkDescriptorSetLayout layout, uint32_t binding, VkDeviceSize range) {
+    VK2DRenderer gRenderer = vk2dRendererGetPointer();
+    if (vk2dStatusFatal() || gRenderer == NULL)
+        return VK_NULL_HANDLE;
+    _VK2DDescriptorBufferInternal *page = _vk2dDescriptorBufferFindPage(db, buffer);
+    if (page == NULL)
+        return VK_NULL_HANDLE;
+
+    // Sets are only ever written once, when they are made
+    for (uint32_t i = 0; i < page->dynamicSetCount; i++) {
+        _VK2DDescriptorBufferDynamicSet *dynamicSet = &page->dynamicSets[i];
+        if (dynamicSet->layout == layout && dynamicSet->binding == binding && dynamicSet->range == range)
+            return dynamicSet->set;
+    }
+    if (page->dynamicSetCount == VK2D_DESCRIPTOR_BUFFER_DYNAMIC_SETS)
+        return VK_NULL_HANDLE;
+
+    if (page->dynamicPool == VK_NULL_HANDLE) {
+        VkDescriptorPoolSize size = {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, VK2D_DESCRIPTOR_BUFFER_DYNAMIC_SETS};
+        VkDescriptorPoolCreateInfo createInfo = vk2dInitDescriptorPoolCreateInfo(&size, 1, VK2D_DESCRIPTOR_BUFFER_DYNAMIC_SETS);
+        VkResult result = vkCreateDescriptorPool(db->dev->dev, &createInfo, VK_NULL_HANDLE, &page->dynamicPool);
+        if (result != VK_SUCCESS) {
+            page->dynamicPool = VK_NULL_HANDLE;
+            vk2dRaise(VK2D_STATUS_VULKAN_ERROR, "Failed to create dynamic descriptor pool, Vulkan error %i.", result);
+            return VK_NULL_HANDLE;
         }
     }
+
+    _VK2DDescriptorBufferDynamicSet *dynamicSet = &page->dynamicSets[page->dynamicSetCount];
+    VkDescriptorSetAllocateInfo allocInfo = vk2dInitDescriptorSetAllocateInfo(page->dynamicPool, 1, &layout);
+    VkResult result = vkAllocateDescriptorSets(db->dev->dev, &allocInfo, &dynamicSet->set);
+    if (result != VK_SUCCESS) {
+        vk2dRaise(VK2D_STATUS_VULKAN_ERROR, "Failed to allocate dynamic descriptor set, Vulkan error %i.", result);
+        return VK_NULL_HANDLE;
+    }
+    VkDescriptorBufferInfo bufferInfo = {buffer, 0, range};
+    VkWriteDescriptorSet write = vk2dInitWriteDescriptorSet(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, binding, dynamicSet->set, &bufferInfo, 1, VK_NULL_HANDLE);
+    vkUpdateDescriptorSets(db->dev->dev, 1, &write, 0, VK_NULL_HANDLE);
+    dynamicSet->layout = layout;
+    dynamicSet->binding = binding;
+    dynamicSet->range = range;
+    page->dynamicSetCount++;
+    return dynamicSet->set;
+}
+
+VK2DDescriptorBufferStats vk2dDescriptorBufferGetStats(VK2DDescriptorBuffer db) {
+    if (db != NULL)
+        return db->statsLast;
+    VK2DDescriptorBufferStats stats = {0};
+    return stats;
+}
+
+// Flushes a page's writes if its memory isn't coherent and queues its copy to device memory
+static void _vk2dDescriptorBufferSubmitPage(VK2DDescriptorBuffer db, _VK2DDescriptorBufferInternal *page, VkCommandBuffer copyBuffer) {
+	VK2DRenderer gRenderer = vk2dRendererGetPointer();
+	if (!page->coherent)
+		vmaFlushAllocation(gRenderer->vma, _vk2dDescriptorBufferHostBuffer(page)->mem, 0, page->size);
+	if (!db->directWrite) {
+		VkBufferCopy bufferCopy = {0};
+		bufferCopy.size = page->size;
+		vkCmdCopyBuffer(copyBuffer, page->stageBuffer->buf, page->deviceBuffer->buf, 1, &bufferCopy);
+	}
+	db->stats.pagesUsed++;
+	db->stats.bytesUsed += page->size;
 }
 
 void vk2dDescriptorBufferEndFrame(VK2DDescriptorBuffer db, VkCommandBuffer copyBuffer) {
@@ -206,44 +510,74 @@ void vk2dDescriptorBufferEndFrame(VK2DDescriptorBuffer db, VkCommandBuffer copyB
 	if (vk2dStatusFatal() || gRenderer == NULL)
         return;
 
-	// Unmap all of the buffers then queue a buffer copy if their size is greater than 0
+	// Flush writes to memory that isn't coherent then queue a buffer copy if their size is greater than 0
+	db->stats.pagesUsed = 0;
+	db->stats.pageCount = db->bufferCount + db->oversizeCount;
+	db->stats.bytesUsed = 0;
+	db->stats.bytesWasted = 0;
+	db->stats.pageSize = db->pageSize;
 	for (int i = 0; i < db->bufferCount; i++) {
-		vmaUnmapMemory(gRenderer->vma, db->buffers[i].stageBuffer->mem);
-		if (db->buffers[i].size > 0) {
-			VkBufferCopy bufferCopy = {0};
-			bufferCopy.size = (db->buffers[i].size < db->pageSize) ? db->buffers[i].size : db->pageSize;
-			vkCmdCopyBuffer(copyBuffer, db->buffers[i].stageBuffer->buf, db->buffers[i].deviceBuffer->buf, 1, &bufferCopy);
+		_VK2DDescriptorBufferInternal *page = &db->buffers[i];
+		if (page->size > 0)
+			_vk2dDescriptorBufferSubmitPage(db, page, copyBuffer);
+		if (i < db->pagesInUse && i != db->currentPage)
+			db->stats.bytesWasted += page->capacity - page->size;
+		page->idleFrames = i < db->pagesInUse ? 0 : page->idleFrames + 1;
+	}
+	for (int i = 0; i < db->oversizeCount; i++) {
+		_VK2DDescriptorBufferInternal *page = &db->oversizePages[i];
+		if (page->size > 0) {
+			_vk2dDescriptorBufferSubmitPage(db, page, copyBuffer);
+			db->stats.oversizeAllocations++;
 		}
+		page->idleFrames = page->size > 0 ? 0 : page->idleFrames + 1;
+	}
+
+	// If the frame didn't fit in one page, standard pages grow to hold everything it used. The
+	// smaller pages are replaced next time this buffer begins a frame.
+	if (db->pagesInUse > 1 || db->stats.oversizeAllocations > 0) {
+		VkDeviceSize pageSize = db->pageSize;
+		while (pageSize < db->stats.bytesUsed && pageSize * 2 <= VK2D_DESCRIPTOR_BUFFER_MAX_PAGE_SIZE)
+			pageSize *= 2;
+		db->pageSize = pageSize;
 	}
+
+	db->statsLast = db->stats;
 }
 
-void vk2dDescriptorBufferRecordCopyPipelineBarrier(VK2DDescriptorBuffer db, VkCommandBuffer buf) {
+// Fills the barrier list with a barrier for every page that has data this frame, returning how many there are
+static int _vk2dDescriptorBufferFillBarriers(VK2DDescriptorBuffer db, VkAccessFlags srcAccessMask, VkAccessFlags dstAccessMask) {
     VK2DRenderer gRenderer = vk2dRendererGetPointer();
-    if (vk2dStatusFatal() || gRenderer == NULL)
-        return;
-
     int barrierCount = 0;
-    for (int i = 0; i < db->bufferCount; i++) {
-        if (db->buffers[i].size > 0) {
-            db->memoryBarriers[i].sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
-            db->memoryBarriers[i].pNext = VK_NULL_HANDLE;
-            db->memoryBarriers[i].srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-            db->memoryBarriers[i].dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
-            db->memoryBarriers[i].srcQueueFamilyIndex = gRenderer->pd->QueueFamily.graphicsFamily;
-            db->memoryBarriers[i].dstQueueFamilyIndex = gRenderer->pd->QueueFamily.graphicsFamily;
-            db->memoryBarriers[i].buffer = db->buffers[i].deviceBuffer->buf;
-            db->memoryBarriers[i].offset = 0;
-            db->memoryBarriers[i].size = db->buffers[i].size;
+    for (int i = 0; i < db->pagesInUse + db->oversizeCount; i++) {
+        _VK2DDescriptorBufferInternal *page = i < db->pagesInUse ? &db->buffers[i] : &db->oversizePages[i - db->pagesInUse];
+        if (page->size > 0) {
+            db->memoryBarriers[barrierCount].sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+            db->memoryBarriers[barrierCount].pNext = VK_NULL_HANDLE;
+            db->memoryBarriers[barrierCount].srcAccessMask = srcAccessMask;
+            db->memoryBarriers[barrierCount].dstAccessMask = dstAccessMask;
+            db->memoryBarriers[barrierCount].srcQueueFamilyIndex = gRenderer->pd->QueueFamily.graphicsFamily;
+            db->memoryBarriers[barrierCount].dstQueueFamilyIndex = gRenderer->pd->QueueFamily.graphicsFamily;
+            db->memoryBarriers[barrierCount].buffer = page->deviceBuffer->buf;
+            db->memoryBarriers[barrierCount].offset = 0;
+            db->memoryBarriers[barrierCount].size = page->size;
             barrierCount++;
-        } else {
-            break;
         }
     }
+    return barrierCount;
+}
+
+void vk2dDescriptorBufferRecordCopyPipelineBarrier(VK2DDescriptorBuffer db, VkCommandBuffer buf) {
+    VK2DRenderer gRenderer = vk2dRendererGetPointer();
+    // Host writes are made visible to the device by the queue submission itself when there is no copy
+    if (vk2dStatusFatal() || gRenderer == NULL || db->directWrite)
+        return;
 
+    const int barrierCount = _vk2dDescriptorBufferFillBarriers(db, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
     vkCmdPipelineBarrier(
             buf,
             VK_PIPELINE_STAGE_TRANSFER_BIT,
-            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
             0,
             0,
             VK_NULL_HANDLE,
@@ -258,28 +592,11 @@ void vk2dDescriptorBufferRecordComputePipelineBarrier(VK2DDescriptorBuffer db, V
     if (vk2dStatusFatal() || gRenderer == NULL)
         return;
 
-    int barrierCount = 0;
-    for (int i = 0; i < db->bufferCount; i++) {
-        if (db->buffers[i].size > 0) {
-            db->memoryBarriers[i].sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
-            db->memoryBarriers[i].pNext = VK_NULL_HANDLE;
-            db->memoryBarriers[i].srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
-            db->memoryBarriers[i].dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT;
-            db->memoryBarriers[i].srcQueueFamilyIndex = gRenderer->pd->QueueFamily.graphicsFamily;
-            db->memoryBarriers[i].dstQueueFamilyIndex = gRenderer->pd->QueueFamily.graphicsFamily;
-            db->memoryBarriers[i].buffer = db->buffers[i].deviceBuffer->buf;
-            db->memoryBarriers[i].offset = 0;
-            db->memoryBarriers[i].size = db->buffers[i].size;
-            barrierCount++;
-        } else {
-            break;
-        }
-    }
-
+    const int barrierCount = _vk2dDescriptorBufferFillBarriers(db, VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_INDIRECT_COMMAND_READ_BIT);
     vkCmdPipelineBarrier(
             buf,
             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
-            VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+            VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
             0,
             0,
             VK_NULL_HANDLE,
@@ -11,14 +11,21 @@ extern "C" {
 
 /// \brief Creates an empty descriptor buffer of default size
 /// \param vramPageSize Size of each page for this descriptor buffer
+/// \param mode How the allocation cursor moves on when the current page is full
+/// \param idleFrames Number of frames in a row a page may go unused before it is freed
 /// \return Returns a new descriptor buffer or NULL if it fails
-VK2DDescriptorBuffer vk2dDescriptorBufferCreate(VkDeviceSize vramPageSize);
+///
+/// Allocations are bumped off of the page under a cursor, so each one is constant time no matter
+/// how many pages the frame has spilled into. Allocations too large for a page get an oversize
+/// page of their own, and whenever a frame doesn't fit in one page the page size doubles until it
+/// would (up to VK2D_DESCRIPTOR_BUFFER_MAX_PAGE_SIZE).
+VK2DDescriptorBuffer vk2dDescriptorBufferCreate(VkDeviceSize vramPageSize, VK2DDescriptorBufferMode mode, uint32_t idleFrames);
 
 /// \brief Frees a descriptor buffer from memory
 /// \param db Descriptor buffer to free
 void vk2dDescriptorBufferFree(VK2DDescriptorBuffer db);
 
-/// \brief Prepares the buffer for copying
+/// \brief Prepares the buffer for copying, freeing pages that have been idle too long or were outgrown
 /// \param db Descriptor buffer to prepare
 /// \param copyCommandBuffer Command buffer that will be used for drawing, in recording state
 void vk2dDescriptorBufferBeginFrame(VK2DDescriptorBuffer db, VkCommandBuffer copyCommandBuffer);
@@ -29,7 +36,6 @@ void vk2dDescriptorBufferBeginFrame(VK2DDescriptorBuffer db, VkCommandBuffer cop
 /// \param size Size in bytes of the data
 /// \param outBuffer Will be filled with the pointer to the internal Vulkan buffer that the memory is located in
 /// \param offset Location in outBuffer where the copied data is
-/// \warning size ***MUST*** be less than the page size specified when this is created
 void vk2dDescriptorBufferCopyData(VK2DDescriptorBuffer db, void *data, VkDeviceSize size, VkBuffer *outBuffer, VkDeviceSize *offset);
 
 /// \brief Reserves a given amount of space in the descriptor buffer and returns a buffer and offset where that size is available (mainly for compute shaders)
@@ -37,20 +43,62 @@ void vk2dDescriptorBufferCopyData(VK2DDescriptorBuffer db, void *data, VkDeviceS
 /// \param size Size to reserve in the db
 /// \param outBuffer Will be filled with the corresponding Vulkan buffer where the space is reserved
 /// \param offset Offset in the buffer where its available
-/// \warning size ***MUST*** be less than VK2D_DESCRIPTOR_BUFFER_INTERNAL_SIZE (which is 250kb by default)
 void vk2dDescriptorBufferReserveSpace(VK2DDescriptorBuffer db, VkDeviceSize size, VkBuffer *outBuffer, VkDeviceSize *offset);
 
+/// \brief Reserves several ranges at once, placing them back to back in one page if they fit together
+/// \param db Descriptor buffer to pull from
+/// \param sizes Size of each range to reserve
+/// \param count Number of ranges
+/// \param outBuffers Will be filled with the Vulkan buffer each range is reserved in
+/// \param offsets Will be filled with the offset of each range in its buffer, each is properly aligned
+void vk2dDescriptorBufferReserveBatch(VK2DDescriptorBuffer db, const VkDeviceSize *sizes, uint32_t count, VkBuffer *outBuffers, VkDeviceSize *offsets);
+
+/// \brief Opens a region of mapped staging memory that can be written to directly, avoiding an intermediate copy
+/// \param db Descriptor buffer to pull from
+/// \param minSize Minimum amount of space the region must have
+/// \param maxSize Maximum amount of space the region may take, it will be smaller if the page it lands in has less left
+/// \param outSize Will be filled with the actual size of the region
+/// \param outBuffer Will be filled with the corresponding Vulkan buffer the region will end up in
+/// \param offset Offset in outBuffer where the region starts
+/// \return Returns a pointer to host memory the caller may write up to outSize bytes to, or NULL if it fails
+/// \warning Only one region may be open at a time, and the pointer is only valid until the region is ended
+/// \warning minSize ***MUST*** be less than the current page size, regions are never placed in oversize pages
+void *vk2dDescriptorBufferBeginRegion(VK2DDescriptorBuffer db, VkDeviceSize minSize, VkDeviceSize maxSize, VkDeviceSize *outSize, VkBuffer *outBuffer, VkDeviceSize *offset);
+
+/// \brief Closes the currently open region, returning the space past what was used to the page
+/// \param db Descriptor buffer the region was opened on
+/// \param used Amount of bytes actually written to the region
+void vk2dDescriptorBufferEndRegion(VK2DDescriptorBuffer db, VkDeviceSize used);
+
+/// \brief Gets a long-lived set with a dynamic uniform buffer covering the page buffer belongs to
+/// \param db Descriptor buffer buffer came from
+/// \param buffer Buffer returned by an earlier copy or reservation this frame
+/// \param layout Layout of the set, binding must be a single VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC
+/// \param binding Binding the buffer goes in
+/// \param range Size of the uniform at the dynamic offset, data at offset + range must not pass the end of the page
+/// \return Returns a set to bind with the offset the data was given as its dynamic offset, or VK_NULL_HANDLE if the
+/// page already has VK2D_DESCRIPTOR_BUFFER_DYNAMIC_SETS other sets
+///
+/// Each page only writes a set the first time a given layout, binding, and range asks for one, after that the
+/// same set is returned every frame until the page is freed.
+VkDescriptorSet vk2dDescriptorBufferGetDynamicSet(VK2DDescriptorBuffer db, VkBuffer buffer, VkDescriptorSetLayout layout, uint32_t binding, VkDeviceSize range);
+
+/// \brief Gets the usage counters for the last frame this descriptor buffer finished
+/// \param db Descriptor buffer to get the counters of
+/// \return Returns the counters, or all zeroes if db is NULL
+VK2DDescriptorBufferStats vk2dDescriptorBufferGetStats(VK2DDescriptorBuffer db);
+
 /// \brief Finishes tasks that need to be done in command buffers before the queue is submitted
 /// \param db Descriptor buffer to finish the frame on
 /// \param copyBuffer A (likely new) command buffer in recording state that will have the memory copy placed into it
 void vk2dDescriptorBufferEndFrame(VK2DDescriptorBuffer db, VkCommandBuffer copyBuffer);
 
-/// \brief Records a pipeline barrier to block compute until copy is done
+/// \brief Records a pipeline barrier to block compute and vertex shaders until copy is done
 /// \param db Descriptor buffer to get the memory barriers from
 /// \param buf Buffer to record to
 void vk2dDescriptorBufferRecordCopyPipelineBarrier(VK2DDescriptorBuffer db, VkCommandBuffer buf);
 
-/// \brief Records a pipeline barrier to block vertex input until compute is done
+/// \brief Records a pipeline barrier to block indirect draws and vertex input/shading until compute is done
 /// \param db Descriptor buffer to get the memory barriers from
 /// \param buf Buffer to record to
 void vk2dDescriptorBufferRecordComputePipelineBarrier(VK2DDescriptorBuffer db, VkCommandBuffer buf);
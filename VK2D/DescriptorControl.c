@@ -20,6 +20,7 @@
 #include <malloc/malloc.h>
 #include <memory.h>
 #endif
+#include <string.h>
 
 // Places another descriptor pool at the end of a given desc con's list, extending the list if need be
 static void _vk2dDescConAppendList(VK2DDescCon descCon) {
@@ -40,7 +41,7 @@ static void _vk2dDescConAppendList(VK2DDescCon descCon) {
 	uint32_t i = 0;
 	if (descCon->buffer != VK2D_NO_LOCATION) {
 		sizes[i].descriptorCount = VK2D_DEFAULT_DESCRIPTOR_POOL_ALLOCATION;
-		sizes[i].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+		sizes[i].type = descCon->bufferType;
 		i++;
 	}
 	if (descCon->sampler != VK2D_NO_LOCATION) {
@@ -59,36 +60,115 @@ static void _vk2dDescConAppendList(VK2DDescCon descCon) {
         vk2dRaise(VK2D_STATUS_VULKAN_ERROR, "Failed to create descriptor pool, Vulkan error %i.", result);
 	}
 	descCon->poolsInUse++;
+	descCon->stats.poolCount = descCon->poolsInUse;
 }
 
-// Gets the first available descriptor set from a descriptor controller (allocating a new pool if need be)
+// Gets the next available descriptor set from a descriptor controller (allocating a new pool if need be)
 VkDescriptorSet _vk2dDescConGetAvailableSet(VK2DDescCon descCon) {
     if (vk2dStatusFatal())
         return VK_NULL_HANDLE;
 
 	VkDescriptorSet set = VK_NULL_HANDLE;
-	uint32_t i = 0;
 	VkResult res;
 	VkDescriptorSetAllocateInfo allocInfo = vk2dInitDescriptorSetAllocateInfo(VK_NULL_HANDLE, 1, &descCon->layout);
 
 	while (set == VK_NULL_HANDLE) {
-		allocInfo.descriptorPool = descCon->pools[i];
+		// Every set takes at most one of each descriptor, so a pool is known to be full without asking the driver
+		if (descCon->setsInPool >= VK2D_DEFAULT_DESCRIPTOR_POOL_ALLOCATION) {
+			descCon->currentPool++;
+			descCon->setsInPool = 0;
+		}
+		if (descCon->currentPool == descCon->poolsInUse) {
+			_vk2dDescConAppendList(descCon);
+			if (descCon->currentPool == descCon->poolsInUse || vk2dStatusFatal())
+				return VK_NULL_HANDLE;
+		}
+
+		allocInfo.descriptorPool = descCon->pools[descCon->currentPool];
 		res = vkAllocateDescriptorSets(descCon->dev->dev, &allocInfo, &set);
-		if (res == VK_ERROR_OUT_OF_POOL_MEMORY) {
+		if (res == VK_SUCCESS) {
+			descCon->setsInPool++;
+			descCon->stats.setsAllocated++;
+		} else if (res == VK_ERROR_OUT_OF_POOL_MEMORY || res == VK_ERROR_FRAGMENTED_POOL) {
 			set = VK_NULL_HANDLE;
-		} else if (res != VK_SUCCESS) {
+			descCon->setsInPool = VK2D_DEFAULT_DESCRIPTOR_POOL_ALLOCATION;
+			descCon->stats.failedAllocations++;
+		} else {
             vk2dRaise(VK2D_STATUS_VULKAN_ERROR, "Failed to create descriptor set, Vulkan error %i.", res);
 			break;
 		}
-		i++;
-		if (i == descCon->poolsInUse && set == VK_NULL_HANDLE)
-			_vk2dDescConAppendList(descCon);
 	}
 
 	return set;
 }
 
-VK2DDescCon vk2dDescConCreate(VK2DLogicalDevice dev, VkDescriptorSetLayout layout, uint32_t buffer, uint32_t sampler, uint32_t storageBuffer) {
+// Hashes the contents of a sampler set
+static uint32_t _vk2dDescConHash(VkImageView view, VkBuffer buffer) {
+	uint64_t a = 0, b = 0;
+	memcpy(&a, &view, sizeof(VkImageView));
+	memcpy(&b, &buffer, sizeof(VkBuffer));
+	uint64_t hash = (a * 0x9E3779B97F4A7C15) ^ (b + 0x7F4A7C159E3779B9 + (a << 6) + (a >> 2));
+	return (uint32_t)(hash ^ (hash >> 32));
+}
+
+// Finds the slot a set with the given contents is in, or the empty slot it would go in
+static _VK2DDescConCacheEntry *_vk2dDescConCacheFind(VK2DDescCon descCon, VkImageView view, VkBuffer buffer) {
+	uint32_t slot = _vk2dDescConHash(view, buffer) & (descCon->cacheSize - 1);
+	while (descCon->cache[slot].view != VK_NULL_HANDLE && (descCon->cache[slot].view != view || descCon->cache[slot].buffer != buffer))
+		slot = (slot + 1) & (descCon->cacheSize - 1);
+	return &descCon->cache[slot];
+}
+
+// Doubles the size of the cache, rehashing everything in it
+static bool _vk2dDescConCacheGrow(VK2DDescCon descCon) {
+	_VK2DDescConCacheEntry *old = descCon->cache;
+	const uint32_t oldSize = descCon->cacheSize;
+	const uint32_t newSize = oldSize == 0 ? 64 : oldSize * 2;
+	_VK2DDescConCacheEntry *cache = calloc(newSize, sizeof(struct _VK2DDescConCacheEntry));
+	if (cache == NULL) {
+		vk2dRaise(VK2D_STATUS_OUT_OF_RAM, "Failed to extend descriptor set cache to %i sets.", newSize);
+		return false;
+	}
+	descCon->cache = cache;
+	descCon->cacheSize = newSize;
+	for (uint32_t i = 0; i < oldSize; i++)
+		if (old[i].view != VK_NULL_HANDLE)
+			*_vk2dDescConCacheFind(descCon, old[i].view, old[i].buffer) = old[i];
+	free(old);
+	return true;
+}
+
+// Looks a set up in the cache, returning it or VK_NULL_HANDLE and filling slot with where the new set goes
+static VkDescriptorSet _vk2dDescConCacheGet(VK2DDescCon descCon, VkImageView view, VkBuffer buffer, _VK2DDescConCacheEntry **slot) {
+	*slot = NULL;
+	if (!descCon->cacheEnabled)
+		return VK_NULL_HANDLE;
+
+	// Kept under half full so probes stay short
+	if ((descCon->cacheCount + 1) * 2 > descCon->cacheSize && !_vk2dDescConCacheGrow(descCon))
+		return VK_NULL_HANDLE;
+	_VK2DDescConCacheEntry *entry = _vk2dDescConCacheFind(descCon, view, buffer);
+	if (entry->view != VK_NULL_HANDLE) {
+		descCon->stats.cacheHits++;
+		return entry->set;
+	}
+	descCon->stats.cacheMisses++;
+	*slot = entry;
+	return VK_NULL_HANDLE;
+}
+
+// Puts a newly written set in the slot _vk2dDescConCacheGet gave out
+static void _vk2dDescConCachePut(VK2DDescCon descCon, _VK2DDescConCacheEntry *slot, VkImageView view, VkBuffer buffer, VkDescriptorSet set) {
+	if (slot == NULL || set == VK_NULL_HANDLE)
+		return;
+	slot->view = view;
+	slot->buffer = buffer;
+	slot->set = set;
+	descCon->cacheCount++;
+}
+
+// Creates a descriptor controller whose buffer binding is of type bufferType
+static VK2DDescCon _vk2dDescConCreate(VK2DLogicalDevice dev, VkDescriptorSetLayout layout, uint32_t buffer, uint32_t sampler, uint32_t storageBuffer, VkDescriptorType bufferType) {
     if (vk2dStatusFatal())
         return NULL;
 
@@ -99,6 +179,7 @@ VK2DDescCon vk2dDescConCreate(VK2DLogicalDevice dev, VkDescriptorSetLayout layou
 		out->buffer = buffer;
 		out->storageBuffer = storageBuffer;
 		out->sampler = sampler;
+		out->bufferType = bufferType;
 		out->dev = dev;
 		out->pools = NULL;
 		out->poolListSize = 0;
@@ -111,12 +192,21 @@ VK2DDescCon vk2dDescConCreate(VK2DLogicalDevice dev, VkDescriptorSetLayout layou
 	return out;
 }
 
+VK2DDescCon vk2dDescConCreate(VK2DLogicalDevice dev, VkDescriptorSetLayout layout, uint32_t buffer, uint32_t sampler, uint32_t storageBuffer) {
+	return _vk2dDescConCreate(dev, layout, buffer, sampler, storageBuffer, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
+}
+
+VK2DDescCon vk2dDescConCreateDynamic(VK2DLogicalDevice dev, VkDescriptorSetLayout layout, uint32_t buffer) {
+	return _vk2dDescConCreate(dev, layout, buffer, VK2D_NO_LOCATION, VK2D_NO_LOCATION, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC);
+}
+
 void vk2dDescConFree(VK2DDescCon descCon) {
 	if (descCon != NULL) {
 		uint32_t i;
 		for (i = 0; i < descCon->poolsInUse; i++)
 			vkDestroyDescriptorPool(descCon->dev->dev, descCon->pools[i], VK_NULL_HANDLE);
 		free(descCon->pools);
+		free(descCon->cache);
 		free(descCon);
 	}
 }
@@ -130,7 +220,7 @@ VkDescriptorSet vk2dDescConGetBufferSet(VK2DDescCon descCon, VK2DBuffer buffer)
 	bufferInfo.buffer = buffer->buf;
 	bufferInfo.offset = 0;
 	bufferInfo.range = buffer->size;
-	VkWriteDescriptorSet write = vk2dInitWriteDescriptorSet(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, descCon->buffer, set,
+	VkWriteDescriptorSet write = vk2dInitWriteDescriptorSet(descCon->bufferType, descCon->buffer, set,
 																&bufferInfo, 1, VK_NULL_HANDLE);
 	vkUpdateDescriptorSets(descCon->dev->dev, 1, &write, 0, VK_NULL_HANDLE);
 	return set;
@@ -147,13 +237,18 @@ VkDescriptorSet vk2dDescConGetSamplerSet(VK2DDescCon descCon, VK2DTexture tex) {
     if (vk2dStatusFatal())
         return VK_NULL_HANDLE;
 
-	VkDescriptorSet set = _vk2dDescConGetAvailableSet(descCon);
+	_VK2DDescConCacheEntry *slot;
+	VkDescriptorSet set = _vk2dDescConCacheGet(descCon, tex->img->view, VK_NULL_HANDLE, &slot);
+	if (set != VK_NULL_HANDLE)
+		return set;
+	set = _vk2dDescConGetAvailableSet(descCon);
 	VkDescriptorImageInfo imageInfo = {0};
 	imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 	imageInfo.imageView = tex->img->view;
 	VkWriteDescriptorSet write = vk2dInitWriteDescriptorSet(VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
 																descCon->sampler, set, VK_NULL_HANDLE, 1, &imageInfo);
 	vkUpdateDescriptorSets(descCon->dev->dev, 1, &write, 0, VK_NULL_HANDLE);
+	_vk2dDescConCachePut(descCon, slot, tex->img->view, VK_NULL_HANDLE, set);
 	return set;
 }
 
@@ -161,7 +256,11 @@ VkDescriptorSet vk2dDescConGetSamplerBufferSet(VK2DDescCon descCon, VK2DTexture
     if (vk2dStatusFatal())
         return VK_NULL_HANDLE;
 
-	VkDescriptorSet set = _vk2dDescConGetAvailableSet(descCon);
+	_VK2DDescConCacheEntry *slot;
+	VkDescriptorSet set = _vk2dDescConCacheGet(descCon, tex->img->view, buffer->buf, &slot);
+	if (set != VK_NULL_HANDLE)
+		return set;
+	set = _vk2dDescConGetAvailableSet(descCon);
 	VkWriteDescriptorSet write[2];
 	VkDescriptorImageInfo imageInfo = {0};
 	imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
@@ -172,9 +271,10 @@ VkDescriptorSet vk2dDescConGetSamplerBufferSet(VK2DDescCon descCon, VK2DTexture
 	bufferInfo.buffer = buffer->buf;
 	bufferInfo.offset = 0;
 	bufferInfo.range = buffer->size;
-	write[0] = vk2dInitWriteDescriptorSet(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, descCon->buffer, set, &bufferInfo, 1,
+	write[0] = vk2dInitWriteDescriptorSet(descCon->bufferType, descCon->buffer, set, &bufferInfo, 1,
 											  VK_NULL_HANDLE);
 	vkUpdateDescriptorSets(descCon->dev->dev, 2, write, 0, VK_NULL_HANDLE);
+	_vk2dDescConCachePut(descCon, slot, tex->img->view, buffer->buf, set);
 	return set;
 }
 
@@ -182,8 +282,33 @@ void vk2dDescConReset(VK2DDescCon descCon) {
     if (vk2dStatusFatal())
         return;
 
+	// Only pools up to the cursor have had anything allocated from them
 	uint32_t i;
-	for (i = 0; i < descCon->poolsInUse; i++) {
+	for (i = 0; i <= descCon->currentPool && i < descCon->poolsInUse; i++) {
 		vkResetDescriptorPool(descCon->dev->dev, descCon->pools[i], 0);
 	}
+	descCon->currentPool = 0;
+	descCon->setsInPool = 0;
+	vk2dDescConClearCache(descCon);
+}
+
+void vk2dDescConSetCaching(VK2DDescCon descCon, bool cache) {
+	if (descCon != NULL) {
+		vk2dDescConClearCache(descCon);
+		descCon->cacheEnabled = cache;
+	}
+}
+
+void vk2dDescConClearCache(VK2DDescCon descCon) {
+	if (descCon != NULL && descCon->cache != NULL) {
+		memset(descCon->cache, 0, descCon->cacheSize * sizeof(struct _VK2DDescConCacheEntry));
+		descCon->cacheCount = 0;
+	}
+}
+
+VK2DDescConStats vk2dDescConGetStats(VK2DDescCon descCon) {
+	if (descCon != NULL)
+		return descCon->stats;
+	VK2DDescConStats stats = {0};
+	return stats;
 }
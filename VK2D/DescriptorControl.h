@@ -15,6 +15,14 @@ extern "C" {
 /// \return New descriptor controller or NULL if it failed
 VK2DDescCon vk2dDescConCreate(VK2DLogicalDevice dev, VkDescriptorSetLayout layout, uint32_t buffer, uint32_t sampler, uint32_t storageBuffer);
 
+/// \brief Creates an empty descriptor controller for layouts with a single dynamic uniform buffer
+/// \param layout Descriptor set layout to use
+/// \param buffer Location of the dynamic uniform buffer (binding)
+/// \return New descriptor controller or NULL if it failed
+///
+/// Sets from vk2dDescConGetBufferSet cover the buffer from offset 0, so they are bound with a dynamic offset of 0.
+VK2DDescCon vk2dDescConCreateDynamic(VK2DLogicalDevice dev, VkDescriptorSetLayout layout, uint32_t buffer);
+
 /// \brief Frees a descriptor controller from memory
 /// \param descCon Descriptor controller to free
 void vk2dDescConFree(VK2DDescCon descCon);
@@ -45,8 +53,27 @@ VkDescriptorSet vk2dDescConGetSamplerBufferSet(VK2DDescCon descCon, VK2DTexture
 
 /// \brief Resets all pools in a descriptor controller (basically deletes all active sets so new ones can be allocated)
 /// \param descCon Descriptor controller to reset
+///
+/// This also empties the content cache, since every set in it is gone.
 void vk2dDescConReset(VK2DDescCon descCon);
 
+/// \brief Enables or disables the content cache for sampler sets, which empties it either way
+/// \param descCon Descriptor controller to set the cache on
+/// \param cache If true, vk2dDescConGetSamplerSet and vk2dDescConGetSamplerBufferSet return the existing set when
+/// asked for an image view and buffer combination they already wrote instead of allocating another
+/// \warning Cached sets keep pointing at the image view and buffer they were written with, call vk2dDescConClearCache
+/// after freeing a texture or buffer that may be in the cache
+void vk2dDescConSetCaching(VK2DDescCon descCon, bool cache);
+
+/// \brief Empties the content cache without freeing the sets that were in it
+/// \param descCon Descriptor controller to clear the cache of
+void vk2dDescConClearCache(VK2DDescCon descCon);
+
+/// \brief Gets the allocation and cache counters for a descriptor controller
+/// \param descCon Descriptor controller to get the counters of
+/// \return Returns the counters, or all zeroes if descCon is NULL
+VK2DDescConStats vk2dDescConGetStats(VK2DDescCon descCon);
+
 #ifdef __cplusplus
 }
 #endif
\ No newline at end of file
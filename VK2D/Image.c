@@ -7,6 +7,7 @@
 #include "VK2D/Initializers.h"
 #include "VK2D/Opaque.h"
 #include "VK2D/Buffer.h"
+#include "VK2D/UploadBatch.h"
 #define STB_IMAGE_IMPLEMENTATION
 #include "VK2D/stb_image.h"
 #include "VK2D/Renderer.h"
@@ -36,37 +37,6 @@ Uint32 amask = 0xff000000;
 
 // Internal functions
 
-static void _vk2dImageCopyBufferToImage(VK2DLogicalDevice dev, VkBuffer buffer, VkImage image, uint32_t width, uint32_t height, bool mainThread) {
-	VkCommandBuffer commandBuffer = vk2dLogicalDeviceGetSingleUseBuffer(dev, mainThread);
-	if (commandBuffer == VK_NULL_HANDLE)
-	    return;
-
-	VkBufferImageCopy region = {0};
-	region.bufferOffset = 0;
-	region.bufferRowLength = 0;
-	region.bufferImageHeight = 0;
-
-	region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-	region.imageSubresource.mipLevel = 0;
-	region.imageSubresource.baseArrayLayer = 0;
-	region.imageSubresource.layerCount = 1;
-
-	region.imageExtent.width = width;
-	region.imageExtent.height = height;
-	region.imageExtent.depth = 1;
-
-	vkCmdCopyBufferToImage(
-			commandBuffer,
-			buffer,
-			image,
-			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-			1,
-			&region
-	);
-
-	vk2dLogicalDeviceSubmitSingleBuffer(dev, commandBuffer, mainThread);
-}
-
 void _vk2dImageTransitionImageLayout(VK2DLogicalDevice dev, VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout, bool mainThread) {
 	VkCommandBuffer buffer = vk2dLogicalDeviceGetSingleUseBuffer(dev, mainThread);
     if (buffer == VK_NULL_HANDLE)
@@ -171,38 +141,13 @@ VK2DImage vk2dImageCreate(VK2DLogicalDevice dev, uint32_t width, uint32_t height
 }
 
 VK2DImage vk2dImageLoad(VK2DLogicalDevice dev, const char *filename) {
-	VK2DRenderer gRenderer = vk2dRendererGetPointer();
 	VK2DImage out = NULL;
-	VK2DBuffer stage;
 	int texWidth = 0, texHeight = 0, texChannels;
 	unsigned char* pixels = stbi_load(filename, &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
-	VkDeviceSize imageSize = texWidth * texHeight * 4;
 
 	if (pixels != NULL) {
-		stage = vk2dBufferCreate(dev, imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-								 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-        if (stage != NULL) {
-            void *data;
-            vmaMapMemory(gRenderer->vma, stage->mem, &data);
-            memcpy(data, pixels, imageSize);
-            vmaUnmapMemory(gRenderer->vma, stage->mem);
-
-            stbi_image_free(pixels);
-
-            out = vk2dImageCreate(dev, texWidth, texHeight, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_ASPECT_COLOR_BIT,
-                                  VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, 1);
-
-
-            if (out != NULL) {
-                _vk2dImageTransitionImageLayout(dev, out->img, VK_IMAGE_LAYOUT_UNDEFINED,
-                                                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, true);
-                _vk2dImageCopyBufferToImage(dev, stage->buf, out->img, texWidth, texHeight, true);
-                _vk2dImageTransitionImageLayout(dev, out->img, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                                                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, true);
-            }
-
-            vk2dBufferFree(stage);
-        }
+		out = vk2dImageFromPixels(dev, pixels, texWidth, texHeight, true);
+		stbi_image_free(pixels);
 	} else {
         vk2dRaise(VK2D_STATUS_FILE_NOT_FOUND, "Failed to load image \"%s\".", filename);
 	}
@@ -211,37 +156,18 @@ VK2DImage vk2dImageLoad(VK2DLogicalDevice dev, const char *filename) {
 }
 
 VK2DImage vk2dImageFromPixels(VK2DLogicalDevice dev, void *pixels, int w, int h, bool mainThread) {
-	VK2DRenderer gRenderer = vk2dRendererGetPointer();
 	VK2DImage out = NULL;
-	VK2DBuffer stage;
 
+	// A batch of one still records the transitions and copy together and submits once, the
+	// main thread doesn't need to wait since anything using the image is submitted after it
 	if (pixels != NULL) {
-		stage = vk2dBufferCreate(dev, w * h * 4, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-								 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-        if (stage != NULL) {
-            void *data;
-            VkResult result = vmaMapMemory(gRenderer->vma, stage->mem, &data);
-            if (result == VK_SUCCESS) {
-                memcpy(data, pixels, w * h * 4);
-                vmaUnmapMemory(gRenderer->vma, stage->mem);
-
-                out = vk2dImageCreate(dev, w, h, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_ASPECT_COLOR_BIT,
-                                      VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, 1);
-
-
-                if (out != NULL) {
-                    _vk2dImageTransitionImageLayout(dev, out->img, VK_IMAGE_LAYOUT_UNDEFINED,
-                                                    VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, mainThread);
-                    _vk2dImageCopyBufferToImage(dev, stage->buf, out->img, w, h, mainThread);
-                    _vk2dImageTransitionImageLayout(dev, out->img, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                                                    VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, mainThread);
-                }
-            } else {
-                vk2dRaise(VK2D_STATUS_VULKAN_ERROR, "Failed to map memory, VMA error %i.", result);
-            }
-
-            vk2dBufferFree(stage);
-        }
+		VK2DUploadBatch batch = vk2dUploadBatchCreate(dev, mainThread);
+		if (batch != NULL) {
+			out = vk2dUploadBatchAddImage(batch, pixels, w, h);
+			if (!mainThread)
+				vk2dUploadBatchFlush(batch);
+			vk2dUploadBatchFree(batch);
+		}
 	}
 
 	return out;
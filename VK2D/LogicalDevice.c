@@ -7,6 +7,7 @@
 #include "VK2D/Opaque.h"
 #include "VK2D/Util.h"
 #include "VK2D/Renderer.h"
+#include "VK2D/UploadBatch.h"
 
 #ifndef __APPLE__
 #include <malloc.h>
@@ -19,12 +20,10 @@
 #include <memory.h>
 #endif
 
-VK2DLogicalDevice gDeviceFromMainThread;
-
 VK2DLogicalDevice vk2dLogicalDeviceCreate(VK2DPhysicalDevice dev, bool enableAllFeatures, bool graphicsDevice, bool debug, VK2DRendererLimits *limits) {
     vk2dLog("Creating queues...");
 	VK2DRenderer gRenderer = vk2dRendererGetPointer();
-	VK2DLogicalDevice ldev = malloc(sizeof(struct VK2DLogicalDevice_t));
+	VK2DLogicalDevice ldev = calloc(1, sizeof(struct VK2DLogicalDevice_t));
 	uint32_t queueFamily = graphicsDevice == true ? dev->QueueFamily.graphicsFamily : dev->QueueFamily.computeFamily;
 
 	// Find any optional extensions
@@ -35,9 +34,12 @@ VK2DLogicalDevice vk2dLogicalDeviceCreate(VK2DPhysicalDevice dev, bool enableAll
     vkEnumerateDeviceExtensionProperties(dev->dev, VK_NULL_HANDLE, &extensionCount, props);
     const bool instanceExtensionSupported = gRenderer->limits.supportsVRAMUsage;
     gRenderer->limits.supportsVRAMUsage = false;
+    limits->supportsPushDescriptors = false;
 	for (int i = 0; i < extensionCount; i++) {
 	    if (strcmp(props[i].extensionName, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME) == 0 && instanceExtensionSupported)
 	        gRenderer->limits.supportsVRAMUsage = true;
+	    if (strcmp(props[i].extensionName, VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME) == 0)
+	        limits->supportsPushDescriptors = true;
 	}
     free(props);
 
@@ -66,7 +68,10 @@ VK2DLogicalDevice vk2dLogicalDeviceCreate(VK2DPhysicalDevice dev, bool enableAll
 			} else {
 				limits->maxMSAA = 1;
 			}
+			if (dev->feats.multiDrawIndirect)
+				feats.multiDrawIndirect = VK_TRUE;
 		}
+		limits->supportsGPUCulling = feats.multiDrawIndirect == VK_TRUE;
 
 		// For dynamic descriptor arrays
         VkPhysicalDeviceDescriptorIndexingFeatures indexingFeatures = {
@@ -83,8 +88,9 @@ VK2DLogicalDevice vk2dLogicalDeviceCreate(VK2DPhysicalDevice dev, bool enableAll
 		float priority[] = {1, 1};
 		VkDeviceQueueCreateInfo queueCreateInfo = vk2dInitDeviceQueueCreateInfo(queueFamily, priority);
 		queueCreateInfo.queueCount = gRenderer->limits.supportsMultiThreadLoading ? 2 : 1;
-		VkDeviceQueueCreateInfo queues[] = {queueCreateInfo};
-		VkDeviceCreateInfo deviceCreateInfo = vk2dInitDeviceCreateInfo(queues, 1, &feats, debug);
+		VkDeviceQueueCreateInfo queues[] = {queueCreateInfo, vk2dInitDeviceQueueCreateInfo(dev->QueueFamily.transferFamily, priority)};
+		limits->supportsTransferQueue = graphicsDevice && gRenderer->options.transferQueueUploads && dev->QueueFamily.transferFamily != queueFamily;
+		VkDeviceCreateInfo deviceCreateInfo = vk2dInitDeviceCreateInfo(queues, limits->supportsTransferQueue ? 2 : 1, &feats, debug);
         deviceCreateInfo.pNext = &indexingFeatures;
 
         // Device layers and extensions
@@ -98,6 +104,9 @@ VK2DLogicalDevice vk2dLogicalDeviceCreate(VK2DPhysicalDevice dev, bool enableAll
         if (gRenderer->limits.supportsVRAMUsage) {
             deviceExtensions[deviceExtensionCount++] = VK_EXT_MEMORY_BUDGET_EXTENSION_NAME;
         }
+        if (limits->supportsPushDescriptors) {
+            deviceExtensions[deviceExtensionCount++] = VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME;
+        }
         deviceCreateInfo.enabledExtensionCount = deviceExtensionCount;
         deviceCreateInfo.ppEnabledExtensionNames = deviceExtensions;
         deviceCreateInfo.enabledLayerCount = deviceLayerCount;
@@ -111,6 +120,11 @@ VK2DLogicalDevice vk2dLogicalDeviceCreate(VK2DPhysicalDevice dev, bool enableAll
 		    return NULL;
 		}
 		ldev->pd = dev;
+		ldev->cmdPushDescriptorSet = VK_NULL_HANDLE;
+		if (limits->supportsPushDescriptors) {
+			ldev->cmdPushDescriptorSet = (PFN_vkCmdPushDescriptorSetKHR)vkGetDeviceProcAddr(ldev->dev, "vkCmdPushDescriptorSetKHR");
+			limits->supportsPushDescriptors = ldev->cmdPushDescriptorSet != VK_NULL_HANDLE;
+		}
 		vkGetDeviceQueue(ldev->dev, queueFamily, 0, &ldev->queue);
 		if (queueCreateInfo.queueCount == 2)
 			vkGetDeviceQueue(ldev->dev, queueFamily, 1, &ldev->loadQueue);
@@ -123,28 +137,75 @@ VK2DLogicalDevice vk2dLogicalDeviceCreate(VK2DPhysicalDevice dev, bool enableAll
             return NULL;
         }
 
+        // Optional transfer queue for descriptor buffer uploads
+        ldev->transferQueue = VK_NULL_HANDLE;
+        ldev->transferPool = VK_NULL_HANDLE;
+        if (limits->supportsTransferQueue) {
+            vk2dLog("Creating transfer queue...");
+            vkGetDeviceQueue(ldev->dev, dev->QueueFamily.transferFamily, 0, &ldev->transferQueue);
+            VkCommandPoolCreateInfo transferPoolCreateInfo = vk2dInitCommandPoolCreateInfo(dev->QueueFamily.transferFamily, VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
+            result = vkCreateCommandPool(ldev->dev, &transferPoolCreateInfo, VK_NULL_HANDLE, &ldev->transferPool);
+            if (result != VK_SUCCESS) {
+                vk2dRaise(VK2D_STATUS_VULKAN_ERROR, "Failed to create transfer command pool, Vulkan error %i.", result);
+                free(ldev);
+                return NULL;
+            }
+        }
+
+		ldev->uploadMutex = NULL;
+		ldev->workerThreads = NULL;
+		ldev->workerCount = 0;
 		if (gRenderer->limits.supportsMultiThreadLoading) {
-            vk2dLog("Creating worker thread...");
-			ldev->loadList = NULL;
+			// Off-thread uploads all go through one pool guarded by uploadMutex
+			VkCommandPoolCreateInfo loadPoolCreateInfo = vk2dInitCommandPoolCreateInfo(queueFamily, VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
+			result = vkCreateCommandPool(ldev->dev, &loadPoolCreateInfo, VK_NULL_HANDLE, &ldev->loadPool);
+			if (result != VK_SUCCESS) {
+				vk2dRaise(VK2D_STATUS_VULKAN_ERROR, "Failed to create load command pool, Vulkan error %i.", result);
+				free(ldev);
+				return NULL;
+			}
+
+			uint32_t threadCount = gRenderer->options.loadThreads;
+			if (threadCount == 0)
+				threadCount = SDL_GetNumLogicalCPUCores() > 1 ? SDL_GetNumLogicalCPUCores() - 1 : 1;
+			if (threadCount > VK2D_MAX_LOAD_THREADS)
+				threadCount = VK2D_MAX_LOAD_THREADS;
+            vk2dLog("Creating %i worker threads...", threadCount);
 			ldev->loadListMutex = SDL_CreateMutex();
 			ldev->shaderMutex = SDL_CreateMutex();
+			ldev->uploadMutex = SDL_CreateMutex();
+			ldev->loadCondition = SDL_CreateCondition();
+			ldev->doneCondition = SDL_CreateCondition();
+			ldev->workerThreads = calloc(threadCount, sizeof(SDL_Thread*));
+			const bool queueCreated = _vk2dAssetQueueCreate(&ldev->assetQueue, VK2D_ASSET_QUEUE_SIZE);
 
-			SDL_SetAtomicInt(&ldev->loadListSize, 0);
 			SDL_SetAtomicInt(&ldev->quitThread, 0);
-			SDL_SetAtomicInt(&ldev->loads, 0);
-			SDL_SetAtomicInt(&ldev->doneLoading, 1);
-			gDeviceFromMainThread = ldev;
-			ldev->workerThread = SDL_CreateThread(_vk2dWorkerThread, "VK2D_Load", NULL);
 
-			if (ldev->loadListMutex == NULL || ldev->workerThread == NULL || ldev->shaderMutex == NULL) {
-                vk2dRaise(VK2D_STATUS_SDL_ERROR, "Failed to initialize worker thread, SDL error: %s", SDL_GetError());
+			// Any threads that start are enough to load with
+			if (ldev->loadListMutex != NULL && ldev->shaderMutex != NULL && ldev->uploadMutex != NULL && ldev->loadCondition != NULL && ldev->doneCondition != NULL && ldev->workerThreads != NULL && queueCreated) {
+				for (uint32_t i = 0; i < threadCount; i++) {
+					ldev->workerThreads[ldev->workerCount] = SDL_CreateThread(_vk2dWorkerThread, "VK2D_Load", ldev);
+					if (ldev->workerThreads[ldev->workerCount] != NULL)
+						ldev->workerCount++;
+				}
+			}
+
+			if (ldev->workerCount == 0) {
+                vk2dRaise(VK2D_STATUS_SDL_ERROR, "Failed to initialize worker threads, SDL error: %s", SDL_GetError());
                 gRenderer->limits.supportsMultiThreadLoading = false;
                 SDL_DestroyMutex(ldev->loadListMutex);
                 SDL_DestroyMutex(ldev->shaderMutex);
-                SDL_DetachThread(ldev->workerThread);
+                SDL_DestroyMutex(ldev->uploadMutex);
+                SDL_DestroyCondition(ldev->loadCondition);
+                SDL_DestroyCondition(ldev->doneCondition);
+                if (queueCreated)
+                    _vk2dAssetQueueDestroy(&ldev->assetQueue);
+                free(ldev->workerThreads);
+                vkDestroyCommandPool(ldev->dev, ldev->loadPool, VK_NULL_HANDLE);
                 ldev->loadListMutex = NULL;
                 ldev->shaderMutex = NULL;
-                ldev->workerThread = NULL;
+                ldev->uploadMutex = NULL;
+                ldev->workerThreads = NULL;
             }
 		}
 	} else {
@@ -157,15 +218,34 @@ VK2DLogicalDevice vk2dLogicalDeviceCreate(VK2DPhysicalDevice dev, bool enableAll
 void vk2dLogicalDeviceFree(VK2DLogicalDevice dev) {
 	VK2DRenderer gRenderer = vk2dRendererGetPointer();
 	if (dev != NULL) {
-		SDL_SetAtomicInt(&dev->quitThread, 1);
-		int status;
 		if (gRenderer->limits.supportsMultiThreadLoading) {
-			SDL_WaitThread(dev->workerThread, &status);
+			// Wake up every thread so they see they need to quit
+			SDL_LockMutex(dev->loadListMutex);
+			SDL_SetAtomicInt(&dev->quitThread, 1);
+			SDL_BroadcastCondition(dev->loadCondition);
+			SDL_UnlockMutex(dev->loadListMutex);
+			for (uint32_t i = 0; i < dev->workerCount; i++)
+				SDL_WaitThread(dev->workerThreads[i], NULL);
+			free(dev->workerThreads);
+
+			// Groups that were still loading when the renderer quit
+			while (dev->loadGroups != NULL) {
+				_VK2DLoadGroup *next = dev->loadGroups->next;
+				free(dev->loadGroups->assets);
+				free(dev->loadGroups);
+				dev->loadGroups = next;
+			}
+			_vk2dAssetQueueDestroy(&dev->assetQueue);
+			SDL_DestroyCondition(dev->loadCondition);
+			SDL_DestroyCondition(dev->doneCondition);
 			SDL_DestroyMutex(dev->loadListMutex);
 			SDL_DestroyMutex(dev->shaderMutex);
+			SDL_DestroyMutex(dev->uploadMutex);
 			vkDestroyCommandPool(dev->dev, dev->loadPool, VK_NULL_HANDLE);
 		}
 		vkDestroyCommandPool(dev->dev, dev->pool, VK_NULL_HANDLE);
+		if (dev->transferPool != VK_NULL_HANDLE)
+			vkDestroyCommandPool(dev->dev, dev->transferPool, VK_NULL_HANDLE);
 		vkDestroyDevice(dev->dev, VK_NULL_HANDLE);
 		free(dev);
 	}
@@ -189,6 +269,18 @@ VkCommandBuffer vk2dLogicalDeviceGetCommandBuffer(VK2DLogicalDevice dev, bool pr
 	return buffer;
 }
 
+VkCommandBuffer vk2dLogicalDeviceGetTransferCommandBuffer(VK2DLogicalDevice dev) {
+	if (dev->transferPool == VK_NULL_HANDLE)
+		return vk2dLogicalDeviceGetCommandBuffer(dev, true);
+	VkCommandBufferAllocateInfo allocInfo = vk2dInitCommandBufferAllocateInfo(dev->transferPool, 1);
+	VkCommandBuffer buffer;
+	VkResult result = vkAllocateCommandBuffers(dev->dev, &allocInfo, &buffer);
+    if (result != VK_SUCCESS) {
+        vk2dRaise(VK2D_STATUS_VULKAN_ERROR, "Failed to get transfer command buffer, Vulkan error %i", result);
+    }
+	return buffer;
+}
+
 void vk2dLogicalDeviceGetCommandBuffers(VK2DLogicalDevice dev, bool primary, uint32_t n, VkCommandBuffer *list) {
 	VkCommandBufferAllocateInfo allocInfo = vk2dInitCommandBufferAllocateInfo(dev->pool, n);
 	allocInfo.level = primary ? VK_COMMAND_BUFFER_LEVEL_PRIMARY : VK_COMMAND_BUFFER_LEVEL_SECONDARY;
@@ -204,12 +296,19 @@ void vk2dLogicalDeviceFreeCommandBuffer(VK2DLogicalDevice dev, VkCommandBuffer b
 
 VkCommandBuffer vk2dLogicalDeviceGetSingleUseBuffer(VK2DLogicalDevice dev, bool mainThread) {
 	VkCommandBufferAllocateInfo allocInfo = vk2dInitCommandBufferAllocateInfo(dev->pool, 1);
-	if (!mainThread)
+
+	// Loader threads share the load pool and queue, so it stays locked until the buffer is submitted
+	if (!mainThread) {
+		SDL_LockMutex(dev->uploadMutex);
 		allocInfo.commandPool = dev->loadPool;
+	}
 	VkCommandBuffer buffer;
 	VkResult result = vkAllocateCommandBuffers(dev->dev, &allocInfo, &buffer);
     if (result != VK_SUCCESS) {
         vk2dRaise(VK2D_STATUS_VULKAN_ERROR, "Failed to allocate command buffers, Vulkan error %i", result);
+        if (!mainThread)
+            SDL_UnlockMutex(dev->uploadMutex);
+        return VK_NULL_HANDLE;
     }
 	VkCommandBufferBeginInfo beginInfo = vk2dInitCommandBufferBeginInfo(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT, VK_NULL_HANDLE);
 	result = vkBeginCommandBuffer(buffer, &beginInfo);
@@ -246,9 +345,52 @@ void vk2dLogicalDeviceSubmitSingleBuffer(VK2DLogicalDevice dev, VkCommandBuffer
         } else {
             vk2dRaise(VK2D_STATUS_VULKAN_ERROR, "Failed to submit queue, Vulkan error %i", result);
         }
+		SDL_UnlockMutex(dev->uploadMutex);
 	}
 }
 
+void vk2dLogicalDeviceCreateStaging(VK2DLogicalDevice dev) {
+	_vk2dStagingRingCreate(&dev->stagingRing, dev, VK2D_STAGING_RING_SIZE);
+	if (dev->workerCount > 0) {
+		dev->loadRings = calloc(dev->workerCount, sizeof(_VK2DStagingRing));
+		if (dev->loadRings != NULL) {
+			for (uint32_t i = 0; i < dev->workerCount; i++)
+				_vk2dStagingRingCreate(&dev->loadRings[i], dev, VK2D_LOAD_STAGING_RING_SIZE);
+		} else {
+			vk2dRaise(VK2D_STATUS_OUT_OF_RAM, "Failed to allocate loader staging rings.");
+		}
+	}
+}
+
+void vk2dLogicalDeviceFreeStaging(VK2DLogicalDevice dev) {
+	_vk2dStagingRingDestroy(&dev->stagingRing);
+	if (dev->loadRings != NULL) {
+		for (uint32_t i = 0; i < dev->workerCount; i++)
+			_vk2dStagingRingDestroy(&dev->loadRings[i]);
+		free(dev->loadRings);
+		dev->loadRings = NULL;
+	}
+}
+
+_VK2DStagingRing *vk2dLogicalDeviceAcquireLoadRing(VK2DLogicalDevice dev) {
+	_VK2DStagingRing *ring = NULL;
+	SDL_LockMutex(dev->uploadMutex);
+	for (uint32_t i = 0; i < dev->workerCount && dev->loadRings != NULL && ring == NULL; i++) {
+		if (!dev->loadRings[i].inUse && dev->loadRings[i].dev != NULL) {
+			ring = &dev->loadRings[i];
+			ring->inUse = true;
+		}
+	}
+	SDL_UnlockMutex(dev->uploadMutex);
+	return ring;
+}
+
+void vk2dLogicalDeviceReleaseLoadRing(VK2DLogicalDevice dev, _VK2DStagingRing *ring) {
+	SDL_LockMutex(dev->uploadMutex);
+	ring->inUse = false;
+	SDL_UnlockMutex(dev->uploadMutex);
+}
+
 VkFence vk2dLogicalDeviceGetFence(VK2DLogicalDevice dev, VkFenceCreateFlagBits flags) {
 	VkFenceCreateInfo fenceCreateInfo = vk2dInitFenceCreateInfo(flags);
 	VkFence fence;
@@ -50,6 +50,11 @@ void vk2dLogicalDeviceResetPool(VK2DLogicalDevice dev);
 /// \return Returns a VkCommandBuffer in the initial state (see Vulkan spec for more info on command buffer states)
 VkCommandBuffer vk2dLogicalDeviceGetCommandBuffer(VK2DLogicalDevice dev, bool primary);
 
+/// \brief Gets a primary command buffer that can be submitted to the device's transfer queue
+/// \param dev Logical device to get the buffer from
+/// \return Returns a VkCommandBuffer in the initial state, from the regular pool if the device has no transfer queue
+VkCommandBuffer vk2dLogicalDeviceGetTransferCommandBuffer(VK2DLogicalDevice dev);
+
 /// \brief Fills a list with new command buffers
 /// \param dev Device to get the buffers from
 /// \param pool Pool to get the buffers from
@@ -79,6 +84,26 @@ VkCommandBuffer vk2dLogicalDeviceGetSingleUseBuffer(VK2DLogicalDevice dev, bool
 /// to idle. After that it will free the buffer.
 void vk2dLogicalDeviceSubmitSingleBuffer(VK2DLogicalDevice dev, VkCommandBuffer buffer, bool mainThread);
 
+/// \brief Creates the logical device's staging rings, must be called once VMA is ready
+/// \param dev Device to create the staging rings of
+void vk2dLogicalDeviceCreateStaging(VK2DLogicalDevice dev);
+
+/// \brief Waits on and frees the logical device's staging rings, must be called before VMA is destroyed
+/// \param dev Device to free the staging rings of
+void vk2dLogicalDeviceFreeStaging(VK2DLogicalDevice dev);
+
+struct _VK2DStagingRing;
+
+/// \brief Checks out a free loader thread staging ring
+/// \param dev Device to get the ring from
+/// \return Returns a ring nobody else is using or NULL if they're all taken
+struct _VK2DStagingRing *vk2dLogicalDeviceAcquireLoadRing(VK2DLogicalDevice dev);
+
+/// \brief Returns a ring from vk2dLogicalDeviceAcquireLoadRing so other loader threads may use it
+/// \param dev Device the ring came from
+/// \param ring Ring to return
+void vk2dLogicalDeviceReleaseLoadRing(VK2DLogicalDevice dev, struct _VK2DStagingRing *ring);
+
 /// \brief Grabs a fence from a logical device
 /// \param dev Logical device to get the fence from
 /// \param flags Flags to use when creating the fence (Refer to Vulkan spec)
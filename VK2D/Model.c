@@ -9,22 +9,25 @@
 #include "VK2D/Validation.h"
 #include "VK2D/Opaque.h"
 #include "VK2D/Util.h"
+#include "VK2D/UploadBatch.h"
 
-// Needed to use buffers for tinyobjloader
-static const void *gTinyObjBuffer;
-static int gTinyObjBufferSize;
-
-// For tinyobjloader
+// For tinyobjloader, ctx is the _VK2DModelFileData being parsed so models can load on several threads at once
 static void _getFileData(void* ctx, const char* filename, const int is_mtl,
 						  const char* obj_filename, char** data, size_t* len) {
-	*data = (void*)gTinyObjBuffer;
-	*len = gTinyObjBufferSize;
+	_VK2DModelFileData *file = ctx;
+	*data = (void*)file->data;
+	*len = file->size;
 }
 
-VK2DModel _vk2dModelCreateInternal(const VK2DVertex3D *vertices, uint32_t vertexCount, const uint16_t *indices, uint32_t indexCount, VK2DTexture tex, bool mainThread) {
+// If batch is NULL the vertices are uploaded right away on the main thread
+VK2DModel _vk2dModelCreateInternal(const VK2DVertex3D *vertices, uint32_t vertexCount, const uint16_t *indices, uint32_t indexCount, VK2DTexture tex, VK2DUploadBatch batch) {
 	VK2DModel model = malloc(sizeof(struct VK2DModel_t));
 	if (model != NULL) {
-        VK2DBuffer buf = vk2dBufferLoad2(vk2dRendererGetDevice(), sizeof(VK2DVertex3D) * vertexCount, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, (void*)vertices, sizeof(uint16_t) * indexCount, (void*)indices, mainThread);
+        VK2DBuffer buf;
+        if (batch != NULL)
+            buf = vk2dUploadBatchAddBuffer(batch, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, vertices, sizeof(VK2DVertex3D) * vertexCount, indices, sizeof(uint16_t) * indexCount);
+        else
+            buf = vk2dBufferLoad2(vk2dRendererGetDevice(), sizeof(VK2DVertex3D) * vertexCount, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, (void*)vertices, sizeof(uint16_t) * indexCount, (void*)indices, true);
 
         if (buf != NULL && model != NULL) {
             model->vertices = buf;
@@ -43,7 +46,7 @@ VK2DModel _vk2dModelCreateInternal(const VK2DVertex3D *vertices, uint32_t vertex
 }
 
 VK2DModel vk2dModelCreate(const VK2DVertex3D *vertices, uint32_t vertexCount, const uint16_t *indices, uint32_t indexCount, VK2DTexture tex) {
-	VK2DModel model = _vk2dModelCreateInternal(vertices, vertexCount, indices, indexCount, tex, true);
+	VK2DModel model = _vk2dModelCreateInternal(vertices, vertexCount, indices, indexCount, tex, NULL);
 	return model;
 }
 
@@ -54,11 +57,10 @@ static inline bool verticesAreEqual(VK2DVertex3D *v1, VK2DVertex3D *v2) {
 	return false;
 }
 
-VK2DModel _vk2dModelFromInternal(const void *objFile, uint32_t objFileSize, VK2DTexture texture, bool mainThread) {
+VK2DModel _vk2dModelFromInternal(const void *objFile, uint32_t objFileSize, VK2DTexture texture, VK2DUploadBatch batch) {
     if (vk2dStatusFatal())
         return NULL;
-	gTinyObjBuffer = objFile;
-	gTinyObjBufferSize = objFileSize;
+	_VK2DModelFileData file = {objFile, objFileSize};
 	VK2DModel m = NULL;
 
 	tinyobj_attrib_t attrib;
@@ -66,7 +68,7 @@ VK2DModel _vk2dModelFromInternal(const void *objFile, uint32_t objFileSize, VK2D
 	size_t num_shapes;
 	tinyobj_material_t* materials = NULL;
 	size_t num_materials;
-	int status = tinyobj_parse_obj(&attrib, &shapes, &num_shapes, &materials, &num_materials, "abcdef", _getFileData, NULL, TINYOBJ_FLAG_TRIANGULATE);
+	int status = tinyobj_parse_obj(&attrib, &shapes, &num_shapes, &materials, &num_materials, "abcdef", _getFileData, &file, TINYOBJ_FLAG_TRIANGULATE);
 
 	if (status == TINYOBJ_SUCCESS) {
 		// Create lists for the worst case, actual parsed indices/vertices will likely we less
@@ -104,7 +106,7 @@ VK2DModel _vk2dModelFromInternal(const void *objFile, uint32_t objFileSize, VK2D
 				}
 			}
 
-			m = _vk2dModelCreateInternal(vertices, vertexCount, indices, indexCount, texture, mainThread);
+			m = _vk2dModelCreateInternal(vertices, vertexCount, indices, indexCount, texture, batch);
 		} else {
 			m = NULL;
 		}
@@ -124,7 +126,7 @@ VK2DModel _vk2dModelFromInternal(const void *objFile, uint32_t objFileSize, VK2D
 VK2DModel vk2dModelFrom(const void *objFile, uint32_t objFileSize, VK2DTexture texture) {
     if (vk2dStatusFatal())
         return NULL;
-	VK2DModel model = _vk2dModelFromInternal(objFile, objFileSize, texture, true);
+	VK2DModel model = _vk2dModelFromInternal(objFile, objFileSize, texture, NULL);
 	return model;
 }
 
@@ -135,7 +137,7 @@ VK2DModel vk2dModelLoad(const char *objFile, VK2DTexture texture) {
 	uint32_t size;
 	const void *data = _vk2dLoadFile(objFile, &size);
 	if (data != NULL) {
-        m = _vk2dModelFromInternal(data, size, texture, true);
+        m = _vk2dModelFromInternal(data, size, texture, NULL);
         free((void *) data);
     }
 	return m;
@@ -20,28 +20,98 @@ struct VK2DPhysicalDevice_t {
 	struct {
 		uint32_t graphicsFamily; ///< Queue family for graphics pipeline
 		uint32_t computeFamily;  ///< Queue family for compute pipeline
+		uint32_t transferFamily; ///< Transfer-only queue family, or the graphics family if the device doesn't have one
 	} QueueFamily;               ///< Nicely groups up queue families
 	VkPhysicalDeviceMemoryProperties mem; ///< Memory properties of this device
 	VkPhysicalDeviceFeatures feats;       ///< Features of this device
 	VkPhysicalDeviceProperties props;     ///< Device properties
 };
 
+/// \brief Assets queued together by vk2dAssetsQueue
+///
+/// Everything but assets, count, earlyCount and id is guarded by the device's loadListMutex.
+typedef struct _VK2DLoadGroup {
+	VK2DAssetLoad *assets;       ///< Copy of the list being loaded with the models moved to the end
+	uint32_t count;              ///< Number of assets in the group
+	uint32_t earlyCount;         ///< Number of assets at the start of the list that aren't models
+	uint32_t nextToQueue;        ///< Next asset to move into the device's asset queue
+	uint32_t earlyLoads;         ///< Assets before earlyCount that haven't been loaded, models can't be queued until this is 0
+	uint32_t loads;              ///< Assets that haven't been loaded or skipped, the group is removed once this is 0
+	int32_t priority;            ///< Groups with a higher priority are queued first
+	VK2DAssetGroup id;           ///< Handle the user refers to this group with
+	bool cancelled;              ///< Assets left in a cancelled group are skipped instead of loaded
+	struct _VK2DLoadGroup *next; ///< Next group in the device's list
+} _VK2DLoadGroup;
+
+/// \brief One slot in an asset queue
+typedef struct _VK2DAssetQueueCell {
+	SDL_AtomicInt sequence; ///< Which push/pop this slot is waiting on
+	VK2DAssetLoad *asset;   ///< Asset in this slot
+	_VK2DLoadGroup *group;  ///< Group the asset belongs to
+} _VK2DAssetQueueCell;
+
+/// \brief Bounded lock-free queue any number of threads may push to and pop from at once
+typedef struct _VK2DAssetQueue {
+	_VK2DAssetQueueCell *cells; ///< Slots, the count is always a power of two
+	uint32_t mask;              ///< Number of slots minus one
+	SDL_AtomicInt enqueuePos;   ///< Total pushes so far
+	SDL_AtomicInt dequeuePos;   ///< Total pops so far
+} _VK2DAssetQueue;
+
+/// \brief Part of a staging ring that was submitted to the GPU and may still be read from
+typedef struct _VK2DStagingSpan {
+	VkDeviceSize end;              ///< One past the last byte of the span, it starts where the previous span ended
+	VkFence fence;                 ///< Signalled once the GPU is done with the span, each slot keeps its fence for the ring's lifetime
+	VkCommandBuffer commandBuffer; ///< Command buffer that read the span, freed back to the ring's pool once the fence signals
+} _VK2DStagingSpan;
+
+/// \brief Persistently mapped staging buffer that uploads suballocate from in a circle
+///
+/// Only one thread may use a ring at a time. Allocations made since the last submission are
+/// "open", on submission they become a span tracked by a fence and the ring only blocks when
+/// an allocation would wrap onto a span the GPU hasn't finished with.
+typedef struct _VK2DStagingRing {
+	VK2DLogicalDevice dev;                        ///< Device this ring belongs to, NULL if the ring was never created
+	VK2DBuffer buffer;                            ///< Host-visible buffer everything is staged in
+	uint8_t *data;                                ///< Persistently mapped pointer to buffer
+	VkDeviceSize size;                            ///< Size of buffer in bytes, it grows if a single upload doesn't fit
+	VkDeviceSize head;                            ///< Where the next allocation goes
+	VkDeviceSize tail;                            ///< Start of the oldest span that's still in flight
+	VkDeviceSize openStart;                       ///< Start of the allocations that haven't been submitted yet
+	_VK2DStagingSpan spans[VK2D_STAGING_RING_SPANS]; ///< In-flight spans as a circular list, oldest first
+	uint32_t firstSpan;                           ///< Index of the oldest span in spans
+	uint32_t spanCount;                           ///< Number of spans in flight
+	VkCommandPool pool;                           ///< Pool upload command buffers using this ring come from
+	bool inUse;                                   ///< For loader rings, whether or not an upload batch has this ring
+} _VK2DStagingRing;
+
 /// \brief Logical device that is essentially a wrapper of VkDevice
 struct VK2DLogicalDevice_t {
 	VkDevice dev;               ///< Logical device
 	VkQueue queue;              ///< Queue for command buffers
 	VkQueue loadQueue;          ///< Queue for off-thread loading
+	VkQueue transferQueue;      ///< Dedicated transfer queue for descriptor buffer uploads, or VK_NULL_HANDLE if it isn't used
 	VK2DPhysicalDevice pd;      ///< Physical device this came from
 	VkCommandPool pool;         ///< Command pools to cycle through
 	VkCommandPool loadPool;     ///< Command pool for off-thread loading
-	SDL_AtomicInt loadListSize; ///< Size of the asset load list
-	VK2DAssetLoad *loadList;    ///< Assets that need to be loaded
-	SDL_Mutex *loadListMutex;   ///< Mutex for asset load list synchronization
-	SDL_Thread *workerThread;   ///< Thread that loads assets
-	SDL_AtomicInt quitThread;   ///< How to tell the thread to quit
-	SDL_AtomicInt loads;        ///< Number of loads waiting in the list
-	SDL_AtomicInt doneLoading;  ///< To know when loading is complete
-    SDL_Mutex *shaderMutex;     ///< Mutex for creating shaders
+	VkCommandPool transferPool; ///< Command pool for the transfer queue
+	PFN_vkCmdPushDescriptorSetKHR cmdPushDescriptorSet; ///< vkCmdPushDescriptorSetKHR if VK_KHR_push_descriptor is enabled
+	SDL_Mutex *loadListMutex;     ///< Guards the load groups, the loader threads sleep on it and the asset waits wait on it
+	SDL_Condition *loadCondition; ///< Signalled when assets are queued or the loader threads should quit
+	SDL_Condition *doneCondition; ///< Signalled whenever a load group finishes
+	SDL_Mutex *uploadMutex;       ///< Guards the load pool, load queue, loader staging rings and texture array between loader threads
+	_VK2DAssetQueue assetQueue;   ///< Assets from the load groups waiting for a loader thread
+	_VK2DLoadGroup *loadGroups;   ///< Groups with assets left to load, highest priority first
+	VK2DAssetGroup nextLoadGroup; ///< ID the next load group will get
+	uint32_t queuedAssets;        ///< Number of assets sitting in assetQueue
+	uint32_t totalAssets;         ///< Assets queued since the loader threads were last idle
+	uint32_t finishedAssets;      ///< How many of totalAssets have been loaded or skipped
+	SDL_Thread **workerThreads;   ///< Threads that load assets
+	uint32_t workerCount;         ///< Number of threads in workerThreads
+	SDL_AtomicInt quitThread;     ///< How to tell the threads to quit
+    SDL_Mutex *shaderMutex;       ///< Mutex for creating shaders
+	_VK2DStagingRing stagingRing; ///< Staging ring for uploads from the main thread
+	_VK2DStagingRing *loadRings;  ///< One staging ring per loader thread, handed out to upload batches under uploadMutex
 };
 
 /// \brief An internal representation of a camera (the user deals with VK2DCameraIndex, the renderer uses this struct)
@@ -62,12 +132,75 @@ struct VK2DBuffer_t {
 	VkDeviceSize offset;   ///< Offset for this buffer in bytes
 };
 
+/// \brief Records many uploads into one staging arena and command buffer so they go to the GPU in one submission
+struct VK2DUploadBatch_t {
+	VK2DLogicalDevice dev;  ///< Device the uploads go to
+	bool mainThread;        ///< Main thread batches submit to the main queue, others go through the load queue
+	_VK2DStagingRing *ring; ///< Staging ring uploads are copied into, the device's main ring or a loader ring this batch has checked out
+	VkCommandBuffer buffer; ///< Command buffer the copies and layout transitions are being recorded into, or VK_NULL_HANDLE
+	VkFence fence;          ///< Fence of the last submission, or VK_NULL_HANDLE once it's been waited on
+};
+
+/// \brief Header placed in front of the driver's data in pipeline cache files
+typedef struct _VK2DPipelineCacheHeader {
+	uint32_t magic;                        ///< Always VK2D_PIPELINE_CACHE_MAGIC
+	uint32_t vendorID;                     ///< Vendor of the device the cache was written by
+	uint32_t deviceID;                     ///< Device the cache was written by
+	uint32_t driverVersion;                ///< Driver version the cache was written by
+	uint8_t pipelineCacheUUID[VK_UUID_SIZE]; ///< Pipeline cache UUID of the device the cache was written by
+	uint64_t dataSize;                     ///< Size of the driver's data that follows the header
+} _VK2DPipelineCacheHeader;
+
+/// \brief OBJ file tinyobjloader is reading from
+typedef struct _VK2DModelFileData {
+	const void *data; ///< File contents
+	int size;         ///< Size of data in bytes
+} _VK2DModelFileData;
+
+/// \brief One pipeline for _vk2dRendererCreatePipelines to create on a worker thread
+typedef struct _VK2DPipelineJob {
+	VK2DPipeline *pipe;        ///< Where the new pipeline is stored, unused for custom shaders
+	VK2DShader shader;         ///< Custom shader to build the pipeline for, or NULL for a built-in pipeline
+	unsigned char *vert;       ///< Vertex shader SPIR-V, or the compute shader for compute pipelines
+	uint32_t vertSize;         ///< Size of vert in bytes
+	unsigned char *frag;       ///< Fragment shader SPIR-V
+	uint32_t fragSize;         ///< Size of frag in bytes
+	VkDescriptorSetLayout *layouts; ///< Set layouts the pipeline uses
+	uint32_t layoutCount;      ///< Number of set layouts
+	VkPipelineVertexInputStateCreateInfo *vertexInfo; ///< Vertex input for graphics pipelines
+	bool fill;                 ///< Whether polygons are filled or drawn as lines
+	VK2DPipelineType type;     ///< Type of graphics pipeline
+	bool compute;              ///< Creates a compute pipeline instead of a graphics pipeline
+	uint32_t pushBufferSize;   ///< Push constant size of compute pipelines
+} _VK2DPipelineJob;
+
+/// \brief Jobs shared between the threads creating pipelines
+typedef struct _VK2DPipelineJobList {
+	_VK2DPipelineJob *jobs; ///< Every job
+	uint32_t count;         ///< Number of jobs
+	SDL_AtomicInt next;     ///< Next job a thread should take
+} _VK2DPipelineJobList;
+
+/// \brief A dynamic uniform buffer set that points at one descriptor buffer page and lives as long as it does
+typedef struct _VK2DDescriptorBufferDynamicSet {
+	VkDescriptorSetLayout layout; ///< Layout the set was allocated with
+	uint32_t binding;             ///< Binding the page is written to
+	VkDeviceSize range;           ///< Size of the range starting at the dynamic offset
+	VkDescriptorSet set;          ///< The set itself
+} _VK2DDescriptorBufferDynamicSet;
+
 /// \brief To make descriptor buffers simpler internally
 typedef struct _VK2DDescriptorBufferInternal {
 	VK2DBuffer deviceBuffer; ///< Device-local (on vram) buffer that the shaders will access
 	VK2DBuffer stageBuffer;  ///< Host-local (on ram) buffer that data will be copied into
-	void *hostData;          ///< For when stageBuffer is mapped
+	void *hostData;          ///< Persistent mapping of stageBuffer, or deviceBuffer if there is no stage buffer
+	bool coherent;           ///< Whether or not the mapped memory is host coherent, if not writes are flushed at the end of the frame
 	VkDeviceSize size;       ///< Amount of data currently in this buffer
+	VkDeviceSize capacity;   ///< Size of this page, the descriptor buffer's page size unless this is an oversize page
+	uint32_t idleFrames;     ///< Number of frames in a row nothing was placed in this page
+	VkDescriptorPool dynamicPool; ///< Pool dynamicSets are allocated from, created the first time one is needed
+	_VK2DDescriptorBufferDynamicSet dynamicSets[VK2D_DESCRIPTOR_BUFFER_DYNAMIC_SETS]; ///< Long-lived sets pointing at this page
+	uint32_t dynamicSetCount; ///< Number of sets in dynamicSets
 } _VK2DDescriptorBufferInternal;
 
 /// \brief Automates memory management for uniform buffers and the lot
@@ -76,7 +209,8 @@ typedef struct _VK2DDescriptorBufferInternal {
 ///
 ///  1. Create the descriptor buffer
 ///  2. Call vk2dDescriptorBufferBeginFrame before beginning to draw
-///  3.
+///  3. Copy data in with vk2dDescriptorBufferCopyData, or open a region with vk2dDescriptorBufferBeginRegion
+///     and write straight into the mapped staging memory
 ///  4. Call vk2dDescriptorBufferEndFrame before submitting the queue
 ///
 /// It will put a event barrier into the startframe command buffer where drawing happens,
@@ -90,8 +224,28 @@ struct VK2DDescriptorBuffer_t {
 	VkDeviceSize pageSize;                  ///< Page size for this descriptor buffer
 	VkCommandBuffer copyCommandBuffer;      ///< Draw command buffer for this frame
 	VkBufferMemoryBarrier *memoryBarriers;  ///< List of barriers that matches the size of the buffer list size
+	int regionPage;                         ///< Page the currently open write-through region lives in, or -1 if none is open
+	VkDeviceSize regionOffset;              ///< Offset of the open region in its page
+	VkDeviceSize regionSize;                ///< Size reserved for the open region
+	VK2DDescriptorBufferMode mode;          ///< How the cursor moves on when the current page is full
+	int currentPage;                        ///< Page allocations are bumped from
+	int pagesInUse;                         ///< Pages 0 through pagesInUse - 1 have been used this frame
+	bool directWrite;                       ///< Pages are device-local and host-visible so the host writes them in place without a staging copy
+	_VK2DDescriptorBufferInternal *oversizePages; ///< Dedicated pages for allocations that don't fit in a standard page, one allocation each per frame
+	int oversizeCount;                      ///< Number of oversize pages
+	int oversizeListSize;                   ///< Actual number of elements in the oversize page list
+	uint32_t idleFrames;                    ///< Frames a page may go unused before it is freed
+	VK2DDescriptorBufferStats stats;        ///< Counters for the frame in progress
+	VK2DDescriptorBufferStats statsLast;    ///< Counters for the last frame this buffer finished
 };
 
+/// \brief A set in a descriptor controller's content cache
+typedef struct _VK2DDescConCacheEntry {
+	VkImageView view;    ///< Image view written to the set, or VK_NULL_HANDLE if the slot is empty
+	VkBuffer buffer;     ///< Buffer written to the set, or VK_NULL_HANDLE if there is none
+	VkDescriptorSet set; ///< The set itself
+} _VK2DDescConCacheEntry;
+
 /// \brief Abstraction for descriptor pools and sets so you can dynamically use them
 struct VK2DDescCon_t {
 	VkDescriptorPool *pools;      ///< List of pools
@@ -99,12 +253,23 @@ struct VK2DDescCon_t {
 	uint32_t buffer;              ///< Whether or not pools support uniform buffers
 	uint32_t sampler;             ///< Whether or not pools support texture samplers
 	uint32_t storageBuffer;       ///< Whether or not pools support storage buffers
+	VkDescriptorType bufferType;  ///< Type of the buffer binding, either a uniform buffer or a dynamic uniform buffer
 	VK2DLogicalDevice dev;        ///< Device pools are created with
 
 	// pools will always have poolListSize elements, but only elements up to poolsInUse will be
 	// valid pools (in an effort to avoid constantly reallocating memory)
 	uint32_t poolsInUse;   ///< Number of actively in use pools in pools
 	uint32_t poolListSize; ///< Total length of pools array
+
+	// Pools before currentPool are full until the next reset, so allocations only ever ask currentPool
+	uint32_t currentPool;  ///< Pool allocations are made from
+	uint32_t setsInPool;   ///< Sets allocated from currentPool since the last reset
+
+	bool cacheEnabled;              ///< Whether or not sampler sets are cached by content
+	_VK2DDescConCacheEntry *cache;  ///< Open addressed hash table of sampler sets
+	uint32_t cacheSize;             ///< Number of slots in cache, always a power of 2
+	uint32_t cacheCount;            ///< Number of slots in cache that are filled
+	VK2DDescConStats stats;         ///< Counters since creation
 };
 
 /// \brief A handy abstraction that groups up pipeline state and makes multiple shaders easier
@@ -115,7 +280,18 @@ struct VK2DPipeline_t {
 	VkRect2D rect;              ///< For setting up command buffers
 	VkClearValue clearValue[2]; ///< Clear values for the two attachments: colour and depth
 	int32_t id;                 ///< Unique id for this pipeline
-	VkPipeline pipes[VK2D_BLEND_MODE_MAX]; ///< Internal pipelines if `VK2D_GENERATE_BLEND_MODES` is enabled
+	VkPipeline pipes[VK2D_BLEND_MODE_MAX]; ///< Internal pipelines, one per blend mode created the first time it's asked for
+
+	// Kept around so the other blend modes can be created later
+	SDL_Mutex *mutex;                               ///< Guards creating blend modes from multiple threads
+	SDL_AtomicInt created[VK2D_BLEND_MODE_MAX];     ///< Whether or not each entry in pipes has been created yet
+	VkShaderModule vertShader;                      ///< Vertex shader module, VK_NULL_HANDLE for compute pipelines
+	VkShaderModule fragShader;                      ///< Fragment shader module, VK_NULL_HANDLE for compute pipelines
+	VkPipelineVertexInputStateCreateInfo vertexInfo; ///< Vertex input the pipeline was created with, its descriptions must outlive the pipeline
+	bool fill;                                      ///< Whether polygons are filled (triangle strips) or lines
+	bool polygonFill;                               ///< Rasterization fill mode, false only if fill is false and wireframes are supported
+	VK2DMSAA msaa;                                  ///< MSAA the pipeline was created for
+	VK2DPipelineType type;                          ///< Type of pipeline, decides the push constants and depth state
 };
 
 /// \brief Makes shapes easier to deal with
@@ -144,6 +320,7 @@ struct VK2DShader_t {
 	VK2DPipeline pipe;    ///< Pipeline associated with this shader
 	uint32_t uniformSize; ///< Uniform buffer size in bytes
 	VK2DLogicalDevice dev;///< Device this belongs to
+	bool instanced;       ///< Whether or not this shader is drawn through the instanced sprite batch
 };
 
 /// \brief Simple wrapper that groups image things together
@@ -195,6 +372,23 @@ struct VK2DShadowEnvironment_t {
     int verticesCount;                 ///< Number of vertices in the vertices list
 };
 
+/// \brief A sprite batch that persists on the GPU, only uploading the sprites that change
+struct VK2DSpriteBatch_t {
+    VK2DDrawCommand *commands;                             ///< Host copy of the draw commands, densely packed
+    VK2DSprite *slotToSprite;                              ///< Sprite handle occupying each slot
+    int32_t *spriteToSlot;                                 ///< Slot each sprite handle lives in, or -1 if the handle is free
+    VK2DSprite *freeSprites;                               ///< Stack of handles available for insertion
+    uint32_t freeCount;                                    ///< Number of handles in freeSprites
+    uint32_t count;                                        ///< Number of sprites in the batch
+    uint32_t capacity;                                     ///< Maximum number of sprites the batch may hold
+    uint32_t dirtyStart;                                   ///< First slot that needs uploading
+    uint32_t dirtyEnd;                                     ///< One past the last slot that needs uploading, the batch is clean if this equals dirtyStart
+    VK2DBuffer commandBuffer;                              ///< Device-local draw commands fed to the sprite batch compute shader
+    VK2DBuffer instanceBuffer;                             ///< Device-local compute output read by the instanced pipeline
+    VK2DBuffer stageBuffers[VK2D_MAX_FRAMES_IN_FLIGHT];    ///< Staging buffers for dirty ranges, one per frame in flight
+    void *stageData[VK2D_MAX_FRAMES_IN_FLIGHT];            ///< Persistently mapped staging memory
+};
+
 /// \brief Information per texture
 typedef struct VK2DTextureDescriptorInfo_t {
     bool active;
@@ -228,8 +422,11 @@ struct VK2DRenderer_t {
 	VK2DRendererLimits limits;            ///< For user safety
 
 	// Cameras/ubos
-	VkDescriptorSet uboDescriptorSets[VK2D_MAX_FRAMES_IN_FLIGHT]; ///< Descriptor sets holding a UBO per frame in flight
+	VkDescriptorSet uboDescriptorSets[VK2D_MAX_FRAMES_IN_FLIGHT]; ///< Descriptor sets the camera UBO is bound with per frame in flight, bound with uboOffset
+	VkDescriptorSet uboFallbackSets[VK2D_MAX_FRAMES_IN_FLIGHT];   ///< Sets rewritten for the camera UBO if its descriptor buffer page has no room for another dynamic set
+	uint32_t uboOffset;                                           ///< Dynamic offset of the camera UBO for the current frame
 	VK2DUniformBufferObject workingUBO;                           ///< This frame's ubo, basically just has VK2D_MAX_CAMERAS viewproj matricies
+	vec4 cameraViews[VK2D_MAX_CAMERAS];                           ///< World-space bounds (min x, min y, max x, max y) each camera saw when workingUBO was built, for culling
 
 	// KHR Surface
 	//SDL_Window *window;                         ///< Window this renderer belongs to
@@ -256,15 +453,22 @@ struct VK2DRenderer_t {
 	bool procedStartFrame;                 ///< End frame things are only done if this is true and start frame things are only done if this is false
 
 	// Pipelines
+	VkPipelineCache pipelineCache; ///< Cache every pipeline is created with, saved to VK2DStartupOptions.pipelineCachePath on quit
 	VK2DPipeline modelPipe;       ///< Pipeline for 3D models
 	VK2DPipeline wireframePipe;   ///< Pipeline for 3D wireframes
 	VK2DPipeline primFillPipe;    ///< Pipeline for rendering filled shapes
 	VK2DPipeline primLinePipe;    ///< Pipeline for rendering shape outlines
 	VK2DPipeline instancedPipe;   ///< Pipeline for instancing textures
+	VK2DPipeline shapeFillPipe;   ///< Pipeline for batching filled shapes
+	VK2DPipeline shapeLinePipe;   ///< Pipeline for batching shape outlines
 	VK2DPipeline shadowsPipe;     ///< Pipeline for hardware-accelerated shadows
 	VK2DPipeline spriteBatchPipe; ///< Compute pipeline for sprite batching
 	uint32_t shaderListSize;      ///< Size of the list of customShaders
 	VK2DShader *customShaders;    ///< Custom shaders the user creates
+	SDL_Thread *precompileThread; ///< Thread creating the blend modes nothing has used yet if VK2DStartupOptions.precompileBlendModes is enabled
+	SDL_AtomicInt precompileStop; ///< Tells the precompile thread to stop early
+	VK2DPipeline *precompileList; ///< Pipelines the precompile thread is working through
+	uint32_t precompileCount;     ///< Number of pipelines in precompileList
 
 	// Uniform things
 	VkDescriptorSetLayout dslSampler;         ///< Descriptor set layout for texture samplers
@@ -287,6 +491,7 @@ struct VK2DRenderer_t {
 	VkDescriptorSet samplerSet;               ///< Sampler for all textures
 	VkDescriptorSet modelSamplerSet;          ///< Sampler for all 3D models
 	VK2DDescriptorBuffer *descriptorBuffers;  ///< Descriptor buffer, one per frame in flight
+	VK2DDescriptorBufferStats descriptorBufferStats; ///< Descriptor buffer counters for the last finished frame
     VkDescriptorPool texturePool;             ///< Pool used for the dynamic texture array
     VK2DTextureDescriptorInfo *textureArray;  ///< Array of information per texture
 
@@ -295,11 +500,13 @@ struct VK2DRenderer_t {
 	uint32_t scImageIndex;                 ///< Swapchain image index to be rendered to this frame
 	VkSemaphore *imageAvailableSemaphores; ///< Semaphores to signal when the image is ready
 	VkSemaphore *renderFinishedSemaphores; ///< Semaphores to signal when rendering is done
+	VkSemaphore *uploadSemaphores;         ///< Semaphores the transfer queue signals when descriptor buffer uploads are done (only if limits.supportsTransferQueue)
 	VkFence *inFlightFences;               ///< Fences for each frame
 	VkFence *imagesInFlight;               ///< Individual images in flight
 	VkCommandBuffer *commandBuffer;        ///< Command buffers, recreated each frame
 	VkCommandBuffer *dbCommandBuffer;      ///< Command buffers for descriptor buffers
 	VkCommandBuffer *computeCommandBuffer; ///< Command buffers for compute passes
+	VkCommandBuffer *uploadCommandBuffer;  ///< Transfer queue command buffers for descriptor buffer copies (only if limits.supportsTransferQueue)
 
 	// Render targeting info
 	uint32_t targetSubPass;          ///< Current sub pass being rendered to
@@ -330,10 +537,42 @@ struct VK2DRenderer_t {
 	double frameTimeAverage; ///< Average amount of time frames are taking over a second (in ms)
 
 	// Sprite batching
-    VK2DDrawCommand *drawCommands;       ///< User-side draw commands
+    VK2DDrawCommand *drawCommands;       ///< Draw commands, points directly into the mapped descriptor buffer page (NULL if no batch region is open)
     int drawCommandCount;                ///< Number of draw commands
+    int drawCommandCapacity;             ///< Number of draw commands the open batch region can hold
+    VkBuffer drawCommandsBuffer;         ///< Device buffer the open batch region will be copied to
+    VkDeviceSize drawCommandsOffset;     ///< Offset of the open batch region in drawCommandsBuffer
     int32_t currentBatchPipelineID;      ///< Pipeline id for the current batch
+    VkDeviceSize drawInstanceSize;       ///< Size of one sprite instance in the format chosen at startup
     VK2DPipeline currentBatchPipeline;   ///< Pipeline for the current batch
+    uint8_t *batchShaderData;            ///< Per-instance uniform data for the current batch if it uses an instanced shader
+    VkDeviceSize batchShaderDataSize;    ///< Bytes of batchShaderData in use
+    VkDeviceSize batchShaderDataCapacity;///< Bytes allocated for batchShaderData
+
+    // Primitive batching
+    VK2DShapeInstance *shapeInstances;      ///< Shapes waiting to be drawn by the primitive batch
+    uint32_t shapeInstanceCount;            ///< Number of shapes in the batch
+    uint32_t shapeInstanceCapacity;         ///< Number of shapes shapeInstances has room for
+    VK2DShapeRun *shapeRuns;                ///< Runs of shapes in the batch that share a polygon and line width
+    uint32_t shapeRunCount;                 ///< Number of runs in the batch
+    uint32_t shapeRunCapacity;              ///< Number of runs shapeRuns has room for
+    uint8_t *geometryData;                  ///< Transformed vertices from vk2dRendererDrawGeometry waiting to be drawn
+    VkDeviceSize geometryDataSize;          ///< Bytes of geometryData in use
+    VkDeviceSize geometryDataCapacity;      ///< Bytes allocated for geometryData
+
+    // Deferred draw queue
+    bool deferredDraws;                     ///< Whether or not sprite and shader draws are queued and sorted instead of drawn immediately
+    bool drawQueueFlushing;                 ///< True while the draw queue is being replayed so its draws go straight through
+    int32_t drawLayer;                      ///< Layer queued draws are sorted by
+    VK2DQueuedDraw *drawQueue;              ///< Draws waiting to be sorted and flushed
+    VK2DQueuedDrawKey *drawQueueKeys;       ///< Sort keys for drawQueue
+    uint32_t drawQueueCount;                ///< Number of draws in the queue
+    uint32_t drawQueueSize;                 ///< Number of draws the queue has room for
+    uint8_t *drawQueueData;                 ///< Uniform data for queued shader draws
+    VkDeviceSize drawQueueDataSize;         ///< Bytes of drawQueueData in use
+    VkDeviceSize drawQueueDataCapacity;     ///< Bytes allocated for drawQueueData
+    VK2DDrawQueueStats drawQueueStats;      ///< Draw queue counters for the frame in progress
+    VK2DDrawQueueStats drawQueueStatsLast;  ///< Draw queue counters for the last finished frame
 };
 
 #ifdef __cplusplus
@@ -66,6 +66,15 @@ static bool _vk2dPhysicalDeviceSupportsQueueFamilies(VkInstance instance, VkPhys
                 }
             }
         }
+
+        // A family that can only transfer is usually backed by dedicated copy engines
+        out->QueueFamily.transferFamily = out->QueueFamily.graphicsFamily;
+        for (i = 0; i < queueFamilyCount; i++) {
+            if (queueList[i].queueCount > 0 && queueList[i].queueFlags & VK_QUEUE_TRANSFER_BIT && !(queueList[i].queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT))) {
+                out->QueueFamily.transferFamily = i;
+                break;
+            }
+        }
     } else {
 	    vk2dRaise(VK2D_STATUS_OUT_OF_RAM, "Failed to allocate queue family properties.");
 	}
@@ -19,7 +19,64 @@
 #include "VK2D/Renderer.h"
 #include "VK2D/Opaque.h"
 
-static int32_t gID = 0x10;
+// Pipelines may be created from several threads at once
+static SDL_AtomicInt gID = {0x10};
+
+// Creates the pipeline for a single blend mode from the state saved in the pipeline, pipe->mutex must be held
+static VkResult _vk2dPipelineBuild(VK2DPipeline pipe, VK2DBlendMode blendMode) {
+	VK2DRenderer gRenderer = vk2dRendererGetPointer();
+	const uint32_t shaderStageCount = 2;
+	VkPipelineShaderStageCreateInfo shaderStageCreateInfo[] = {
+			vk2dInitPipelineShaderStageCreateInfo(VK_SHADER_STAGE_VERTEX_BIT, pipe->vertShader),
+			vk2dInitPipelineShaderStageCreateInfo(VK_SHADER_STAGE_FRAGMENT_BIT, pipe->fragShader),
+	};
+
+	VkRect2D scissor = pipe->rect;
+	VkPipelineViewportStateCreateInfo pipelineViewportStateCreateInfo = vk2dInitPipelineViewportStateCreateInfo(VK_NULL_HANDLE, &scissor);
+	VkPipelineRasterizationStateCreateInfo pipelineRasterizationStateCreateInfo = vk2dInitPipelineRasterizationStateCreateInfo(pipe->polygonFill);
+	VkPipelineMultisampleStateCreateInfo pipelineMultisampleStateCreateInfo = vk2dInitPipelineMultisampleStateCreateInfo((VkSampleCountFlagBits)pipe->msaa);
+	VkPipelineDepthStencilStateCreateInfo pipelineDepthStencilStateCreateInfo = vk2dInitPipelineDepthStencilStateCreateInfo();
+	VkPipelineInputAssemblyStateCreateInfo pipelineInputAssemblyStateCreateInfo = vk2dInitPipelineInputAssemblyStateCreateInfo(pipe->fill);
+
+	const uint32_t stateCount = 3;
+	VkDynamicState states[] = {
+			VK_DYNAMIC_STATE_LINE_WIDTH,
+			VK_DYNAMIC_STATE_SCISSOR,
+			VK_DYNAMIC_STATE_VIEWPORT,
+	};
+	VkPipelineDynamicStateCreateInfo pipelineDynamicStateCreateInfo = vk2dInitPipelineDynamicStateCreateInfo(states, stateCount);
+
+	// 3D/shadow settings
+	if (pipe->type == VK2D_PIPELINE_TYPE_3D) {
+		pipelineRasterizationStateCreateInfo.cullMode = VK_CULL_MODE_BACK_BIT;
+		pipelineDepthStencilStateCreateInfo.depthCompareOp = VK_COMPARE_OP_LESS;
+		pipelineDepthStencilStateCreateInfo.depthTestEnable = VK_TRUE;
+		pipelineDepthStencilStateCreateInfo.depthWriteEnable = VK_TRUE;
+	} else if (pipe->type == VK2D_PIPELINE_TYPE_SHADOWS) {
+		pipelineInputAssemblyStateCreateInfo.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+	}
+
+	VkPipelineColorBlendStateCreateInfo pipelineColorBlendStateCreateInfo = vk2dInitPipelineColorBlendStateCreateInfo(&VK2D_BLEND_MODES[blendMode], 1);
+	VkGraphicsPipelineCreateInfo graphicsPipelineCreateInfo = vk2dInitGraphicsPipelineCreateInfo(
+			shaderStageCreateInfo,
+			shaderStageCount,
+			&pipe->vertexInfo,
+			&pipelineInputAssemblyStateCreateInfo,
+			&pipelineViewportStateCreateInfo,
+			&pipelineRasterizationStateCreateInfo,
+			&pipelineMultisampleStateCreateInfo,
+			&pipelineDepthStencilStateCreateInfo,
+			&pipelineColorBlendStateCreateInfo,
+			&pipelineDynamicStateCreateInfo,
+			pipe->layout,
+			pipe->renderPass);
+	VkResult result = vkCreateGraphicsPipelines(pipe->dev->dev, gRenderer->pipelineCache, 1, &graphicsPipelineCreateInfo, VK_NULL_HANDLE, &pipe->pipes[blendMode]);
+	if (result == VK_SUCCESS)
+		SDL_SetAtomicInt(&pipe->created[blendMode], 1);
+	else
+		pipe->pipes[blendMode] = VK_NULL_HANDLE;
+	return result;
+}
 
 VK2DPipeline vk2dPipelineCreate(VK2DLogicalDevice dev, VkRenderPass renderPass, uint32_t width, uint32_t height, unsigned char *vertBuffer, uint32_t vertSize, unsigned char *fragBuffer, uint32_t fragSize, VkDescriptorSetLayout *setLayouts, uint32_t layoutCount, VkPipelineVertexInputStateCreateInfo *vertexInfo, bool fill, VK2DMSAA msaa, VK2DPipelineType type) {
     if (vk2dStatusFatal())
@@ -27,15 +84,14 @@ VK2DPipeline vk2dPipelineCreate(VK2DLogicalDevice dev, VkRenderPass renderPass,
 
 	VK2DPipeline pipe = calloc(1, sizeof(struct VK2DPipeline_t));
 	VK2DRenderer gRenderer = vk2dRendererGetPointer();
-	uint32_t i;
 
 	if (pipe != NULL) {
-	    pipe->id = gID;
-	    gID += 0x10;
+	    pipe->id = SDL_AddAtomicInt(&gID, 0x10);
 		// Figure out if wireframe is allowed
-		bool polygonFill = fill;
-		if (!polygonFill && !gRenderer->limits.supportsWireframe)
-			polygonFill = true;
+		pipe->fill = fill;
+		pipe->polygonFill = fill;
+		if (!pipe->polygonFill && !gRenderer->limits.supportsWireframe)
+			pipe->polygonFill = true;
 
 		// Load pipeline base values
 		pipe->dev = dev;
@@ -50,44 +106,29 @@ VK2DPipeline vk2dPipelineCreate(VK2DLogicalDevice dev, VkRenderPass renderPass,
 		pipe->clearValue[1].color.int32[1] = 0;
 		pipe->clearValue[1].color.int32[2] = 0;
 		pipe->clearValue[1].color.int32[3] = 0;
+		pipe->vertexInfo = *vertexInfo;
+		pipe->msaa = msaa;
+		pipe->type = type;
+		pipe->mutex = SDL_CreateMutex();
+
+		if (pipe->mutex == NULL) {
+			vk2dRaise(VK2D_STATUS_SDL_ERROR, "Failed to create pipeline mutex, SDL error: %s", SDL_GetError());
+			free(pipe);
+			return NULL;
+		}
 
-		// Create the shader modules
+		// Create the shader modules, these live as long as the pipeline so blend modes can be created later
 		VkShaderModuleCreateInfo vertCreateInfo = vk2dInitShaderModuleCreateInfo((void*)vertBuffer, vertSize);
 		VkShaderModuleCreateInfo fragCreateInfo = vk2dInitShaderModuleCreateInfo((void*)fragBuffer, fragSize);
-		VkShaderModule vertShader, fragShader;
-		VkResult result = vkCreateShaderModule(dev->dev, &vertCreateInfo, VK_NULL_HANDLE, &vertShader);
-		VkResult result2 = vkCreateShaderModule(dev->dev, &fragCreateInfo, VK_NULL_HANDLE, &fragShader);
-		const uint32_t shaderStageCount = 2;
-		VkPipelineShaderStageCreateInfo shaderStageCreateInfo[] = {
-				vk2dInitPipelineShaderStageCreateInfo(VK_SHADER_STAGE_VERTEX_BIT, vertShader),
-				vk2dInitPipelineShaderStageCreateInfo(VK_SHADER_STAGE_FRAGMENT_BIT, fragShader),
-		};
+		VkResult result = vkCreateShaderModule(dev->dev, &vertCreateInfo, VK_NULL_HANDLE, &pipe->vertShader);
+		VkResult result2 = vkCreateShaderModule(dev->dev, &fragCreateInfo, VK_NULL_HANDLE, &pipe->fragShader);
 
         if (result != VK_SUCCESS || result2 != VK_SUCCESS) {
             vk2dRaise(VK2D_STATUS_VULKAN_ERROR, "Failed to create shader modules, Vulkan error %i/%i.", result, result2);
-            free(pipe);
-            pipe = NULL;
+            vk2dPipelineFree(pipe);
             return NULL;
         }
 
-		VkRect2D scissor = {0};
-		scissor.offset.x = 0;
-		scissor.offset.y = 0;
-		scissor.extent.width = width;
-		scissor.extent.height = height;
-		VkPipelineViewportStateCreateInfo pipelineViewportStateCreateInfo = vk2dInitPipelineViewportStateCreateInfo(VK_NULL_HANDLE, &scissor);
-		VkPipelineRasterizationStateCreateInfo pipelineRasterizationStateCreateInfo = vk2dInitPipelineRasterizationStateCreateInfo(polygonFill);
-
-		VkPipelineMultisampleStateCreateInfo pipelineMultisampleStateCreateInfo = vk2dInitPipelineMultisampleStateCreateInfo((VkSampleCountFlagBits)msaa);
-		VkPipelineDepthStencilStateCreateInfo pipelineDepthStencilStateCreateInfo = vk2dInitPipelineDepthStencilStateCreateInfo();
-
-		const uint32_t stateCount = 3;
-		VkDynamicState states[] = {
-				VK_DYNAMIC_STATE_LINE_WIDTH,
-				VK_DYNAMIC_STATE_SCISSOR,
-				VK_DYNAMIC_STATE_VIEWPORT,
-		};
-		VkPipelineDynamicStateCreateInfo pipelineDynamicStateCreateInfo = vk2dInitPipelineDynamicStateCreateInfo(states, stateCount);
 		VkPushConstantRange range = {0};
         if (type == VK2D_PIPELINE_TYPE_3D) {
             range.size = sizeof(VK2D3DPushBuffer);
@@ -108,51 +149,19 @@ VK2DPipeline vk2dPipelineCreate(VK2DLogicalDevice dev, VkRenderPass renderPass,
 		VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo;
 		pipelineLayoutCreateInfo = vk2dInitPipelineLayoutCreateInfo(setLayouts, layoutCount, 1, &range);
 		result = vkCreatePipelineLayout(dev->dev, &pipelineLayoutCreateInfo, VK_NULL_HANDLE, &pipe->layout);
-		VkPipelineInputAssemblyStateCreateInfo pipelineInputAssemblyStateCreateInfo = vk2dInitPipelineInputAssemblyStateCreateInfo(fill);
 
         if (result != VK_SUCCESS) {
             vk2dRaise(VK2D_STATUS_VULKAN_ERROR, "Failed to create pipeline layout, Vulkan error %i.", result);
-            free(pipe);
-            pipe = NULL;
-            vkDestroyShaderModule(dev->dev, vertShader, VK_NULL_HANDLE);
-            vkDestroyShaderModule(dev->dev, fragShader, VK_NULL_HANDLE);
+            vk2dPipelineFree(pipe);
             return NULL;
         }
 
-		// 3D/shadow settings
-		if (type == VK2D_PIPELINE_TYPE_3D) {
-			pipelineRasterizationStateCreateInfo.cullMode = VK_CULL_MODE_BACK_BIT;
-			pipelineDepthStencilStateCreateInfo.depthCompareOp = VK_COMPARE_OP_LESS;
-			pipelineDepthStencilStateCreateInfo.depthTestEnable = VK_TRUE;
-			pipelineDepthStencilStateCreateInfo.depthWriteEnable = VK_TRUE;
-		} else if (type == VK2D_PIPELINE_TYPE_SHADOWS) {
-            pipelineInputAssemblyStateCreateInfo.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
-        }
-
-		for (i = 0; i < VK2D_BLEND_MODE_MAX; i++) {
-			VkPipelineColorBlendStateCreateInfo pipelineColorBlendStateCreateInfo = vk2dInitPipelineColorBlendStateCreateInfo(&VK2D_BLEND_MODES[i], 1);
-			VkGraphicsPipelineCreateInfo graphicsPipelineCreateInfo = vk2dInitGraphicsPipelineCreateInfo(
-					shaderStageCreateInfo,
-					shaderStageCount,
-					vertexInfo,
-					&pipelineInputAssemblyStateCreateInfo,
-					&pipelineViewportStateCreateInfo,
-					&pipelineRasterizationStateCreateInfo,
-					&pipelineMultisampleStateCreateInfo,
-					&pipelineDepthStencilStateCreateInfo,
-					&pipelineColorBlendStateCreateInfo,
-					&pipelineDynamicStateCreateInfo,
-					pipe->layout,
-					renderPass);
-			result = vkCreateGraphicsPipelines(dev->dev, VK_NULL_HANDLE, 1, &graphicsPipelineCreateInfo, VK_NULL_HANDLE, &pipe->pipes[i]);
-			if (result != VK_SUCCESS) {
-			    vk2dRaise(VK2D_STATUS_VULKAN_ERROR, "Failed to create pipeline, Vulkan error %i.", result);
-			    break;
-			}
-		}
-
-		vkDestroyShaderModule(dev->dev, vertShader, VK_NULL_HANDLE);
-		vkDestroyShaderModule(dev->dev, fragShader, VK_NULL_HANDLE);
+		// Only the default blend mode is created up front, the rest are created when first drawn with
+		SDL_LockMutex(pipe->mutex);
+		result = _vk2dPipelineBuild(pipe, VK2D_BLEND_MODE_BLEND);
+		SDL_UnlockMutex(pipe->mutex);
+		if (result != VK_SUCCESS)
+			vk2dRaise(VK2D_STATUS_VULKAN_ERROR, "Failed to create pipeline, Vulkan error %i.", result);
 	} else {
 	    vk2dRaise(VK2D_STATUS_OUT_OF_RAM, "Failed to allocate pipeline struct.");
 	}
@@ -165,11 +174,11 @@ VK2DPipeline vk2dPipelineCreateCompute(VK2DLogicalDevice dev, uint32_t pushBuffe
         return NULL;
 
     VK2DPipeline pipe = calloc(1, sizeof(struct VK2DPipeline_t));
+    VK2DRenderer gRenderer = vk2dRendererGetPointer();
 
     if (pipe != NULL) {
         pipe->dev = dev;
-        pipe->id = gID;
-        gID += 0x10;
+        pipe->id = SDL_AddAtomicInt(&gID, 0x10);
         VkPushConstantRange range = {
                 .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
                 .offset = 0,
@@ -205,7 +214,8 @@ VK2DPipeline vk2dPipelineCreateCompute(VK2DLogicalDevice dev, uint32_t pushBuffe
                     .stage = shaderStageCreateInfo,
             };
 
-            res = vkCreateComputePipelines(dev->dev, VK_NULL_HANDLE, 1, &pipelineCreateInfo, VK_NULL_HANDLE, &pipe->pipes[0]);
+            res = vkCreateComputePipelines(dev->dev, gRenderer->pipelineCache, 1, &pipelineCreateInfo, VK_NULL_HANDLE, &pipe->pipes[0]);
+            SDL_SetAtomicInt(&pipe->created[0], 1);
 
             if (res != VK_SUCCESS) {
                 free(pipe);
@@ -237,6 +247,17 @@ VkPipeline vk2dPipelineGetCompute(VK2DPipeline pipe) {
 VkPipeline vk2dPipelineGetPipe(VK2DPipeline pipe, VK2DBlendMode blendMode) {
     if (vk2dStatusFatal())
         return NULL;
+	if (SDL_GetAtomicInt(&pipe->created[blendMode]))
+		return pipe->pipes[blendMode];
+
+	// First time this blend mode is used, the precompile thread may be creating it right now
+	SDL_LockMutex(pipe->mutex);
+	if (!SDL_GetAtomicInt(&pipe->created[blendMode])) {
+		VkResult result = _vk2dPipelineBuild(pipe, blendMode);
+		if (result != VK_SUCCESS)
+			vk2dRaise(VK2D_STATUS_VULKAN_ERROR, "Failed to create pipeline for blend mode %i, Vulkan error %i.", blendMode, result);
+	}
+	SDL_UnlockMutex(pipe->mutex);
 	return pipe->pipes[blendMode];
 }
 
@@ -253,6 +274,9 @@ void vk2dPipelineFree(VK2DPipeline pipe) {
 		for (i = 0; i < VK2D_BLEND_MODE_MAX; i++)
 		    if (pipe->pipes[i] != NULL)
 			    vkDestroyPipeline(pipe->dev->dev, pipe->pipes[i], VK_NULL_HANDLE);
+		vkDestroyShaderModule(pipe->dev->dev, pipe->vertShader, VK_NULL_HANDLE);
+		vkDestroyShaderModule(pipe->dev->dev, pipe->fragShader, VK_NULL_HANDLE);
+		SDL_DestroyMutex(pipe->mutex);
 		free(pipe);
 	}
 }
@@ -23,6 +23,9 @@ extern "C" {
 /// \param msaa What level of MSAA to use
 /// \return Returns the new pipeline or NULL if it failed
 ///
+/// Only the VK2D_BLEND_MODE_BLEND pipeline is created here, see vk2dPipelineGetPipe. The
+/// vertex input descriptions vertexInfo points to must stay valid for the life of the pipeline.
+///
 /// Several things are set to dynamic state and will be ignored, hence this asking for only 3
 /// create infos when in reality there are many more. For a complete list of dynamic state,
 ///
@@ -39,10 +42,14 @@ VK2DPipeline vk2dPipelineCreateCompute(VK2DLogicalDevice dev, uint32_t pushBuffe
 /// \brief Returns the internal compute pipeline for a given vk2d pipeline
 VkPipeline vk2dPipelineGetCompute(VK2DPipeline pipe);
 
-/// \brief Grabs a pipeline given a blend mode, returning the default one if blend mode generation is disabled
+/// \brief Grabs a pipeline given a blend mode, creating it first if this is the first time it was asked for
 /// \param pipe Pipeline to grab the proper blended pipeline from
 /// \param blendMode Blend mode you want to draw with
 /// \return Returns a pipeline with the desired blend mode
+///
+/// Only VK2D_BLEND_MODE_BLEND is created with the pipeline, the others are compiled the first
+/// time they're drawn with (or ahead of time by VK2DStartupOptions.precompileBlendModes). This
+/// is safe to call from multiple threads.
 VkPipeline vk2dPipelineGetPipe(VK2DPipeline pipe, VK2DBlendMode blendMode);
 
 /// \brief Gets a unique id for this specific pipeline and blend mode
@@ -32,11 +32,17 @@
 #include "VK2D/DescriptorControl.h"
 #include "VK2D/Opaque.h"
 #include "VK2D/Pipeline.h"
+#include "VK2D/SpriteBatch.h"
 
 /******************************* Forward declarations *******************************/
 
 bool _vk2dFileExists(const char *filename);
 unsigned char* _vk2dLoadFile(const char *filename, uint32_t *size);
+void _vk2dSpriteBatchSync(VK2DSpriteBatch batch, VkDescriptorBufferInfo *sboInfos);
+static void _vk2dRendererDrawInstances(VK2DPipeline pipe, const VkDescriptorBufferInfo *sboInfos, uint32_t instanceCount, VkBuffer indirectBuffer, VkDeviceSize indirectOffset, uint32_t chunkCount);
+static void _vk2dRendererAddShape(VK2DPolygon polygon, bool filled, float lineWidth, float x, float y, float xscale, float yscale, float rot, float originX, float originY);
+static void _vk2dRendererFlushShapeBatch();
+static VkCommandBuffer _vk2dRendererGetUploadCommandBuffer();
 
 /******************************* Globals *******************************/
 
@@ -52,12 +58,14 @@ static VK2DStartupOptions DEFAULT_STARTUP_OPTIONS = {
     .quitOnError = true,
     .errorFile = "vk2derror.txt",
     .vramPageSize = 256 * 1000,
-    .maxTextures = 10000
+    .maxTextures = 10000,
+    .descriptorBufferIdleFrames = 120
 };
 
 /******************************* User-visible functions *******************************/
 
 VK2DResult vk2dRendererInit(void *window, VK2DRendererConfig config, VK2DStartupOptions *options) {
+	const uint64_t startTime = SDL_GetPerformanceCounter();
 	gRenderer = calloc(1, sizeof(struct VK2DRenderer_t));
 	VK2DResult errorCode = VK2D_SUCCESS;
 	uint32_t i, sdlExtensionsCount;
@@ -73,6 +81,8 @@ VK2DResult vk2dRendererInit(void *window, VK2DRendererConfig config, VK2DStartup
             userOptions.vramPageSize = DEFAULT_STARTUP_OPTIONS.vramPageSize;
         if (userOptions.maxTextures == 0)
             userOptions.maxTextures = DEFAULT_STARTUP_OPTIONS.maxTextures;
+        if (userOptions.descriptorBufferIdleFrames == 0)
+            userOptions.descriptorBufferIdleFrames = DEFAULT_STARTUP_OPTIONS.descriptorBufferIdleFrames;
         if (userOptions.errorFile == NULL)
             userOptions.errorFile = DEFAULT_STARTUP_OPTIONS.errorFile;
     }
@@ -239,6 +249,9 @@ VK2DResult vk2dRendererInit(void *window, VK2DRendererConfig config, VK2DStartup
         // Create budget list
         gRenderer->vmaBudgets = malloc(gRenderer->pd->mem.memoryHeapCount * sizeof(VmaBudget));
 
+        // Staging rings need VMA
+        vk2dLogicalDeviceCreateStaging(gRenderer->ld);
+
 		// Initialize subsystems
 		_vk2dRendererCreateDebug();
 		_vk2dRendererCreateWindowSurface();
@@ -247,6 +260,7 @@ VK2DResult vk2dRendererInit(void *window, VK2DRendererConfig config, VK2DStartup
 		_vk2dRendererCreateDepthBuffer();
 		_vk2dRendererCreateRenderPass();
 		_vk2dRendererCreateDescriptorSetLayouts();
+		_vk2dRendererCreatePipelineCache();
 		_vk2dRendererCreatePipelines();
 		_vk2dRendererCreateFrameBuffer();
 		_vk2dRendererCreateDescriptorPool(false);
@@ -273,6 +287,8 @@ VK2DResult vk2dRendererInit(void *window, VK2DRendererConfig config, VK2DStartup
 
 		// Initialize the random seed
 		SDL_SetAtomicInt(&gRNG, time(0));
+
+		vk2dLog("Renderer initialized in %.2fms.", ((double)(SDL_GetPerformanceCounter() - startTime) / (double)SDL_GetPerformanceFrequency()) * 1000);
 	} else {
 		errorCode = VK2D_ERROR;
 		vk2dRaise(VK2D_STATUS_OUT_OF_RAM, "Failed to allocate renderer struct.");
@@ -297,6 +313,7 @@ void vk2dRendererQuit() {
 		_vk2dRendererDestroyUniformBuffers();
 		_vk2dRendererDestroyFrameBuffer();
 		_vk2dRendererDestroyPipelines(false);
+		_vk2dRendererDestroyPipelineCache();
 		_vk2dRendererDestroyDescriptorSetLayout();
 		_vk2dRendererDestroyRenderPass();
 		_vk2dRendererDestroyDepthBuffer();
@@ -304,6 +321,8 @@ void vk2dRendererQuit() {
 		_vk2dRendererDestroySwapchain();
 		_vk2dRendererDestroyWindowSurface();
 		_vk2dRendererDestroyDebug();
+		if (gRenderer->ld != NULL)
+			vk2dLogicalDeviceFreeStaging(gRenderer->ld);
 		vmaDestroyAllocator(gRenderer->vma);
 
 		// Destroy core bits
@@ -413,7 +432,6 @@ void vk2dRendererStartFrame(const vec4 clearColour) {
 			gRenderer->targetRenderPass = gRenderer->renderPass;
 			gRenderer->targetSubPass = 0;
 			gRenderer->targetImage = gRenderer->swapchainImages[gRenderer->scImageIndex];
-			gRenderer->targetUBOSet = gRenderer->uboDescriptorSets[gRenderer->currentFrame]; // TODO: Should prob be reworked
 			gRenderer->target = VK2D_TARGET_SCREEN;
 			_vk2dRendererResetBatch();
 
@@ -435,21 +453,35 @@ void vk2dRendererStartFrame(const vec4 clearColour) {
                 vk2dRaise(VK2D_STATUS_VULKAN_ERROR, "Failed to begin command buffer at start of frame, Vulkan error %i/%i/%i.", result, result2, result3);
                 return;
             }
+            if (gRenderer->limits.supportsTransferQueue) {
+                result = vkResetCommandBuffer(gRenderer->uploadCommandBuffer[gRenderer->scImageIndex], 0);
+                if (result == VK_SUCCESS)
+                    result = vkBeginCommandBuffer(gRenderer->uploadCommandBuffer[gRenderer->scImageIndex], &beginInfo);
+                if (result != VK_SUCCESS) {
+                    vk2dRaise(VK2D_STATUS_VULKAN_ERROR, "Failed to begin upload command buffer at start of frame, Vulkan error %i.", result);
+                    return;
+                }
+            }
 
 			// Begin descriptor buffer and sprite batching
-            vk2dDescriptorBufferBeginFrame(gRenderer->descriptorBuffers[gRenderer->currentFrame], gRenderer->dbCommandBuffer[gRenderer->scImageIndex]);
+            vk2dDescriptorBufferBeginFrame(gRenderer->descriptorBuffers[gRenderer->currentFrame], _vk2dRendererGetUploadCommandBuffer());
             //gRenderer->spriteBatchCount = 0;
 
 			// Flush the current ubo into its buffer for the frame
             for (int i = 0; i < VK2D_MAX_CAMERAS; i++)
-                if (gRenderer->cameras[i].state == VK2D_CAMERA_STATE_NORMAL)
+                if (gRenderer->cameras[i].state == VK2D_CAMERA_STATE_NORMAL) {
                     _vk2dCameraUpdateUBO(&gRenderer->workingUBO, &gRenderer->cameras[i].spec, i);
+                    _vk2dCameraGetView(gRenderer->cameraViews[i], &gRenderer->cameras[i].spec);
+                }
 			_vk2dRendererFlushUBOBuffers();
+			gRenderer->targetUBOSet = gRenderer->uboDescriptorSets[gRenderer->currentFrame]; // TODO: Should prob be reworked
 
-			// Desc cons
-			vk2dDescConReset(gRenderer->descConShaders[gRenderer->currentFrame]);
-            vk2dDescConReset(gRenderer->descConCompute[gRenderer->currentFrame]);
-            vk2dDescConReset(gRenderer->descConSBO[gRenderer->currentFrame]);
+			// Desc cons, per-draw sets are pushed instead when possible so there is nothing to reset
+			if (!gRenderer->limits.supportsPushDescriptors) {
+			    vk2dDescConReset(gRenderer->descConShaders[gRenderer->currentFrame]);
+                vk2dDescConReset(gRenderer->descConCompute[gRenderer->currentFrame]);
+                vk2dDescConReset(gRenderer->descConSBO[gRenderer->currentFrame]);
+			}
 
             // Setup render pass
 			VkRect2D rect = {0};
@@ -478,12 +510,21 @@ void vk2dRendererStartFrame(const vec4 clearColour) {
 	}
 }
 
+// Command buffer descriptor buffer copies are recorded to, on the transfer queue if it's in use
+static VkCommandBuffer _vk2dRendererGetUploadCommandBuffer() {
+    if (gRenderer->limits.supportsTransferQueue)
+        return gRenderer->uploadCommandBuffer[gRenderer->scImageIndex];
+    return gRenderer->dbCommandBuffer[gRenderer->scImageIndex];
+}
+
 VK2DResult vk2dRendererEndFrame() {
 	VK2DResult res = VK2D_SUCCESS;
 	if (vk2dRendererGetPointer() != NULL && !vk2dStatusFatal()) {
 		if (gRenderer->procedStartFrame) {
 		    // Flush whatevers on batch
 		    vk2dRendererFlushSpriteBatch();
+		    gRenderer->drawQueueStatsLast = gRenderer->drawQueueStats;
+		    memset(&gRenderer->drawQueueStats, 0, sizeof(struct VK2DDrawQueueStats));
 
 			gRenderer->procedStartFrame = false;
 
@@ -495,11 +536,15 @@ VK2DResult vk2dRendererEndFrame() {
 			// Dispatch compute and end the descriptor buffer frame
             vkCmdEndRenderPass(gRenderer->commandBuffer[gRenderer->scImageIndex]);
 			//_vk2dRendererDispatchCompute();
-            vk2dDescriptorBufferEndFrame(gRenderer->descriptorBuffers[gRenderer->currentFrame], gRenderer->dbCommandBuffer[gRenderer->scImageIndex]);
+            vk2dDescriptorBufferEndFrame(gRenderer->descriptorBuffers[gRenderer->currentFrame], _vk2dRendererGetUploadCommandBuffer());
+            gRenderer->descriptorBufferStats = vk2dDescriptorBufferGetStats(gRenderer->descriptorBuffers[gRenderer->currentFrame]);
 
-            // Record necessary pipeline barriers to the copy and compute buffers
-            vk2dDescriptorBufferRecordCopyPipelineBarrier(gRenderer->descriptorBuffers[gRenderer->currentFrame], gRenderer->dbCommandBuffer[gRenderer->scImageIndex]);
-            vk2dDescriptorBufferRecordComputePipelineBarrier(gRenderer->descriptorBuffers[gRenderer->currentFrame], gRenderer->computeCommandBuffer[gRenderer->scImageIndex]);
+            // Record necessary pipeline barriers to the copy and compute buffers, the upload semaphore
+            // takes the place of the copy barrier when the copies run on the transfer queue
+            if (!gRenderer->limits.supportsTransferQueue)
+                vk2dDescriptorBufferRecordCopyPipelineBarrier(gRenderer->descriptorBuffers[gRenderer->currentFrame], gRenderer->dbCommandBuffer[gRenderer->scImageIndex]);
+            if (!gRenderer->options.computeFreeSprites)
+                vk2dDescriptorBufferRecordComputePipelineBarrier(gRenderer->descriptorBuffers[gRenderer->currentFrame], gRenderer->computeCommandBuffer[gRenderer->scImageIndex]);
 
             // PRESENT
             VkResult result = vkEndCommandBuffer(gRenderer->commandBuffer[gRenderer->scImageIndex]);
@@ -509,17 +554,49 @@ VK2DResult vk2dRendererEndFrame() {
                 vk2dRaise(VK2D_STATUS_VULKAN_ERROR, "Failed to begin command buffer at start of frame, Vulkan error %i/%i/%i.", result, result2, result3);
                 return VK2D_ERROR;
             }
+            if (gRenderer->limits.supportsTransferQueue) {
+                result = vkEndCommandBuffer(gRenderer->uploadCommandBuffer[gRenderer->scImageIndex]);
+                if (result != VK_SUCCESS) {
+                    vk2dRaise(VK2D_STATUS_VULKAN_ERROR, "Failed to end upload command buffer, Vulkan error %i.", result);
+                    return VK2D_ERROR;
+                }
+            }
+
+			// Upload descriptor buffers on the transfer queue so the copies can overlap the previous frame
+			const bool transferUploads = gRenderer->limits.supportsTransferQueue;
+			if (transferUploads) {
+				VkSubmitInfo uploadSubmitInfo = vk2dInitSubmitInfo(
+						&gRenderer->uploadCommandBuffer[gRenderer->scImageIndex],
+						1,
+						&gRenderer->uploadSemaphores[gRenderer->currentFrame],
+						1,
+						VK_NULL_HANDLE,
+						0,
+						VK_NULL_HANDLE);
+				result = vkQueueSubmit(gRenderer->ld->transferQueue, 1, &uploadSubmitInfo, VK_NULL_HANDLE);
+				if (result < 0) {
+					if (result == VK_ERROR_DEVICE_LOST)
+						vk2dRaise(VK2D_STATUS_DEVICE_LOST, "Vulkan device lost.");
+					else
+						vk2dRaise(VK2D_STATUS_VULKAN_ERROR, "Failed to submit transfer queue, Vulkan error %i.", result);
+					return VK2D_ERROR;
+				}
+			}
 
-			// Wait for image before doing things
-			VkPipelineStageFlags waitStage[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
+			// Wait for image before doing things, and for the uploads before anything reads the descriptor buffers
+			VkPipelineStageFlags waitStage[] = {
+					VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+					VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT
+			};
+			VkSemaphore waitSemaphores[] = {gRenderer->imageAvailableSemaphores[gRenderer->currentFrame], transferUploads ? gRenderer->uploadSemaphores[gRenderer->currentFrame] : VK_NULL_HANDLE};
 			VkCommandBuffer bufs[] = {gRenderer->dbCommandBuffer[gRenderer->scImageIndex], gRenderer->computeCommandBuffer[gRenderer->scImageIndex], gRenderer->commandBuffer[gRenderer->scImageIndex]};
 			VkSubmitInfo submitInfo = vk2dInitSubmitInfo(
 					bufs,
 					3,
 					&gRenderer->renderFinishedSemaphores[gRenderer->currentFrame],
 					1,
-					&gRenderer->imageAvailableSemaphores[gRenderer->currentFrame],
-					1,
+					waitSemaphores,
+					transferUploads ? 2 : 1,
 					waitStage);
 
 			// Submit queue
@@ -660,9 +737,14 @@ void vk2dRendererGetColourMod(vec4 dst) {
 }
 
 void vk2dRendererSetBlendMode(VK2DBlendMode blendMode) {
-    vk2dRendererFlushSpriteBatch();
-	if (vk2dRendererGetPointer() != NULL)
+	if (vk2dRendererGetPointer() != NULL) {
+		// Queued draws remember their own blend mode, but shapes are drawn with whatever is set at flush
+		if (!gRenderer->deferredDraws)
+			vk2dRendererFlushSpriteBatch();
+		else if (gRenderer->shapeInstanceCount > 0)
+			_vk2dRendererFlushShapeBatch();
 		gRenderer->blendMode = blendMode;
+	}
 }
 
 VK2DBlendMode vk2dRendererGetBlendMode() {
@@ -671,6 +753,44 @@ VK2DBlendMode vk2dRendererGetBlendMode() {
 	return VK2D_BLEND_MODE_NONE;
 }
 
+void vk2dRendererSetDeferredDraws(bool deferred) {
+	if (vk2dRendererGetPointer() != NULL) {
+		vk2dRendererFlushSpriteBatch();
+		gRenderer->deferredDraws = deferred;
+	}
+}
+
+bool vk2dRendererGetDeferredDraws() {
+	if (vk2dRendererGetPointer() != NULL)
+		return gRenderer->deferredDraws;
+	return false;
+}
+
+void vk2dRendererSetDrawLayer(int32_t layer) {
+	if (vk2dRendererGetPointer() != NULL)
+		gRenderer->drawLayer = layer;
+}
+
+int32_t vk2dRendererGetDrawLayer() {
+	if (vk2dRendererGetPointer() != NULL)
+		return gRenderer->drawLayer;
+	return 0;
+}
+
+VK2DDrawQueueStats vk2dRendererGetDrawQueueStats() {
+	if (vk2dRendererGetPointer() != NULL)
+		return gRenderer->drawQueueStatsLast;
+	VK2DDrawQueueStats stats = {0};
+	return stats;
+}
+
+VK2DDescriptorBufferStats vk2dRendererGetDescriptorBufferStats() {
+	if (vk2dRendererGetPointer() != NULL)
+		return gRenderer->descriptorBufferStats;
+	VK2DDescriptorBufferStats stats = {0};
+	return stats;
+}
+
 void vk2dRendererSetCamera(VK2DCameraSpec camera) {
 	if (vk2dRendererGetPointer() != NULL) {
 		gRenderer->cameras[VK2D_DEFAULT_CAMERA].spec = camera;
@@ -752,71 +872,221 @@ VK2DRendererLimits vk2dRendererGetLimits() {
 
 void vk2dRendererDrawRectangle(float x, float y, float w, float h, float r, float ox, float oy) {
 	if (vk2dRendererGetPointer() != NULL && !vk2dStatusFatal()) {
-        vk2dRendererFlushSpriteBatch();
 		vk2dRendererDrawPolygon(gRenderer->unitSquare, x, y, true, 1, w, h, r, ox / (w / 3), oy / (h / 3));
 	}
 }
 
 void vk2dRendererDrawRectangleOutline(float x, float y, float w, float h, float r, float ox, float oy, float lineWidth) {
 	if (vk2dRendererGetPointer() != NULL && !vk2dStatusFatal()) {
-        vk2dRendererFlushSpriteBatch();
 		vk2dRendererDrawPolygon(gRenderer->unitSquareOutline, x, y, false, lineWidth, w, h, r, ox / (w / 3), oy / (h / 3));
 	}
 }
 
 void vk2dRendererDrawCircle(float x, float y, float r) {
 	if (vk2dRendererGetPointer() != NULL && !vk2dStatusFatal()) {
-        vk2dRendererFlushSpriteBatch();
 		vk2dRendererDrawPolygon(gRenderer->unitCircle, x, y, true, 1, r * 2, r * 2, 0, 0, 0);
 	}
 }
 
 void vk2dRendererDrawCircleOutline(float x, float y, float r, float lineWidth) {
 	if (vk2dRendererGetPointer() != NULL && !vk2dStatusFatal()) {
-        vk2dRendererFlushSpriteBatch();
 		vk2dRendererDrawPolygon(gRenderer->unitCircleOutline, x, y, false, lineWidth, r * 2, r * 2, 0, 0, 0);
 	}
 }
 
 void vk2dRendererDrawLine(float x1, float y1, float x2, float y2) {
 	if (vk2dRendererGetPointer() != NULL && !vk2dStatusFatal()) {
-        vk2dRendererFlushSpriteBatch();
 		float x = sqrtf(powf(y2 - y1, 2) + powf(x2 - x1, 2));
 		float r = atan2f(y2 - y1, x2 - x1);
 		vk2dRendererDrawPolygon(gRenderer->unitLine, x1, y1, false, 1, x, 1, r, 0, 0);
 	}
 }
 
+// Fills out a draw command with the current colour mod
+static void _vk2dRendererWriteDrawCommand(VK2DDrawCommand *command, uint32_t textureIndex, float x, float y, float xscale, float yscale, float rot, float originX, float originY, float xInTex, float yInTex, float texWidth, float texHeight) {
+    command->textureIndex = textureIndex;
+    command->texturePos[0] = xInTex;
+    command->texturePos[1] = yInTex;
+    command->texturePos[2] = texWidth;
+    command->texturePos[3] = texHeight;
+    command->rotation = rot;
+    command->colour[0] = gRenderer->colourBlend[0];
+    command->colour[1] = gRenderer->colourBlend[1];
+    command->colour[2] = gRenderer->colourBlend[2];
+    command->colour[3] = gRenderer->colourBlend[3];
+    command->origin[0] = originX;
+    command->origin[1] = originY;
+    command->scale[0] = xscale;
+    command->scale[1] = yscale;
+    command->pos[0] = x;
+    command->pos[1] = y;
+}
+
+// Adds a draw with the given pipeline to the deferred draw queue, returning NULL if the queue couldn't grow
+static VK2DQueuedDraw *_vk2dRendererQueueDraw(VK2DPipeline pipe) {
+    if (gRenderer->drawQueueCount == gRenderer->drawQueueSize) {
+        const uint32_t newSize = gRenderer->drawQueueSize * 2;
+        VK2DQueuedDraw *newQueue = realloc(gRenderer->drawQueue, sizeof(struct VK2DQueuedDraw) * newSize);
+        if (newQueue != NULL)
+            gRenderer->drawQueue = newQueue;
+        VK2DQueuedDrawKey *newKeys = realloc(gRenderer->drawQueueKeys, sizeof(struct VK2DQueuedDrawKey) * newSize);
+        if (newKeys != NULL)
+            gRenderer->drawQueueKeys = newKeys;
+        if (newQueue == NULL || newKeys == NULL) {
+            vk2dRaise(VK2D_STATUS_OUT_OF_RAM, "Failed to extend draw queue to %i draws.", newSize);
+            return NULL;
+        }
+        gRenderer->drawQueueSize = newSize;
+    }
+
+    // Flipping the sign bit makes negative layers sort before positive ones
+    const uint32_t index = gRenderer->drawQueueCount++;
+    const uint64_t layer = (uint32_t)gRenderer->drawLayer ^ 0x80000000u;
+    gRenderer->drawQueueKeys[index].key = (layer << 32) | (uint32_t)vk2dPipelineGetID(pipe, gRenderer->blendMode);
+    gRenderer->drawQueueKeys[index].index = index;
+    VK2DQueuedDraw *draw = &gRenderer->drawQueue[index];
+    draw->shader = NULL;
+    draw->tex = NULL;
+    draw->blendMode = gRenderer->blendMode;
+    draw->dataOffset = 0;
+    return draw;
+}
+
+// Draws a shader right away, or adds it to the sprite batch if it's instanced
+static void _vk2dRendererDrawShaderNow(VK2DShader shader, void *data, VK2DTexture tex, float x, float y, float xscale, float yscale, float rot, float originX, float originY, float xInTex, float yInTex, float texWidth, float texHeight) {
+    if (shader->instanced) {
+        // The per-instance data has to fit in one descriptor buffer page at flush
+        if (gRenderer->batchShaderDataSize + shader->uniformSize > gRenderer->options.vramPageSize)
+            vk2dRendererFlushSpriteBatch();
+        _vk2dRendererFlushBatchIfNeeded(shader->pipe);
+        VK2DDrawCommand *command = _vk2dRendererAddDrawCommand();
+        if (command == NULL)
+            return;
+        _vk2dRendererWriteDrawCommand(command, vk2dTextureGetID(tex), x, y, xscale, yscale, rot, originX, originY, xInTex, yInTex, texWidth, texHeight);
+        if (shader->uniformSize != 0)
+            _vk2dRendererAppendData(&gRenderer->batchShaderData, &gRenderer->batchShaderDataSize, &gRenderer->batchShaderDataCapacity, data, shader->uniformSize);
+        return;
+    }
+
+    _vk2dRendererFlushBatchIfNeeded(shader->pipe);
+    VkDescriptorSet sets[4];
+    sets[1] = gRenderer->samplerSet;
+    sets[2] = gRenderer->texArrayDescriptorSet;
+
+    // Create the data uniform, it is bound at set 3 up front since binding the lower sets with the same layout
+    // later on leaves it alone
+    if (shader->uniformSize != 0) {
+        VkCommandBuffer buf = gRenderer->commandBuffer[gRenderer->scImageIndex];
+        VK2DDescriptorBuffer db = gRenderer->descriptorBuffers[gRenderer->currentFrame];
+        VkBuffer buffer;
+        VkDeviceSize offset;
+        vk2dDescriptorBufferCopyData(db, data, shader->uniformSize, &buffer, &offset);
+        if (gRenderer->limits.supportsPushDescriptors) {
+            VkDescriptorBufferInfo bufferInfo = {buffer,offset,shader->uniformSize};
+            VkWriteDescriptorSet write = {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
+            write.pBufferInfo = &bufferInfo;
+            write.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+            write.dstBinding = 3;
+            write.descriptorCount = 1;
+            _vk2dRendererBindTransientSet(buf, VK_PIPELINE_BIND_POINT_GRAPHICS, shader->pipe->layout, 3, VK_NULL_HANDLE, &write);
+        } else {
+            // Shaders with the same uniform size share one set per descriptor buffer page
+            VkDescriptorSet set = vk2dDescriptorBufferGetDynamicSet(db, buffer, gRenderer->dslBufferUser, 3, shader->uniformSize);
+            if (set == VK_NULL_HANDLE) {
+                set = vk2dDescConGetSet(gRenderer->descConShaders[gRenderer->currentFrame]);
+                VkDescriptorBufferInfo bufferInfo = {buffer,0,shader->uniformSize};
+                VkWriteDescriptorSet write = vk2dInitWriteDescriptorSet(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 3, set, &bufferInfo, 1, VK_NULL_HANDLE);
+                vkUpdateDescriptorSets(gRenderer->ld->dev, 1, &write, 0, VK_NULL_HANDLE);
+            }
+            const uint32_t dynamicOffset = offset;
+            vkCmdBindDescriptorSets(buf, VK_PIPELINE_BIND_POINT_GRAPHICS, shader->pipe->layout, 3, 1, &set, 1, &dynamicOffset);
+        }
+    }
+
+    _vk2dRendererDrawShader(sets, 3, tex, shader->pipe, x, y, xscale, yscale, rot, originX, originY, 1,
+                      xInTex,
+                      yInTex, texWidth, texHeight);
+}
+
+static int _vk2dRendererCompareQueuedDraws(const void *a, const void *b) {
+    const VK2DQueuedDrawKey *x = a;
+    const VK2DQueuedDrawKey *y = b;
+    if (x->key != y->key)
+        return x->key < y->key ? -1 : 1;
+    return x->index < y->index ? -1 : (x->index > y->index);
+}
+
+// Sorts the deferred draw queue by layer, pipeline, and blend mode and draws it in as few batches as possible
+static void _vk2dRendererFlushDrawQueue() {
+    gRenderer->drawQueueFlushing = true;
+    const VK2DBlendMode blendMode = gRenderer->blendMode;
+    vec4 colour;
+    memcpy(colour, gRenderer->colourBlend, sizeof(vec4));
+
+    // Every time the pipeline changes between draws is a batch
+    const uint32_t count = gRenderer->drawQueueCount;
+    uint32_t unsortedBatches = 0;
+    uint32_t sortedBatches = 0;
+    for (uint32_t i = 0; i < count; i++)
+        if (i == 0 || (uint32_t)gRenderer->drawQueueKeys[i].key != (uint32_t)gRenderer->drawQueueKeys[i - 1].key)
+            unsortedBatches++;
+    qsort(gRenderer->drawQueueKeys, count, sizeof(struct VK2DQueuedDrawKey), _vk2dRendererCompareQueuedDraws);
+
+    for (uint32_t i = 0; i < count && !vk2dStatusFatal(); i++) {
+        if (i == 0 || (uint32_t)gRenderer->drawQueueKeys[i].key != (uint32_t)gRenderer->drawQueueKeys[i - 1].key)
+            sortedBatches++;
+        VK2DQueuedDraw *draw = &gRenderer->drawQueue[gRenderer->drawQueueKeys[i].index];
+
+        // The batch is drawn with whatever blend mode is set when it's flushed
+        if (draw->blendMode != gRenderer->blendMode) {
+            vk2dRendererFlushSpriteBatch();
+            gRenderer->blendMode = draw->blendMode;
+        }
+
+        if (draw->shader == NULL) {
+            _vk2dRendererFlushBatchIfNeeded(gRenderer->instancedPipe);
+            VK2DDrawCommand *command = _vk2dRendererAddDrawCommand();
+            if (command != NULL)
+                *command = draw->command;
+        } else {
+            memcpy(gRenderer->colourBlend, draw->command.colour, sizeof(vec4));
+            _vk2dRendererDrawShaderNow(
+                    draw->shader, gRenderer->drawQueueData + draw->dataOffset, draw->tex,
+                    draw->command.pos[0], draw->command.pos[1], draw->command.scale[0], draw->command.scale[1],
+                    draw->command.rotation, draw->command.origin[0], draw->command.origin[1],
+                    draw->command.texturePos[0], draw->command.texturePos[1], draw->command.texturePos[2], draw->command.texturePos[3]
+            );
+        }
+    }
+    vk2dRendererFlushSpriteBatch();
+
+    gRenderer->blendMode = blendMode;
+    memcpy(gRenderer->colourBlend, colour, sizeof(vec4));
+    gRenderer->drawQueueStats.queuedDraws += count;
+    gRenderer->drawQueueStats.batches += sortedBatches;
+    gRenderer->drawQueueStats.flushesSaved += unsortedBatches - sortedBatches;
+    gRenderer->drawQueueCount = 0;
+    gRenderer->drawQueueDataSize = 0;
+    gRenderer->drawQueueFlushing = false;
+}
+
 void vk2dRendererDrawShader(VK2DShader shader, void *data, VK2DTexture tex, float x, float y, float xscale, float yscale, float rot, float originX, float originY, float xInTex, float yInTex, float texWidth, float texHeight) {
     if (vk2dRendererGetPointer() != NULL && !vk2dStatusFatal()) {
         if (shader != NULL) {
-            _vk2dRendererFlushBatchIfNeeded(shader->pipe);
-
-            VkDescriptorSet sets[4];
-            sets[1] = gRenderer->samplerSet;
-            sets[2] = gRenderer->texArrayDescriptorSet;
-
-            // Create the data uniform
-            uint32_t setCount = 3;
-            if (shader->uniformSize != 0) {
-                sets[3] = vk2dDescConGetSet(gRenderer->descConShaders[gRenderer->currentFrame]);
-                VkBuffer buffer;
-                VkDeviceSize offset;
-                vk2dDescriptorBufferCopyData(gRenderer->descriptorBuffers[gRenderer->currentFrame], data, shader->uniformSize, &buffer, &offset);
-                VkDescriptorBufferInfo bufferInfo = {buffer,offset,shader->uniformSize};
-                VkWriteDescriptorSet write = {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
-                write.pBufferInfo = &bufferInfo;
-                write.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-                write.dstBinding = 3;
-                write.dstSet = sets[3];
-                write.descriptorCount = 1;
-                vkUpdateDescriptorSets(gRenderer->ld->dev, 1, &write, 0, VK_NULL_HANDLE);
-                setCount = 4;
+            if (gRenderer->deferredDraws) {
+                // Uniform data is copied since the user's pointer may not live until the queue is flushed
+                VK2DQueuedDraw *draw = _vk2dRendererQueueDraw(shader->pipe);
+                if (draw == NULL)
+                    return;
+                draw->shader = shader;
+                draw->tex = tex;
+                draw->dataOffset = gRenderer->drawQueueDataSize;
+                if (shader->uniformSize != 0)
+                    _vk2dRendererAppendData(&gRenderer->drawQueueData, &gRenderer->drawQueueDataSize, &gRenderer->drawQueueDataCapacity, data, shader->uniformSize);
+                _vk2dRendererWriteDrawCommand(&draw->command, 0, x, y, xscale, yscale, rot, originX, originY, xInTex, yInTex, texWidth, texHeight);
+            } else {
+                _vk2dRendererDrawShaderNow(shader, data, tex, x, y, xscale, yscale, rot, originX, originY, xInTex, yInTex, texWidth, texHeight);
             }
-
-            _vk2dRendererDrawShader(sets, setCount, tex, shader->pipe, x, y, xscale, yscale, rot, originX, originY, 1,
-                              xInTex,
-                              yInTex, texWidth, texHeight);
         } else {
             vk2dRaise(VK2D_STATUS_BAD_ASSET, "Shader does not exist.");
         }
@@ -826,9 +1096,30 @@ void vk2dRendererDrawShader(VK2DShader shader, void *data, VK2DTexture tex, floa
 void vk2dRendererAddBatch(VK2DDrawCommand *commands, uint32_t count) {
 	if (vk2dRendererGetPointer() != NULL && !vk2dStatusFatal()) {
         const VK2DPipeline pipe = gRenderer->instancedPipe;
-        for (int i = 0; i < count; i++) {
+        if (gRenderer->deferredDraws) {
+            for (uint32_t i = 0; i < count; i++) {
+                VK2DQueuedDraw *draw = _vk2dRendererQueueDraw(pipe);
+                if (draw == NULL)
+                    return;
+                draw->command = commands[i];
+            }
+            return;
+        }
+
+        uint32_t i = 0;
+        while (i < count) {
             _vk2dRendererFlushBatchIfNeeded(pipe);
-            _vk2dRendererAddDrawCommand(&commands[i]);
+            VK2DDrawCommand *slot = _vk2dRendererAddDrawCommand();
+            if (slot == NULL)
+                break;
+
+            // Copy as many commands as the current batch region has room for at once
+            uint32_t chunk = gRenderer->drawCommandCapacity - gRenderer->drawCommandCount + 1;
+            if (chunk > count - i)
+                chunk = count - i;
+            memcpy(slot, &commands[i], sizeof(struct VK2DDrawCommand) * chunk);
+            gRenderer->drawCommandCount += chunk - 1;
+            i += chunk;
         }
 	}
 }
@@ -836,43 +1127,47 @@ void vk2dRendererAddBatch(VK2DDrawCommand *commands, uint32_t count) {
 void vk2dRendererDrawTexture(VK2DTexture tex, float x, float y, float xscale, float yscale, float rot, float originX, float originY, float xInTex, float yInTex, float texWidth, float texHeight) {
 	if (vk2dRendererGetPointer() != NULL && !vk2dStatusFatal()) {
 		if (tex != NULL) {
-		    // Flush sprite batch if this is a pipeline change or commands at limit
 		    const VK2DPipeline pipe = gRenderer->instancedPipe;
-            _vk2dRendererFlushBatchIfNeeded(pipe);
-
-		    VK2DDrawCommand command;
-		    command.textureIndex = vk2dTextureGetID(tex);
-            command.texturePos[0] = xInTex;
-            command.texturePos[1] = yInTex;
-            command.texturePos[2] = texWidth;
-            command.texturePos[3] = texHeight;
-            command.rotation = rot;
-            command.colour[0] = gRenderer->colourBlend[0];
-            command.colour[1] = gRenderer->colourBlend[1];
-            command.colour[2] = gRenderer->colourBlend[2];
-            command.colour[3] = gRenderer->colourBlend[3];
-            command.origin[0] = originX;
-            command.origin[1] = originY;
-            command.scale[0] = xscale;
-            command.scale[1] = yscale;
-            command.pos[0] = x;
-            command.pos[1] = y;
-            _vk2dRendererAddDrawCommand(&command);
+		    VK2DDrawCommand *command;
+		    if (gRenderer->deferredDraws) {
+		        VK2DQueuedDraw *draw = _vk2dRendererQueueDraw(pipe);
+		        command = draw != NULL ? &draw->command : NULL;
+		    } else {
+		        // Flush sprite batch if this is a pipeline change or commands at limit
+		        _vk2dRendererFlushBatchIfNeeded(pipe);
+
+		        // The command is written straight into mapped staging memory
+		        command = _vk2dRendererAddDrawCommand();
+		    }
+		    if (command == NULL)
+		        return;
+		    _vk2dRendererWriteDrawCommand(command, vk2dTextureGetID(tex), x, y, xscale, yscale, rot, originX, originY, xInTex, yInTex, texWidth, texHeight);
 		} else {
             vk2dRaise(VK2D_STATUS_BAD_ASSET, "Texture does not exist.");
 		}
 	}
 }
 
-void vk2dRendererDrawPolygon(VK2DPolygon polygon, float x, float y, bool filled, float lineWidth, float xscale, float yscale, float rot, float originX, float originY) {
+void vk2dRendererDrawSpriteBatch(VK2DSpriteBatch batch) {
 	if (vk2dRendererGetPointer() != NULL && !vk2dStatusFatal()) {
-        vk2dRendererFlushSpriteBatch();
+		if (batch != NULL) {
+            vk2dRendererFlushSpriteBatch();
+            if (vk2dSpriteBatchCount(batch) > 0) {
+                // Uploads and rebuilds only what changed, then draws the whole batch
+                VkDescriptorBufferInfo sboInfos[3];
+                _vk2dSpriteBatchSync(batch, sboInfos);
+                _vk2dRendererDrawInstances(gRenderer->instancedPipe, sboInfos, vk2dSpriteBatchCount(batch), VK_NULL_HANDLE, 0, 0);
+            }
+		} else {
+            vk2dRaise(VK2D_STATUS_BAD_ASSET, "Sprite batch does not exist.");
+		}
+	}
+}
 
+void vk2dRendererDrawPolygon(VK2DPolygon polygon, float x, float y, bool filled, float lineWidth, float xscale, float yscale, float rot, float originX, float originY) {
+	if (vk2dRendererGetPointer() != NULL && !vk2dStatusFatal()) {
         if (polygon != NULL) {
-			VkDescriptorSet set;
-			_vk2dRendererDraw(&set, 1, polygon, filled ? gRenderer->primFillPipe : gRenderer->primLinePipe, x, y,
-							  xscale,
-							  yscale, rot, originX, originY, lineWidth, 0, 0, 0, 0);
+			_vk2dRendererAddShape(polygon, filled, lineWidth, x, y, xscale, yscale, rot, originX, originY);
 		} else {
             vk2dRaise(VK2D_STATUS_BAD_ASSET, "Polygon does not exist.");
 		}
@@ -882,27 +1177,8 @@ void vk2dRendererDrawPolygon(VK2DPolygon polygon, float x, float y, bool filled,
 void vk2dRendererDrawGeometry(VK2DVertexColour *vertices, int count, float x, float y, bool filled, float lineWidth, float xscale, float yscale, float rot, float originX, float originY) {
     if (vk2dRendererGetPointer() != NULL && !vk2dStatusFatal()) {
         if (vertices != NULL && count > 0) {
-            vk2dRendererFlushSpriteBatch();
-
-            if (count <= gRenderer->limits.maxGeometryVertices) {
-                // Copy vertex data to the current descriptor buffer
-                VkBuffer buffer;
-                VkDeviceSize offset;
-                vk2dDescriptorBufferCopyData(gRenderer->descriptorBuffers[gRenderer->currentFrame], vertices,
-                                             count * sizeof(VK2DVertexColour), &buffer, &offset);
-                struct VK2DBuffer_t buf;
-                buf.buf = buffer;
-                buf.offset = offset;
-                struct VK2DPolygon_t poly;
-                poly.vertexCount = count;
-                poly.vertices = &buf;
-                poly.type = VK2D_VERTEX_TYPE_SHAPE;
-                VkDescriptorSet set;
-                _vk2dRendererDraw(&set, 1, &poly, filled ? gRenderer->primFillPipe : gRenderer->primLinePipe, x, y,
-                                  xscale,
-                                  yscale, rot, originX, originY, lineWidth, 0, 0, 0, 0);
-                _vk2dRendererResetBoundPointers();
-            }
+            if (count <= gRenderer->limits.maxGeometryVertices)
+                _vk2dRendererAddGeometry(vertices, count, filled, lineWidth, x, y, xscale, yscale, rot, originX, originY);
         } else {
             vk2dRaise(VK2D_STATUS_BAD_ASSET, "Vertices does not exist.");
         }
@@ -954,12 +1230,24 @@ void vk2dRendererDrawWireframe(VK2DModel model, float x, float y, float z, float
 	}
 }
 
-static void _vk2dRendererFlushPerCamera(VkCommandBuffer buf, int cameraIndex) {
-    // Viewport/scissor
-    const int cam = cameraIndex; // TODO: Fix this
-    VK2DInstancedPushBuffer push = {
-            .cameraIndex = cameraIndex
-    };
+// Fills cameras with the index of every camera sprites are currently drawn to, returning how many there are
+static int _vk2dRendererGetDrawCameras(int cameras[VK2D_MAX_CAMERAS]) {
+    int count = 0;
+    if (gRenderer->target != VK2D_TARGET_SCREEN && !gRenderer->enableTextureCameraUBO) {
+        cameras[count++] = 0;
+    } else {
+        // Only render to 2D cameras
+        for (int i = 0; i < VK2D_MAX_CAMERAS; i++) {
+            if (gRenderer->cameras[i].state == VK2D_CAMERA_STATE_NORMAL && gRenderer->cameras[i].spec.type == VK2D_CAMERA_TYPE_DEFAULT && (i == gRenderer->cameraLocked || gRenderer->cameraLocked == VK2D_INVALID_CAMERA)) {
+                cameras[count++] = i;
+            }
+        }
+    }
+    return count;
+}
+
+// Sets the viewport/scissor for a camera, or the whole target if drawing to a texture
+static void _vk2dRendererSetCameraViewport(VkCommandBuffer buf, int cam) {
     VkRect2D scissor;
     VkViewport viewport;
     if (gRenderer->target == NULL) {
@@ -987,106 +1275,372 @@ static void _vk2dRendererFlushPerCamera(VkCommandBuffer buf, int cameraIndex) {
     }
     vkCmdSetViewport(buf, 0, 1, &viewport);
     vkCmdSetScissor(buf, 0, 1, &scissor);
-    vkCmdPushConstants(buf, gRenderer->currentBatchPipeline->layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(struct VK2DInstancedPushBuffer), &push);
-    vkCmdDraw(buf, 6 * gRenderer->drawCommandCount, 1, 0, 0);
+}
+
+// If indirectBuffer is not null, chunkCount indirect draws from the culling pass are drawn instead of every instance
+static void _vk2dRendererFlushPerCamera(VkCommandBuffer buf, VK2DPipeline pipe, int cameraIndex, uint32_t instanceCount, VkBuffer indirectBuffer, VkDeviceSize indirectOffset, uint32_t chunkCount) {
+    VK2DInstancedPushBuffer push = {
+            .cameraIndex = cameraIndex,
+            .culled = indirectBuffer != VK_NULL_HANDLE
+    };
+    _vk2dRendererSetCameraViewport(buf, cameraIndex);
+    vkCmdPushConstants(buf, pipe->layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(struct VK2DInstancedPushBuffer), &push);
+    if (indirectBuffer != VK_NULL_HANDLE)
+        vkCmdDrawIndirect(buf, indirectBuffer, indirectOffset, chunkCount, sizeof(VkDrawIndirectCommand));
+    else
+        vkCmdDraw(buf, 6 * instanceCount, 1, 0, 0);
+}
+
+// Draws instanceCount sprites from the instances in sboInfos (bindings 3 through 5 of the SBO set) with pipe (the instanced pipeline or an instanced
+// shader's), once per camera. If indirectBuffer is not null it holds chunkCount indirect draws per camera written by
+// the culling pass.
+static void _vk2dRendererDrawInstances(VK2DPipeline pipe, const VkDescriptorBufferInfo *sboInfos, uint32_t instanceCount, VkBuffer indirectBuffer, VkDeviceSize indirectOffset, uint32_t chunkCount) {
+    VkCommandBuffer buf = gRenderer->commandBuffer[gRenderer->scImageIndex];
+    _vk2dRendererResetBoundPointers();
+    vkCmdBindPipeline(buf, VK_PIPELINE_BIND_POINT_GRAPHICS, vk2dPipelineGetPipe(pipe, gRenderer->blendMode));
+    VkDescriptorSet sets[] = {
+        gRenderer->target != NULL && !gRenderer->enableTextureCameraUBO ? gRenderer->targetUBOSet : gRenderer->uboDescriptorSets[gRenderer->currentFrame],
+        gRenderer->samplerSet,
+        gRenderer->texArrayDescriptorSet
+    };
+    VkWriteDescriptorSet write = {
+            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .dstBinding = 3,
+            .descriptorCount = 3,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .pBufferInfo = sboInfos
+    };
+    // These things are the same across every camera, so they are only bound once
+    const uint32_t uboOffset = _vk2dRendererGetUBOOffset(sets[0]);
+    vkCmdBindDescriptorSets(buf, VK_PIPELINE_BIND_POINT_GRAPHICS, pipe->layout, 0, 3, sets, 1, &uboOffset);
+    _vk2dRendererBindTransientSet(buf, VK_PIPELINE_BIND_POINT_GRAPHICS, pipe->layout, 3, gRenderer->descConSBO[gRenderer->currentFrame], &write);
+    vkCmdSetLineWidth(buf, 1);
+
+    // Draw once per camera
+    int cameras[VK2D_MAX_CAMERAS];
+    const int cameraCount = _vk2dRendererGetDrawCameras(cameras);
+    for (int i = 0; i < cameraCount; i++) {
+        const VkDeviceSize offset = indirectOffset + (i * chunkCount * sizeof(VkDrawIndirectCommand));
+        _vk2dRendererFlushPerCamera(buf, pipe, cameras[i], instanceCount, indirectBuffer, offset, chunkCount);
+    }
+}
+
+// Makes room in the primitive batch for one more shape instance and run, flushing first if needed. vertexBytes is
+// how much is about to be added to the geometry stream. Returns the next free instance or NULL on failure.
+static VK2DShapeInstance *_vk2dRendererBeginShape(bool filled, VkDeviceSize vertexBytes) {
+    // Shapes are never deferred, so queued draws go out first to keep draw order. Everything in the batch also
+    // has to fit in one descriptor buffer page at flush.
+    if ((gRenderer->drawQueueCount > 0 && !gRenderer->drawQueueFlushing) ||
+        (gRenderer->shapeInstanceCount + 1) * sizeof(struct VK2DShapeInstance) > gRenderer->options.vramPageSize ||
+        gRenderer->geometryDataSize + vertexBytes > gRenderer->options.vramPageSize)
+        vk2dRendererFlushSpriteBatch();
+    _vk2dRendererFlushBatchIfNeeded(filled ? gRenderer->shapeFillPipe : gRenderer->shapeLinePipe);
+
+    // Grow the batch if needed
+    if (gRenderer->shapeInstanceCount == gRenderer->shapeInstanceCapacity) {
+        const uint32_t newCapacity = gRenderer->shapeInstanceCapacity * 2;
+        VK2DShapeInstance *newInstances = realloc(gRenderer->shapeInstances, newCapacity * sizeof(struct VK2DShapeInstance));
+        if (newInstances == NULL) {
+            vk2dRaise(VK2D_STATUS_OUT_OF_RAM, "Failed to extend primitive batch to %i shapes.", newCapacity);
+            return NULL;
+        }
+        gRenderer->shapeInstances = newInstances;
+        gRenderer->shapeInstanceCapacity = newCapacity;
+    }
+    if (gRenderer->shapeRunCount == gRenderer->shapeRunCapacity) {
+        const uint32_t newCapacity = gRenderer->shapeRunCapacity * 2;
+        VK2DShapeRun *newRuns = realloc(gRenderer->shapeRuns, newCapacity * sizeof(struct VK2DShapeRun));
+        if (newRuns == NULL) {
+            vk2dRaise(VK2D_STATUS_OUT_OF_RAM, "Failed to extend primitive batch to %i runs.", newCapacity);
+            return NULL;
+        }
+        gRenderer->shapeRuns = newRuns;
+        gRenderer->shapeRunCapacity = newCapacity;
+    }
+    return &gRenderer->shapeInstances[gRenderer->shapeInstanceCount];
+}
+
+// Adds a polygon to the primitive batch, consecutive shapes with the same polygon are drawn with one instanced draw
+static void _vk2dRendererAddShape(VK2DPolygon polygon, bool filled, float lineWidth, float x, float y, float xscale, float yscale, float rot, float originX, float originY) {
+    VK2DShapeInstance *shape = _vk2dRendererBeginShape(filled, 0);
+    if (shape == NULL)
+        return;
+
+    // Shapes only ever use the 2D part of the model matrix
+    mat4 model;
+    _vk2dRendererGetModelMatrix(model, x, y, xscale, yscale, rot, originX, originY);
+    memcpy(shape->colour, gRenderer->colourBlend, sizeof(vec4));
+    shape->xAxis[0] = model[0];
+    shape->xAxis[1] = model[1];
+    shape->yAxis[0] = model[4];
+    shape->yAxis[1] = model[5];
+    shape->translation[0] = model[12];
+    shape->translation[1] = model[13];
+
+    // Extend the last run if it draws the same polygon
+    lineWidth = filled || gRenderer->limits.maxLineWidth == 1 ? 1 : lineWidth;
+    VK2DShapeRun *run = gRenderer->shapeRunCount > 0 ? &gRenderer->shapeRuns[gRenderer->shapeRunCount - 1] : NULL;
+    if (run == NULL || run->vertices != polygon->vertices->buf || run->offset != polygon->vertices->offset || run->vertexCount != polygon->vertexCount || run->lineWidth != lineWidth) {
+        run = &gRenderer->shapeRuns[gRenderer->shapeRunCount++];
+        run->vertices = polygon->vertices->buf;
+        run->offset = polygon->vertices->offset;
+        run->vertexCount = polygon->vertexCount;
+        run->lineWidth = lineWidth;
+        run->firstInstance = gRenderer->shapeInstanceCount;
+        run->instanceCount = 0;
+    }
+    run->instanceCount++;
+    gRenderer->shapeInstanceCount++;
+}
+
+// Appends vertices to the primitive batch's geometry stream with the transform and colour mod already applied, so
+// consecutive filled geometry is drawn as a single draw. Outlines are line strips and can't be joined, but they
+// still share the stream and bindings and only cost a vkCmdDraw each.
+static void _vk2dRendererAddGeometry(VK2DVertexColour *vertices, uint32_t count, bool filled, float lineWidth, float x, float y, float xscale, float yscale, float rot, float originX, float originY) {
+    const VkDeviceSize size = count * sizeof(struct VK2DVertexColour);
+    VK2DShapeInstance *shape = _vk2dRendererBeginShape(filled, size);
+    if (shape == NULL)
+        return;
+    const VkDeviceSize offset = gRenderer->geometryDataSize;
+    VK2DVertexColour *out = _vk2dRendererAppendData(&gRenderer->geometryData, &gRenderer->geometryDataSize, &gRenderer->geometryDataCapacity, NULL, size);
+    if (out == NULL)
+        return;
+
+    // Plain loop over the 2x3 affine transform so the compiler can vectorize it
+    mat4 model;
+    _vk2dRendererGetModelMatrix(model, x, y, xscale, yscale, rot, originX, originY);
+    const float m0 = model[0], m1 = model[1], m4 = model[4], m5 = model[5], m12 = model[12], m13 = model[13];
+    const float r = gRenderer->colourBlend[0], g = gRenderer->colourBlend[1], b = gRenderer->colourBlend[2], a = gRenderer->colourBlend[3];
+    for (uint32_t i = 0; i < count; i++) {
+        const float vx = vertices[i].pos[0];
+        const float vy = vertices[i].pos[1];
+        out[i].pos[0] = (m0 * vx) + (m4 * vy) + m12;
+        out[i].pos[1] = (m1 * vx) + (m5 * vy) + m13;
+        out[i].pos[2] = vertices[i].pos[2];
+        out[i].colour[0] = vertices[i].colour[0] * r;
+        out[i].colour[1] = vertices[i].colour[1] * g;
+        out[i].colour[2] = vertices[i].colour[2] * b;
+        out[i].colour[3] = vertices[i].colour[3] * a;
+    }
+
+    // Filled geometry extends the last geometry run, everything else gets a new run with an identity instance
+    lineWidth = filled || gRenderer->limits.maxLineWidth == 1 ? 1 : lineWidth;
+    VK2DShapeRun *run = gRenderer->shapeRunCount > 0 ? &gRenderer->shapeRuns[gRenderer->shapeRunCount - 1] : NULL;
+    if (filled && run != NULL && run->vertices == VK_NULL_HANDLE) {
+        run->vertexCount += count;
+        return;
+    }
+    shape->colour[0] = 1;
+    shape->colour[1] = 1;
+    shape->colour[2] = 1;
+    shape->colour[3] = 1;
+    shape->xAxis[0] = 1;
+    shape->xAxis[1] = 0;
+    shape->yAxis[0] = 0;
+    shape->yAxis[1] = 1;
+    shape->translation[0] = 0;
+    shape->translation[1] = 0;
+    run = &gRenderer->shapeRuns[gRenderer->shapeRunCount++];
+    run->vertices = VK_NULL_HANDLE;
+    run->offset = offset;
+    run->vertexCount = count;
+    run->lineWidth = lineWidth;
+    run->firstInstance = gRenderer->shapeInstanceCount++;
+    run->instanceCount = 1;
+}
+
+// Draws every shape in the primitive batch, one instanced draw per run per camera
+static void _vk2dRendererFlushShapeBatch() {
+    VkCommandBuffer buf = gRenderer->commandBuffer[gRenderer->scImageIndex];
+    const VK2DPipeline pipe = gRenderer->currentBatchPipeline;
+
+    // Shape instances go in binding 3, the other bindings are unused by the shape shader but must be valid
+    VkDescriptorBufferInfo bufferInfos[3];
+    bufferInfos[0].range = gRenderer->shapeInstanceCount * sizeof(struct VK2DShapeInstance);
+    vk2dDescriptorBufferCopyData(gRenderer->descriptorBuffers[gRenderer->currentFrame], gRenderer->shapeInstances, bufferInfos[0].range, &bufferInfos[0].buffer, &bufferInfos[0].offset);
+    bufferInfos[1] = bufferInfos[0];
+    bufferInfos[2] = bufferInfos[0];
+    VkWriteDescriptorSet write = {
+            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .dstBinding = 3,
+            .descriptorCount = 3,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .pBufferInfo = bufferInfos
+    };
+
+    // The whole geometry stream is uploaded at once, geometry runs index into it with their first vertex
+    VkBuffer geometryBuffer = VK_NULL_HANDLE;
+    VkDeviceSize geometryOffset = 0;
+    if (gRenderer->geometryDataSize > 0)
+        vk2dDescriptorBufferCopyData(gRenderer->descriptorBuffers[gRenderer->currentFrame], gRenderer->geometryData, gRenderer->geometryDataSize, &geometryBuffer, &geometryOffset);
+
+    _vk2dRendererResetBoundPointers();
+    vkCmdBindPipeline(buf, VK_PIPELINE_BIND_POINT_GRAPHICS, vk2dPipelineGetPipe(pipe, gRenderer->blendMode));
+    VkDescriptorSet sets[] = {
+        gRenderer->target != NULL && !gRenderer->enableTextureCameraUBO ? gRenderer->targetUBOSet : gRenderer->uboDescriptorSets[gRenderer->currentFrame]
+    };
+    const uint32_t uboOffset = _vk2dRendererGetUBOOffset(sets[0]);
+    vkCmdBindDescriptorSets(buf, VK_PIPELINE_BIND_POINT_GRAPHICS, pipe->layout, 0, 1, sets, 1, &uboOffset);
+    _vk2dRendererBindTransientSet(buf, VK_PIPELINE_BIND_POINT_GRAPHICS, pipe->layout, 1, gRenderer->descConSBO[gRenderer->currentFrame], &write);
+
+    int cameras[VK2D_MAX_CAMERAS];
+    const int cameraCount = _vk2dRendererGetDrawCameras(cameras);
+    for (int i = 0; i < cameraCount; i++) {
+        VK2DInstancedPushBuffer push = {.cameraIndex = cameras[i]};
+        _vk2dRendererSetCameraViewport(buf, cameras[i]);
+        vkCmdPushConstants(buf, pipe->layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(struct VK2DInstancedPushBuffer), &push);
+        VkBuffer boundVertices = VK_NULL_HANDLE;
+        VkDeviceSize boundOffset = 0;
+        for (uint32_t r = 0; r < gRenderer->shapeRunCount; r++) {
+            const VK2DShapeRun *run = &gRenderer->shapeRuns[r];
+            const bool geometry = run->vertices == VK_NULL_HANDLE;
+            VkBuffer vertices = geometry ? geometryBuffer : run->vertices;
+            VkDeviceSize offset = geometry ? geometryOffset : run->offset;
+            const uint32_t firstVertex = geometry ? run->offset / sizeof(struct VK2DVertexColour) : 0;
+            if (vertices != boundVertices || offset != boundOffset) {
+                vkCmdBindVertexBuffers(buf, 0, 1, &vertices, &offset);
+                boundVertices = vertices;
+                boundOffset = offset;
+            }
+            vkCmdSetLineWidth(buf, run->lineWidth);
+            vkCmdDraw(buf, run->vertexCount, run->instanceCount, firstVertex, run->firstInstance);
+        }
+    }
+
+    // Reset the current batch
+    gRenderer->shapeInstanceCount = 0;
+    gRenderer->shapeRunCount = 0;
+    gRenderer->geometryDataSize = 0;
+    gRenderer->currentBatchPipeline = NULL;
+    gRenderer->currentBatchPipelineID = VK2D_PIPELINE_ID_NONE;
 }
 
 void vk2dRendererFlushSpriteBatch() {
     // This function does several things
-    //  1. Copies the current sprite batch to the descriptor buffer
-    //  2. Reserves space on the descriptor buffer for the compute output
+    //  1. Closes the batch region the draw commands were written to in the descriptor buffer
+    //  2. Reserves space on the descriptor buffer for the compute output (and culling output if supported)
     //  3. Dispatch the compute shader on the compute command buffer
     //  4. Send out the draw command that uses the soon-to-be-filled compute output as vertex input
+    // With computeFreeSprites, 2 and 3 are skipped and the vertex shader reads the draw commands itself
+    // Shapes from the primitive batch never share a batch with sprites and are drawn before any of this
+    // In deferred mode, the draw queue is sorted and replayed through here first
+    //
+    // When culling, the compute shader also tests each sprite against every camera's view and writes the visible
+    // sprites of each 64-sprite chunk to a per-camera list alongside one indirect draw per chunk. Drawing the
+    // chunks in order with a multi-draw indirect keeps sprites in submission order without drawing culled ones.
+    if (gRenderer->shapeInstanceCount > 0)
+        _vk2dRendererFlushShapeBatch();
+    if (gRenderer->drawQueueCount > 0 && !gRenderer->drawQueueFlushing)
+        _vk2dRendererFlushDrawQueue();
+    if (gRenderer->drawCommands != NULL) {
+        // Draw commands are already in staging memory, just give back whatever wasn't used
+        vk2dDescriptorBufferEndRegion(gRenderer->descriptorBuffers[gRenderer->currentFrame], gRenderer->drawCommandCount * sizeof(struct VK2DDrawCommand));
+        gRenderer->drawCommands = NULL;
+        gRenderer->drawCommandCapacity = 0;
+    }
     if (gRenderer->currentBatchPipeline != NULL && gRenderer->drawCommandCount > 0) {
-        // Copy the draw commands into a buffer
-        VkBuffer drawCommands, drawInstances;
-        VkDeviceSize drawCommandsOffset, drawInstancesOffset;
-        vk2dDescriptorBufferCopyData(
-                gRenderer->descriptorBuffers[gRenderer->currentFrame],
-                gRenderer->drawCommands,
-                gRenderer->drawCommandCount * sizeof(struct VK2DDrawCommand),
-                &drawCommands,
-                &drawCommandsOffset
-        );
-
-        // Reserve space for the draw instances
-        vk2dDescriptorBufferReserveSpace(
-                gRenderer->descriptorBuffers[gRenderer->currentFrame],
-                gRenderer->drawCommandCount * sizeof(VK2DDrawInstance),
-                &drawInstances,
-                &drawInstancesOffset
-        );
-
-        // Create descriptor sets
         const uint32_t drawCount = gRenderer->drawCommandCount;
-        VkDescriptorSet descriptorSet = vk2dDescConGetSet(gRenderer->descConCompute[gRenderer->currentFrame]);
-        VkDescriptorSet vertexShaderSBOSet = vk2dDescConGetSet(gRenderer->descConSBO[gRenderer->currentFrame]);
-        VkDescriptorBufferInfo bufferInfos[2] = {
+        const uint32_t chunkCount = (drawCount / 64) + 1;
+        VkDescriptorBufferInfo bufferInfos[5] = {
                 {
-                        .buffer = drawCommands,
-                        .offset = drawCommandsOffset,
+                        .buffer = gRenderer->drawCommandsBuffer,
+                        .offset = gRenderer->drawCommandsOffset,
                         .range = drawCount * sizeof(struct VK2DDrawCommand)
                 },
-                {
-                        .buffer = drawInstances,
-                        .offset = drawInstancesOffset,
-                        .range = drawCount * sizeof(struct VK2DDrawInstance)
-                }
+                {0}
         };
-        VkWriteDescriptorSet writes[] = {{
+        VkDescriptorBufferInfo *vertexShaderInfo = &bufferInfos[0];
+        VkDescriptorBufferInfo *visibleInfo = &bufferInfos[0];
+        VkBuffer indirectBuffer = VK_NULL_HANDLE;
+
+        // Only cull if the visible lists for every camera fit in a descriptor buffer page
+        int cameras[VK2D_MAX_CAMERAS];
+        const int cameraCount = _vk2dRendererGetDrawCameras(cameras);
+        const VkDeviceSize visibleSize = (VkDeviceSize)cameraCount * drawCount * sizeof(uint32_t);
+        const bool cull = gRenderer->limits.supportsGPUCulling &&
+                          cameraCount > 0 &&
+                          chunkCount <= gRenderer->pd->props.limits.maxDrawIndirectCount &&
+                          visibleSize <= gRenderer->options.vramPageSize;
+
+        if (!gRenderer->options.computeFreeSprites) {
+            // Reserve space for the draw instances
+            vk2dDescriptorBufferReserveSpace(
+                    gRenderer->descriptorBuffers[gRenderer->currentFrame],
+                    drawCount * gRenderer->drawInstanceSize,
+                    &bufferInfos[1].buffer,
+                    &bufferInfos[1].offset
+            );
+            bufferInfos[1].range = drawCount * gRenderer->drawInstanceSize;
+            vertexShaderInfo = &bufferInfos[1];
+
+            if (cull) {
+                // Camera views to cull against, in the same order the cameras are drawn in
+                vec4 views[VK2D_MAX_CAMERAS];
+                for (int i = 0; i < cameraCount; i++) {
+                    if (gRenderer->target != VK2D_TARGET_SCREEN && !gRenderer->enableTextureCameraUBO) {
+                        views[i][0] = 0;
+                        views[i][1] = 0;
+                        views[i][2] = gRenderer->target->img->width;
+                        views[i][3] = gRenderer->target->img->height;
+                    } else {
+                        memcpy(views[i], gRenderer->cameraViews[cameras[i]], sizeof(vec4));
+                    }
+                }
+                vk2dDescriptorBufferCopyData(gRenderer->descriptorBuffers[gRenderer->currentFrame], views, cameraCount * sizeof(vec4), &bufferInfos[2].buffer, &bufferInfos[2].offset);
+                bufferInfos[2].range = cameraCount * sizeof(vec4);
+
+                // Indirect draws and visible lists, both written entirely by the compute shader
+                const VkDeviceSize sizes[] = {cameraCount * chunkCount * sizeof(VkDrawIndirectCommand), visibleSize};
+                VkBuffer buffers[2];
+                VkDeviceSize offsets[2];
+                vk2dDescriptorBufferReserveBatch(gRenderer->descriptorBuffers[gRenderer->currentFrame], sizes, 2, buffers, offsets);
+                for (int i = 0; i < 2; i++) {
+                    bufferInfos[3 + i].buffer = buffers[i];
+                    bufferInfos[3 + i].offset = offsets[i];
+                    bufferInfos[3 + i].range = sizes[i];
+                }
+                indirectBuffer = bufferInfos[3].buffer;
+                visibleInfo = &bufferInfos[4];
+            } else {
+                // The shader doesn't touch the culling bindings without views, but they still need to be valid
+                bufferInfos[2] = bufferInfos[0];
+                bufferInfos[3] = bufferInfos[1];
+                bufferInfos[4] = bufferInfos[1];
+                visibleInfo = &bufferInfos[1];
+            }
+
+            VkWriteDescriptorSet write = {
                     .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-                    .dstSet = descriptorSet,
                     .dstBinding = 0,
-                    .descriptorCount = 2,
+                    .descriptorCount = 5,
                     .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
                     .pBufferInfo = bufferInfos
-            },
-            {
-                    .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-                    .dstSet = vertexShaderSBOSet,
-                    .dstBinding = 3,
-                    .descriptorCount = 1,
-                    .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
-                    .pBufferInfo = &bufferInfos[1]
-            }
-        };
-        vkUpdateDescriptorSets(gRenderer->ld->dev, 2, writes, 0, VK_NULL_HANDLE);
-
-        // Queue compute dispatches to the compute command buffer, synchronization will be recorded at the end of the frame
-        VkCommandBuffer computeBuf = gRenderer->computeCommandBuffer[gRenderer->scImageIndex];
-        VK2DComputePushBuffer push = { .drawCount = drawCount };
-        vkCmdPushConstants(computeBuf, gRenderer->spriteBatchPipe->layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(VK2DComputePushBuffer), &push);
-        vkCmdBindDescriptorSets(computeBuf, VK_PIPELINE_BIND_POINT_COMPUTE, gRenderer->spriteBatchPipe->layout, 0, 1, &descriptorSet, 0, VK_NULL_HANDLE);
-        vkCmdDispatch(computeBuf, (drawCount / 64) + 1, 1, 1);
-
-        // Dispatch compute and draw command
-        VkCommandBuffer buf = gRenderer->commandBuffer[gRenderer->scImageIndex];
-        _vk2dRendererResetBoundPointers();
-        vkCmdBindPipeline(buf, VK_PIPELINE_BIND_POINT_GRAPHICS, vk2dPipelineGetPipe(gRenderer->instancedPipe, gRenderer->blendMode));
-        VkDescriptorSet sets[] = {
-            gRenderer->target != NULL && !gRenderer->enableTextureCameraUBO ? gRenderer->targetUBOSet : gRenderer->uboDescriptorSets[gRenderer->currentFrame],
-            gRenderer->samplerSet,
-            gRenderer->texArrayDescriptorSet,
-            vertexShaderSBOSet
-        };
-        // These things are the same across every camera, so they are only bound once
-        vkCmdBindDescriptorSets(buf, VK_PIPELINE_BIND_POINT_GRAPHICS, gRenderer->instancedPipe->layout, 0, 4, sets, 0, VK_NULL_HANDLE);
-        vkCmdSetLineWidth(buf, 1);
+            };
+
+            // Queue compute dispatches to the compute command buffer, synchronization will be recorded at the end of the frame
+            VkCommandBuffer computeBuf = gRenderer->computeCommandBuffer[gRenderer->scImageIndex];
+            VK2DComputePushBuffer push = {
+                    .drawCount = drawCount,
+                    .viewCount = cull ? cameraCount : 0
+            };
+            vkCmdPushConstants(computeBuf, gRenderer->spriteBatchPipe->layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(VK2DComputePushBuffer), &push);
+            _vk2dRendererBindTransientSet(computeBuf, VK_PIPELINE_BIND_POINT_COMPUTE, gRenderer->spriteBatchPipe->layout, 0, gRenderer->descConCompute[gRenderer->currentFrame], &write);
+            vkCmdDispatch(computeBuf, chunkCount, 1, 1);
+        }
 
-        // Draw once per camera
-        if (gRenderer->target != VK2D_TARGET_SCREEN && !gRenderer->enableTextureCameraUBO) {
-            _vk2dRendererFlushPerCamera(buf, 0);
-        } else {
-            // Only render to 2D cameras
-            for (int i = 0; i < VK2D_MAX_CAMERAS; i++) {
-                if (gRenderer->cameras[i].state == VK2D_CAMERA_STATE_NORMAL && gRenderer->cameras[i].spec.type == VK2D_CAMERA_TYPE_DEFAULT && (i == gRenderer->cameraLocked || gRenderer->cameraLocked == VK2D_INVALID_CAMERA)) {
-                    _vk2dRendererFlushPerCamera(buf, i);
-                }
-            }
+        // Per-instance data from instanced shaders, in the same order as the draw commands
+        VkDescriptorBufferInfo sboInfos[3] = {*vertexShaderInfo, *visibleInfo, *vertexShaderInfo};
+        if (gRenderer->batchShaderDataSize > 0) {
+            vk2dDescriptorBufferCopyData(gRenderer->descriptorBuffers[gRenderer->currentFrame], gRenderer->batchShaderData, gRenderer->batchShaderDataSize, &sboInfos[2].buffer, &sboInfos[2].offset);
+            sboInfos[2].range = gRenderer->batchShaderDataSize;
         }
 
+        // Draw command that uses the compute output (or the draw commands themselves)
+        _vk2dRendererDrawInstances(gRenderer->currentBatchPipeline, sboInfos, drawCount, indirectBuffer, bufferInfos[3].offset, chunkCount);
+
         // Reset the current batch
         gRenderer->drawCommandCount = 0;
+        gRenderer->batchShaderDataSize = 0;
         gRenderer->currentBatchPipeline = NULL;
         gRenderer->currentBatchPipelineID = VK2D_PIPELINE_ID_NONE;
     }
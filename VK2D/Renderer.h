@@ -94,6 +94,8 @@ extern "C" {
 /// `loadCustomShaders` defaults to `false`
 /// `vramPageSize` defaults to `256 * 1000`, setting this to 0 also uses `256 * 1000`
 /// `maxTextures` defaults to 10000, setting this to 0 also uses 10000.
+/// `compactInstances` defaults to `false`
+/// `computeFreeSprites` defaults to `false`
 ///
 VK2DResult vk2dRendererInit(void *window, VK2DRendererConfig config, VK2DStartupOptions *options);
 
@@ -175,6 +177,46 @@ void vk2dRendererSetBlendMode(VK2DBlendMode blendMode);
 /// \return Returns the current blend mode
 VK2DBlendMode vk2dRendererGetBlendMode();
 
+/// \brief Enables or disables the deferred draw queue, flushing anything already drawn
+/// \param deferred If true, texture and shader draws are queued and sorted instead of drawn immediately
+///
+/// Normally the sprite batch is flushed every time the pipeline or blend mode changes, so interleaving
+/// vk2dRendererDrawTexture with vk2dRendererDrawShader or blend mode switches splits a frame into many
+/// small batches. With deferred draws on, vk2dRendererDrawTexture, vk2dRendererAddBatch, and
+/// vk2dRendererDrawShader are recorded with the current draw layer, colour mod, and blend mode and
+/// sorted by layer, then pipeline, then blend mode before being drawn in as few batches as possible.
+/// Draws with the same layer, pipeline, and blend mode keep the order they were submitted in.
+///
+/// The queue is flushed whenever the sprite batch would be, which includes changing the render target,
+/// the end of the frame, and drawing anything that isn't queued (shapes, polygons, models, shadows,
+/// retained sprite batches, etc).
+/// \warning Draws in the same layer may be reordered relative to each other if they use different
+/// pipelines or blend modes, use layers for anything whose draw order matters
+void vk2dRendererSetDeferredDraws(bool deferred);
+
+/// \brief Returns whether or not the deferred draw queue is enabled
+/// \return Returns true if draws are being deferred
+bool vk2dRendererGetDeferredDraws();
+
+/// \brief Sets the layer deferred draws are sorted by, lower layers are drawn first
+/// \param layer Layer for subsequent draws (default is 0)
+/// \note This does nothing unless deferred draws are enabled with vk2dRendererSetDeferredDraws
+void vk2dRendererSetDrawLayer(int32_t layer);
+
+/// \brief Gets the layer deferred draws are currently recorded with
+/// \return Returns the current draw layer
+int32_t vk2dRendererGetDrawLayer();
+
+/// \brief Returns the deferred draw queue counters for the last frame
+/// \return Returns how many draws were queued, how many batches they took, and how many flushes sorting saved
+VK2DDrawQueueStats vk2dRendererGetDrawQueueStats();
+
+/// \brief Returns how much of the per-frame descriptor buffer the last frame used
+/// \return Returns the allocation count, pages used, and bytes requested/used/wasted for the last frame
+///
+/// Useful for tuning VK2DStartupOptions::vramPageSize and VK2DStartupOptions::descriptorBufferMode.
+VK2DDescriptorBufferStats vk2dRendererGetDescriptorBufferStats();
+
 /// \brief Sets the current colour modifier (Colour all pixels are blended with)
 /// \param mod Colour mod to make current
 void vk2dRendererSetColourMod(const vec4 mod);
@@ -295,6 +337,14 @@ void vk2dRendererDrawTexture(VK2DTexture tex, float x, float y, float xscale, fl
 /// called from the same thread VK2D was created on.
 void vk2dRendererAddBatch(VK2DDrawCommand *commands, uint32_t count);
 
+/// \brief Draws every sprite in a retained sprite batch with a single draw call
+/// \param batch Sprite batch to draw
+///
+/// Only the sprites that were inserted, updated, or moved since the batch was last drawn
+/// are uploaded to the GPU and rebuilt by the sprite batch compute shader, everything else
+/// is drawn straight from device-local memory. This flushes the current sprite batch.
+void vk2dRendererDrawSpriteBatch(VK2DSpriteBatch batch);
+
 /// \brief Renders a texture
 /// \param shader Shader to draw with
 /// \param data Uniform buffer data the shader expects; should be the size specified when the shader was created or NULL if a size of 0 was given
@@ -310,6 +360,10 @@ void vk2dRendererAddBatch(VK2DDrawCommand *commands, uint32_t count);
 /// \param yInTex Y position in the texture to start drawing from
 /// \param texWidth Width of the texture to draw
 /// \param texHeight Height of the texture to draw
+///
+/// Shaders made with vk2dShaderLoadInstanced or vk2dShaderFromInstanced are added to the sprite
+/// batch, so consecutive draws with the same instanced shader go out in a single draw call. Other
+/// shaders are drawn immediately and flush the sprite batch.
 void
 vk2dRendererDrawShader(VK2DShader shader, void *data, VK2DTexture tex, float x, float y, float xscale, float yscale,
 					   float rot, float originX, float originY, float xInTex, float yInTex, float texWidth,
@@ -327,6 +381,10 @@ vk2dRendererDrawShader(VK2DShader shader, void *data, VK2DTexture tex, float x,
 /// \param originX X origin for rotation (in pixels)
 /// \param originY Y origin for rotation (in pixels)
 /// \warning If filled is true the polygon must be triangulated.
+///
+/// Polygons, rectangles, circles, and lines are collected into an instanced primitive batch
+/// that is drawn when something else is drawn or the frame ends, so many consecutive shapes
+/// cost one draw call per camera instead of one each.
 void vk2dRendererDrawPolygon(VK2DPolygon polygon, float x, float y, bool filled, float lineWidth, float xscale, float yscale, float rot, float originX, float originY);
 
 /// \brief Draws arbitrary geometry without needing to pre-allocate a polygon
@@ -345,6 +403,10 @@ void vk2dRendererDrawPolygon(VK2DPolygon polygon, float x, float y, bool filled,
 ///
 /// This function works by putting the geometry into a vram page before drawing,
 /// which means its limited by vk2dRendererGetLimits().maxGeometryVertices.
+///
+/// The vertices are transformed on the CPU and appended to the primitive batch's
+/// geometry stream, so consecutive filled geometry calls are drawn as a single draw.
+/// Outlines are line strips and still need one draw each, but share the same stream.
 void vk2dRendererDrawGeometry(VK2DVertexColour *vertices, int count, float x, float y, bool filled, float lineWidth, float xscale, float yscale, float rot, float originX, float originY);
 
 /// \brief Draws a shadow environment
@@ -438,23 +500,57 @@ void vk2dRendererFlushSpriteBatch();
 /// initializes the seed to system time.
 float vk2dRandom(float min, float max);
 
-/// \brief Loads a number of assets in a background thread
+/// \brief Loads a number of assets on background threads
 /// \param assets Array of VK2DAssetLoad structs that specify each asset you wish to load. The list is copied but not the data/strings inside it.
 /// \param count Number of VK2DAssetLoad structs in the array
 /// \warning Pointers allocated this way are not guaranteed to be valid until after vk2dAssetsWait
-/// \warning You may not call this again until vk2dAssetsWait is called
 /// \warning If vk2dRendererGetLimits().supportsMultiThreadLoading is false this will perform the asset load on the main thread (and be blocking)
 ///
-/// This function will load each asset in the assets list in another thread in the background
-/// so you may do other things to prepare your application. In essence its a non-blocking way
+/// This function will load each asset in the assets list on VK2D's loader threads in the background
+/// (see VK2DStartupOptions::loadThreads) so you may do other things to prepare your application. In essence its a non-blocking way
 /// to load your resources. If `vk2dRendererGetLimits().supportsMultiThreadLoading` is false
 /// this function will still load all of the specified assets, but it will be done on the main
-/// thread instead which will be blocking.
-///
-/// \warning This is currently unsupported until it is re-implemented in a more cross-platform manner
+/// thread instead which will be blocking. This may be called again while assets are still loading,
+/// it is the same as vk2dAssetsQueue with a priority of 0.
 void vk2dAssetsLoad(VK2DAssetLoad *assets, uint32_t count);
 
-/// \brief Waits until all of the assets provided to vk2dAssetsLoad have been loaded
+/// \brief Queues a group of assets to be loaded on background threads, even while other groups are still loading
+/// \param assets Array of VK2DAssetLoad structs that specify each asset you wish to load. The list is copied but not the data/strings inside it.
+/// \param count Number of VK2DAssetLoad structs in the array
+/// \param priority Groups with a higher priority are loaded before groups with a lower one, groups with equal priorities load in the order they were queued
+/// \return Returns a handle to the group or VK2D_INVALID_ASSET_GROUP if nothing could be queued
+/// \warning Pointers allocated this way are not guaranteed to be valid until after vk2dAssetsGroupWait
+/// \warning If vk2dRendererGetLimits().supportsMultiThreadLoading is false this will load the group on the main thread and it will already be complete
+///
+/// This is meant for streaming, ie. loading the next area's assets while the current one is being
+/// played. A newly queued group with a higher priority starts as soon as the loader threads finish
+/// the few assets they already have in hand, the rest of any lower priority group waits until it's done.
+/// Models in a group may use textures from the same group.
+VK2DAssetGroup vk2dAssetsQueue(VK2DAssetLoad *assets, uint32_t count, int32_t priority);
+
+/// \brief Returns how much of a group has been loaded as a percentage from 0-1
+/// \param group Group to check
+/// \return Returns 1 if the group is done loading, was cancelled, or is invalid
+float vk2dAssetsGroupStatus(VK2DAssetGroup group);
+
+/// \brief Returns true if every asset in a group has been loaded or skipped
+/// \param group Group to check
+bool vk2dAssetsGroupComplete(VK2DAssetGroup group);
+
+/// \brief Waits until every asset in a group has been loaded or skipped
+/// \param group Group to wait on
+/// \warning If vk2dRendererGetLimits().supportsMultiThreadLoading is false this does nothing
+void vk2dAssetsGroupWait(VK2DAssetGroup group);
+
+/// \brief Stops loading whatever is left of a group
+/// \param group Group to cancel
+///
+/// Assets in the group that haven't been loaded yet have their output set to NULL, assets
+/// that are already being loaded finish loading as normal. Either way, you must still wait
+/// on the group (or check vk2dAssetsGroupComplete) before freeing anything in it with vk2dAssetsFree.
+void vk2dAssetsCancel(VK2DAssetGroup group);
+
+/// \brief Waits until all of the assets provided to vk2dAssetsLoad and vk2dAssetsQueue have been loaded
 /// \warning If vk2dRendererGetLimits().supportsMultiThreadLoading is false this does nothing
 ///
 /// Typically you would use vk2dAssetsLoad after you initialize VK2D, then do your other
@@ -462,12 +558,15 @@ void vk2dAssetsLoad(VK2DAssetLoad *assets, uint32_t count);
 /// resources to make sure they're available in time.
 void vk2dAssetsWait();
 
-/// \brief Returns the loading status as a percentage from 0-1
+/// \brief Returns the loading status of every queued group as a percentage from 0-1
 /// \return Returns a status where 0 is nothing is loaded and 1 is everything is loaded
+///
+/// This counts every asset queued since the loader threads were last idle, use vk2dAssetsGroupStatus
+/// for the progress of a single group.
 /// \warning If vk2dRendererGetLimits().supportsMultiThreadLoading is false this will return 1
 float vk2dAssetsLoadStatus();
 
-/// \brief Returns true if the assets thread is done loading assets
+/// \brief Returns true if the loader threads are done loading every queued group
 /// \warning If vk2dRendererGetLimits().supportsMultiThreadLoading is false this returns true
 bool vk2dAssetsLoadComplete();
 
@@ -102,9 +102,13 @@ void _vk2dRendererRemoveShader(VK2DShader shader) {
     if (vk2dStatusFatal())
         return;
 	uint32_t i;
+
+	// The precompile thread may be holding this shader's pipeline
+	_vk2dRendererStopPipelinePrecompile();
 	for (i = 0; i < gRenderer->shaderListSize; i++)
 		if (gRenderer->customShaders[i] == shader)
 			gRenderer->customShaders[i] = NULL;
+	_vk2dRendererStartPipelinePrecompile();
 }
 
 uint64_t _vk2dHashSets(VkDescriptorSet *sets, uint32_t setCount) {
@@ -254,8 +258,25 @@ void _vk2dCameraUpdateUBO(VK2DUniformBufferObject *ubo, VK2DCameraSpec *camera,
 	}
 }
 
-//uint32_t frame, uint32_t descriptorFrame, int camera
-// Copies the camera ubos to the descriptor buffer and spits out the corresponding descriptor set
+// Finds the world-space bounding box (min x, min y, max x, max y) a 2D camera can see
+void _vk2dCameraGetView(vec4 view, VK2DCameraSpec *camera) {
+	// Same view _vk2dCameraUpdateUBO builds, w/h over zoom centred on the camera then rotated
+	const float halfW = (camera->w / camera->zoom) * 0.5;
+	const float halfH = (camera->h / camera->zoom) * 0.5;
+	const float c = fabsf(cosf(camera->rot));
+	const float s = fabsf(sinf(camera->rot));
+	const float extentX = (halfW * c) + (halfH * s);
+	const float extentY = (halfW * s) + (halfH * c);
+	const float centreX = camera->x + (camera->w * 0.5);
+	const float centreY = camera->y + (camera->h * 0.5);
+	view[0] = centreX - extentX;
+	view[1] = centreY - extentY;
+	view[2] = centreX + extentX;
+	view[3] = centreY + extentY;
+}
+
+// Copies the camera ubos to the descriptor buffer and picks the descriptor set and dynamic offset they're bound with.
+// The set belongs to the descriptor buffer page so it's only written the first time that page is used.
 void _vk2dRendererFlushUBOBuffers() {
 	VK2DRenderer gRenderer = vk2dRendererGetPointer();
     if (vk2dStatusFatal())
@@ -264,14 +285,20 @@ void _vk2dRendererFlushUBOBuffers() {
 	VkBuffer buffer;
 	VkDeviceSize offset;
 	vk2dDescriptorBufferCopyData(gRenderer->descriptorBuffers[gRenderer->currentFrame], &gRenderer->workingUBO, sizeof(VK2DUniformBufferObject), &buffer, &offset);
-	VkDescriptorBufferInfo bufferInfo = {buffer, offset, sizeof(VK2DUniformBufferObject)};
-	VkWriteDescriptorSet write = {0};
-	write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-	write.descriptorCount = 1;
-	write.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-	write.pBufferInfo = &bufferInfo;
-	write.dstSet = gRenderer->uboDescriptorSets[gRenderer->currentFrame];
-	vkUpdateDescriptorSets(gRenderer->ld->dev, 1, &write, 0, VK_NULL_HANDLE);
+	VkDescriptorSet set = vk2dDescriptorBufferGetDynamicSet(gRenderer->descriptorBuffers[gRenderer->currentFrame], buffer, gRenderer->dslBufferVP, 0, sizeof(VK2DUniformBufferObject));
+	if (set == VK_NULL_HANDLE) {
+		set = gRenderer->uboFallbackSets[gRenderer->currentFrame];
+		VkDescriptorBufferInfo bufferInfo = {buffer, 0, sizeof(VK2DUniformBufferObject)};
+		VkWriteDescriptorSet write = vk2dInitWriteDescriptorSet(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 0, set, &bufferInfo, 1, VK_NULL_HANDLE);
+		vkUpdateDescriptorSets(gRenderer->ld->dev, 1, &write, 0, VK_NULL_HANDLE);
+	}
+	gRenderer->uboDescriptorSets[gRenderer->currentFrame] = set;
+	gRenderer->uboOffset = offset;
+}
+
+uint32_t _vk2dRendererGetUBOOffset(VkDescriptorSet set) {
+	VK2DRenderer gRenderer = vk2dRendererGetPointer();
+	return set == gRenderer->uboDescriptorSets[gRenderer->currentFrame] ? gRenderer->uboOffset : 0;
 }
 
 void _vk2dRendererCreateDebug() {
@@ -500,12 +527,16 @@ void _vk2dRendererCreateSwapchain() {
 void _vk2dRendererDestroySwapchain() {
 	VK2DRenderer gRenderer = vk2dRendererGetPointer();
 	uint32_t i;
-	for (i = 0; i < gRenderer->swapchainImageCount; i++)
-		vkDestroyImageView(gRenderer->ld->dev, gRenderer->swapchainImageViews[i], VK_NULL_HANDLE);
+	if (gRenderer->swapchainImageViews != NULL)
+		for (i = 0; i < gRenderer->swapchainImageCount; i++)
+			vkDestroyImageView(gRenderer->ld->dev, gRenderer->swapchainImageViews[i], VK_NULL_HANDLE);
 
 	vkDestroySwapchainKHR(gRenderer->ld->dev, gRenderer->swapchain, VK_NULL_HANDLE);
 	free(gRenderer->swapchainImageViews);
 	free(gRenderer->swapchainImages);
+	gRenderer->swapchain = VK_NULL_HANDLE;
+	gRenderer->swapchainImageViews = NULL;
+	gRenderer->swapchainImages = NULL;
 }
 
 void _vk2dRendererCreateDepthBuffer() {
@@ -577,14 +608,24 @@ void _vk2dRendererCreateDescriptorBuffers() {
 	    return;
 	}
 	for (int i = 0; i < VK2D_MAX_FRAMES_IN_FLIGHT; i++) {
-		gRenderer->descriptorBuffers[i] = vk2dDescriptorBufferCreate(gRenderer->options.vramPageSize);
+		gRenderer->descriptorBuffers[i] = vk2dDescriptorBufferCreate(gRenderer->options.vramPageSize, gRenderer->options.descriptorBufferMode, gRenderer->options.descriptorBufferIdleFrames);
 	}
 
+	// Pages written directly to video memory have nothing to upload
+	if (gRenderer->descriptorBuffers[0] != NULL && gRenderer->descriptorBuffers[0]->directWrite)
+		gRenderer->limits.supportsTransferQueue = false;
+
 	// Calculate max instances
-	const int maxDrawInstances = gRenderer->options.vramPageSize / sizeof(VK2DDrawInstance);
+	gRenderer->drawInstanceSize = gRenderer->options.compactInstances ? sizeof(VK2DDrawInstanceCompact) : sizeof(VK2DDrawInstance);
+	const int maxDrawInstances = gRenderer->options.vramPageSize / gRenderer->drawInstanceSize;
 	const int maxDrawCommands = gRenderer->options.vramPageSize / sizeof(VK2DDrawCommand);
 
-	gRenderer->limits.maxInstancedDraws = maxDrawCommands < maxDrawInstances ? maxDrawCommands : maxDrawInstances;
+	if (gRenderer->options.computeFreeSprites) {
+		gRenderer->limits.maxInstancedDraws = maxDrawCommands;
+		gRenderer->limits.supportsGPUCulling = false;
+	} else {
+		gRenderer->limits.maxInstancedDraws = maxDrawCommands < maxDrawInstances ? maxDrawCommands : maxDrawInstances;
+	}
 	gRenderer->limits.maxInstancedDraws--;
 
     vk2dLog("Descriptor buffers created...");
@@ -763,15 +804,20 @@ void _vk2dRendererCreateDescriptorSetLayouts() {
 	// For view projection buffers
 	const uint32_t shapeLayoutCount = 1;
 	VkDescriptorSetLayoutBinding descriptorSetLayoutBindingShapes[1];
-	descriptorSetLayoutBindingShapes[0] = vk2dInitDescriptorSetLayoutBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT, VK_NULL_HANDLE);
+	descriptorSetLayoutBindingShapes[0] = vk2dInitDescriptorSetLayoutBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1, VK_SHADER_STAGE_VERTEX_BIT, VK_NULL_HANDLE);
 	VkDescriptorSetLayoutCreateInfo shapesDescriptorSetLayoutCreateInfo = vk2dInitDescriptorSetLayoutCreateInfo(descriptorSetLayoutBindingShapes, shapeLayoutCount);
 	r2 = vkCreateDescriptorSetLayout(gRenderer->ld->dev, &shapesDescriptorSetLayoutCreateInfo, VK_NULL_HANDLE, &gRenderer->dslBufferVP);
 
-	// For user-created shaders
+	// Layouts for sets that change every draw are pushed instead of allocated when possible
+	const VkDescriptorSetLayoutCreateFlags transientFlags = gRenderer->limits.supportsPushDescriptors ? VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR : 0;
+
+	// For user-created shaders, push descriptors can't be dynamic so the uniform is only dynamic without them
 	const uint32_t userLayoutCount = 1;
 	VkDescriptorSetLayoutBinding descriptorSetLayoutBindingUser[1];
-	descriptorSetLayoutBindingUser[0] = vk2dInitDescriptorSetLayoutBinding(3, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, VK_NULL_HANDLE);
+	const VkDescriptorType userType = gRenderer->limits.supportsPushDescriptors ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER : VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+	descriptorSetLayoutBindingUser[0] = vk2dInitDescriptorSetLayoutBinding(3, userType, 1, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, VK_NULL_HANDLE);
 	VkDescriptorSetLayoutCreateInfo userDescriptorSetLayoutCreateInfo = vk2dInitDescriptorSetLayoutCreateInfo(descriptorSetLayoutBindingUser, userLayoutCount);
+	userDescriptorSetLayoutCreateInfo.flags = transientFlags;
 	r3 = vkCreateDescriptorSetLayout(gRenderer->ld->dev, &userDescriptorSetLayoutCreateInfo, VK_NULL_HANDLE, &gRenderer->dslBufferUser);
 
 	// For sampled textures
@@ -808,33 +854,31 @@ void _vk2dRendererCreateDescriptorSetLayouts() {
     };
     r5 = vkCreateDescriptorSetLayout(gRenderer->ld->dev, &texArraySetLayoutCreateInfo, VK_NULL_HANDLE, &gRenderer->dslTextureArray);
 
-    // DSL for compute
-    VkDescriptorSetLayoutBinding dslbCompute[2] = {
-            {
-                    .descriptorCount = 1,
-                    .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
-                    .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
-                    .binding = 0
-            },
-            {
-                    .descriptorCount = 1,
-                    .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
-                    .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
-                    .binding = 1
-            }
-    };
+    // DSL for compute, commands in, instances out, camera views, indirect draws out, and visible lists out
+    VkDescriptorSetLayoutBinding dslbCompute[5];
+    for (int i = 0; i < 5; i++) {
+        dslbCompute[i].binding = i;
+        dslbCompute[i].descriptorCount = 1;
+        dslbCompute[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        dslbCompute[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        dslbCompute[i].pImmutableSamplers = VK_NULL_HANDLE;
+    }
     VkDescriptorSetLayoutCreateInfo dslComputeCreateInfo = {
             .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+            .flags = transientFlags,
             .pBindings = dslbCompute,
-            .bindingCount = 2
+            .bindingCount = 5
     };
     r6 = vkCreateDescriptorSetLayout(gRenderer->ld->dev, &dslComputeCreateInfo, VK_NULL_HANDLE, &gRenderer->dslSpriteBatch);
 
-    // For instanced vertex shader sbo shaders
-    const uint32_t sboLayoutCount = 1;
-    VkDescriptorSetLayoutBinding descriptorSetLayoutBindingSBO[1];
+    // For instanced vertex shader sbo shaders, instances, the visible list from culling, and per-instance user shader data
+    const uint32_t sboLayoutCount = 3;
+    VkDescriptorSetLayoutBinding descriptorSetLayoutBindingSBO[3];
     descriptorSetLayoutBindingSBO[0] = vk2dInitDescriptorSetLayoutBinding(3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT, VK_NULL_HANDLE);
+    descriptorSetLayoutBindingSBO[1] = vk2dInitDescriptorSetLayoutBinding(4, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT, VK_NULL_HANDLE);
+    descriptorSetLayoutBindingSBO[2] = vk2dInitDescriptorSetLayoutBinding(5, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, VK_NULL_HANDLE);
     VkDescriptorSetLayoutCreateInfo sboDescriptorSetLayoutCreateInfo = vk2dInitDescriptorSetLayoutCreateInfo(descriptorSetLayoutBindingSBO, sboLayoutCount);
+    sboDescriptorSetLayoutCreateInfo.flags = transientFlags;
     r7 = vkCreateDescriptorSetLayout(gRenderer->ld->dev, &sboDescriptorSetLayoutCreateInfo, VK_NULL_HANDLE, &gRenderer->dslBufferSBO);
 
 	if (r1 != VK_SUCCESS || r2 != VK_SUCCESS || r3 != VK_SUCCESS || r4 != VK_SUCCESS || r5 != VK_SUCCESS || r6 != VK_SUCCESS || r7 != VK_SUCCESS) {
@@ -856,13 +900,116 @@ void _vk2dRendererDestroyDescriptorSetLayout() {
     vkDestroyDescriptorSetLayout(gRenderer->ld->dev, gRenderer->dslBufferSBO, VK_NULL_HANDLE);
 }
 
+// Checks that pipeline cache file contents were written by this device and driver, returning the driver's data or NULL
+static const void *_vk2dRendererValidatePipelineCache(const unsigned char *file, uint32_t size, size_t *dataSize) {
+	VK2DRenderer gRenderer = vk2dRendererGetPointer();
+	_VK2DPipelineCacheHeader header;
+	if (file == NULL || size < sizeof(struct _VK2DPipelineCacheHeader))
+		return NULL;
+	memcpy(&header, file, sizeof(struct _VK2DPipelineCacheHeader));
+	if (header.magic != VK2D_PIPELINE_CACHE_MAGIC ||
+		header.vendorID != gRenderer->pd->props.vendorID ||
+		header.deviceID != gRenderer->pd->props.deviceID ||
+		header.driverVersion != gRenderer->pd->props.driverVersion ||
+		memcmp(header.pipelineCacheUUID, gRenderer->pd->props.pipelineCacheUUID, VK_UUID_SIZE) != 0 ||
+		header.dataSize != size - sizeof(struct _VK2DPipelineCacheHeader))
+		return NULL;
+	*dataSize = header.dataSize;
+	return file + sizeof(struct _VK2DPipelineCacheHeader);
+}
+
+void _vk2dRendererCreatePipelineCache() {
+	VK2DRenderer gRenderer = vk2dRendererGetPointer();
+    if (vk2dStatusFatal())
+        return;
+
+	// Start from the file on disk if there is one and it belongs to this device
+	unsigned char *file = NULL;
+	uint32_t fileSize = 0;
+	const char *path = gRenderer->options.pipelineCachePath;
+	if (path != NULL && _vk2dFileExists(path))
+		file = _vk2dLoadFile(path, &fileSize);
+	size_t dataSize = 0;
+	const void *data = _vk2dRendererValidatePipelineCache(file, fileSize, &dataSize);
+	if (file != NULL && data == NULL)
+		vk2dLog("Pipeline cache \"%s\" is from another device or driver, ignoring it...", path);
+
+	VkPipelineCacheCreateInfo createInfo = {
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+			.initialDataSize = dataSize,
+			.pInitialData = data
+	};
+	VkResult result = vkCreatePipelineCache(gRenderer->ld->dev, &createInfo, VK_NULL_HANDLE, &gRenderer->pipelineCache);
+	free(file);
+	if (result != VK_SUCCESS) {
+		gRenderer->pipelineCache = VK_NULL_HANDLE;
+		vk2dRaise(VK2D_STATUS_VULKAN_ERROR, "Failed to create pipeline cache, Vulkan error %i.", result);
+		return;
+	}
+	if (data != NULL)
+		vk2dLog("Pipeline cache loaded (%i bytes)...", (int)dataSize);
+	else
+		vk2dLog("Pipeline cache initialized...");
+}
+
+void _vk2dRendererDestroyPipelineCache() {
+	VK2DRenderer gRenderer = vk2dRendererGetPointer();
+	if (gRenderer->pipelineCache == VK_NULL_HANDLE)
+		return;
+
+	// Write the header and the driver's data out if the user wants it kept
+	const char *path = gRenderer->options.pipelineCachePath;
+	size_t dataSize = 0;
+	if (path != NULL && vkGetPipelineCacheData(gRenderer->ld->dev, gRenderer->pipelineCache, &dataSize, VK_NULL_HANDLE) == VK_SUCCESS && dataSize > 0) {
+		unsigned char *file = malloc(sizeof(struct _VK2DPipelineCacheHeader) + dataSize);
+		if (file != NULL) {
+			_VK2DPipelineCacheHeader header = {
+					.magic = VK2D_PIPELINE_CACHE_MAGIC,
+					.vendorID = gRenderer->pd->props.vendorID,
+					.deviceID = gRenderer->pd->props.deviceID,
+					.driverVersion = gRenderer->pd->props.driverVersion,
+			};
+			memcpy(header.pipelineCacheUUID, gRenderer->pd->props.pipelineCacheUUID, VK_UUID_SIZE);
+			VkResult result = vkGetPipelineCacheData(gRenderer->ld->dev, gRenderer->pipelineCache, &dataSize, file + sizeof(struct _VK2DPipelineCacheHeader));
+			header.dataSize = dataSize;
+			memcpy(file, &header, sizeof(struct _VK2DPipelineCacheHeader));
+			if (result == VK_SUCCESS && _vk2dSaveFile(path, file, sizeof(struct _VK2DPipelineCacheHeader) + dataSize))
+				vk2dLog("Pipeline cache saved to \"%s\" (%i bytes)...", path, (int)dataSize);
+			else
+				vk2dLog("Failed to save pipeline cache to \"%s\".", path);
+			free(file);
+		}
+	}
+	vkDestroyPipelineCache(gRenderer->ld->dev, gRenderer->pipelineCache, VK_NULL_HANDLE);
+	gRenderer->pipelineCache = VK_NULL_HANDLE;
+}
+
 VkPipelineVertexInputStateCreateInfo _vk2dGetTextureVertexInputState();
 VkPipelineVertexInputStateCreateInfo _vk2dGetColourVertexInputState();
 void _vk2dShaderBuildPipe(VK2DShader shader);
+
+// Works through a pipeline job list until it's empty, safe to run on several threads at once
+static int _vk2dPipelineWorker(void *data) {
+	VK2DRenderer gRenderer = vk2dRendererGetPointer();
+	_VK2DPipelineJobList *list = data;
+	int i;
+	while ((i = SDL_AddAtomicInt(&list->next, 1)) < (int)list->count) {
+		_VK2DPipelineJob *job = &list->jobs[i];
+		if (job->shader != NULL)
+			_vk2dShaderBuildPipe(job->shader);
+		else if (job->compute)
+			*job->pipe = vk2dPipelineCreateCompute(gRenderer->ld, job->pushBufferSize, job->vert, job->vertSize, job->layouts, job->layoutCount);
+		else
+			*job->pipe = vk2dPipelineCreate(gRenderer->ld, gRenderer->renderPass, gRenderer->surfaceWidth, gRenderer->surfaceHeight, job->vert, job->vertSize, job->frag, job->fragSize, job->layouts, job->layoutCount, job->vertexInfo, job->fill, gRenderer->config.msaa, job->type);
+	}
+	return 0;
+}
+
 void _vk2dRendererCreatePipelines() {
 	VK2DRenderer gRenderer = vk2dRendererGetPointer();
     if (vk2dStatusFatal())
         return;
+	const uint64_t startTime = SDL_GetPerformanceCounter();
 	uint32_t i;
 	VkPipelineVertexInputStateCreateInfo textureVertexInfo = _vk2dGetTextureVertexInputState();
 	VkPipelineVertexInputStateCreateInfo colourVertexInfo = _vk2dGetColourVertexInputState();
@@ -882,8 +1029,23 @@ void _vk2dRendererCreatePipelines() {
 	unsigned char *shaderModelFrag = (void*)VK2DFragModel;
     uint32_t shaderInstancedVertSize = sizeof(VK2DVertInstanced);
     unsigned char *shaderInstancedVert = (void*)VK2DVertInstanced;
+    uint32_t shaderSpriteBatchCompSize = sizeof(VK2DCompSpritebatch);
+    unsigned char *shaderSpriteBatchComp = (void*)VK2DCompSpritebatch;
+    if (gRenderer->options.computeFreeSprites) {
+        shaderInstancedVertSize = sizeof(VK2DVertInstancedcommands);
+        shaderInstancedVert = (void*)VK2DVertInstancedcommands;
+    } else if (gRenderer->options.compactInstances) {
+        shaderInstancedVertSize = sizeof(VK2DVertInstancedcompact);
+        shaderInstancedVert = (void*)VK2DVertInstancedcompact;
+        shaderSpriteBatchCompSize = sizeof(VK2DCompSpritebatchcompact);
+        shaderSpriteBatchComp = (void*)VK2DCompSpritebatchcompact;
+    }
     uint32_t shaderInstancedFragSize = sizeof(VK2DFragInstanced);
     unsigned char *shaderInstancedFrag = (void*)VK2DFragInstanced;
+    uint32_t shaderInstancedShapeVertSize = sizeof(VK2DVertInstancedshape);
+    unsigned char *shaderInstancedShapeVert = (void*)VK2DVertInstancedshape;
+    uint32_t shaderInstancedShapeFragSize = sizeof(VK2DFragInstancedshape);
+    unsigned char *shaderInstancedShapeFrag = (void*)VK2DFragInstancedshape;
     uint32_t shaderShadowsVertSize = sizeof(VK2DVertShadows);
     unsigned char *shaderShadowsVert = (void*)VK2DVertShadows;
     uint32_t shaderShadowsFragSize = sizeof(VK2DFragShadows);
@@ -893,134 +1055,84 @@ void _vk2dRendererCreatePipelines() {
 	if (vk2dStatusFatal())
 	    return;
 
-	// Texture pipeline
+	// Every pipeline is independent of the others so they are all compiled as jobs spread over a few threads
     VkDescriptorSetLayout instancedLayout[] = {gRenderer->dslBufferVP, gRenderer->dslSampler, gRenderer->dslTextureArray, gRenderer->dslBufferSBO};
-
-	// Polygon pipelines
-	gRenderer->primFillPipe = vk2dPipelineCreate(
-			gRenderer->ld,
-			gRenderer->renderPass,
-			gRenderer->surfaceWidth,
-			gRenderer->surfaceHeight,
-			shaderColourVert,
-			shaderColourVertSize,
-			shaderColourFrag,
-			shaderColourFragSize,
-			&gRenderer->dslBufferVP,
-			1,
-			&colourVertexInfo,
-			true,
-			gRenderer->config.msaa,
-            VK2D_PIPELINE_TYPE_DEFAULT);
-	gRenderer->primLinePipe = vk2dPipelineCreate(
-			gRenderer->ld,
-			gRenderer->renderPass,
-			gRenderer->surfaceWidth,
-			gRenderer->surfaceHeight,
-			shaderColourVert,
-			shaderColourVertSize,
-			shaderColourFrag,
-			shaderColourFragSize,
-			&gRenderer->dslBufferVP,
-			1,
-			&colourVertexInfo,
-			false,
-			gRenderer->config.msaa,
-            VK2D_PIPELINE_TYPE_DEFAULT);
-
-	// 3D pipelines
-	gRenderer->modelPipe = vk2dPipelineCreate(
-			gRenderer->ld,
-			gRenderer->renderPass,
-			gRenderer->surfaceWidth,
-			gRenderer->surfaceHeight,
-			shaderModelVert,
-			shaderModelVertSize,
-			shaderModelFrag,
-			shaderModelFragSize,
-            instancedLayout,
-			3,
-			&modelVertexInfo,
-			true,
-			gRenderer->config.msaa,
-            VK2D_PIPELINE_TYPE_3D);
-	gRenderer->wireframePipe = vk2dPipelineCreate(
-			gRenderer->ld,
-			gRenderer->renderPass,
-			gRenderer->surfaceWidth,
-			gRenderer->surfaceHeight,
-			shaderModelVert,
-			shaderModelVertSize,
-			shaderModelFrag,
-			shaderModelFragSize,
-            instancedLayout,
-			3,
-			&modelVertexInfo,
-			false,
-			gRenderer->config.msaa,
-            VK2D_PIPELINE_TYPE_3D);
-	gRenderer->instancedPipe = vk2dPipelineCreate(
-			gRenderer->ld,
-			gRenderer->renderPass,
-			gRenderer->surfaceWidth,
-			gRenderer->surfaceHeight,
-			shaderInstancedVert,
-			shaderInstancedVertSize,
-			shaderInstancedFrag,
-			shaderInstancedFragSize,
-			instancedLayout,
-			4,
-			&instanceVertexInfo,
-			true,
-			gRenderer->config.msaa,
-			VK2D_PIPELINE_TYPE_INSTANCING);
-
-	// Shadows pipeline
-    gRenderer->shadowsPipe = vk2dPipelineCreate(
-            gRenderer->ld,
-            gRenderer->renderPass,
-            gRenderer->surfaceWidth,
-            gRenderer->surfaceHeight,
-            shaderShadowsVert,
-            shaderShadowsVertSize,
-            shaderShadowsFrag,
-            shaderShadowsFragSize,
-            instancedLayout,
-            1,
-            &shadowsVertexInfo,
-            true,
-            gRenderer->config.msaa,
-            VK2D_PIPELINE_TYPE_SHADOWS);
-
-    // Compute
-    gRenderer->spriteBatchPipe = vk2dPipelineCreateCompute(
-            gRenderer->ld,
-            sizeof(VK2DComputePushBuffer),
-            (void*)VK2DCompSpritebatch,
-            sizeof(VK2DCompSpritebatch),
-            &gRenderer->dslSpriteBatch,
-            1);
+	VkDescriptorSetLayout shapeLayout[] = {gRenderer->dslBufferVP, gRenderer->dslBufferSBO};
+	_VK2DPipelineJob builtInJobs[] = {
+			// Polygon pipelines
+			{.pipe = &gRenderer->primFillPipe, .vert = shaderColourVert, .vertSize = shaderColourVertSize, .frag = shaderColourFrag, .fragSize = shaderColourFragSize, .layouts = &gRenderer->dslBufferVP, .layoutCount = 1, .vertexInfo = &colourVertexInfo, .fill = true, .type = VK2D_PIPELINE_TYPE_DEFAULT},
+			{.pipe = &gRenderer->primLinePipe, .vert = shaderColourVert, .vertSize = shaderColourVertSize, .frag = shaderColourFrag, .fragSize = shaderColourFragSize, .layouts = &gRenderer->dslBufferVP, .layoutCount = 1, .vertexInfo = &colourVertexInfo, .fill = false, .type = VK2D_PIPELINE_TYPE_DEFAULT},
+
+			// 3D pipelines
+			{.pipe = &gRenderer->modelPipe, .vert = shaderModelVert, .vertSize = shaderModelVertSize, .frag = shaderModelFrag, .fragSize = shaderModelFragSize, .layouts = instancedLayout, .layoutCount = 3, .vertexInfo = &modelVertexInfo, .fill = true, .type = VK2D_PIPELINE_TYPE_3D},
+			{.pipe = &gRenderer->wireframePipe, .vert = shaderModelVert, .vertSize = shaderModelVertSize, .frag = shaderModelFrag, .fragSize = shaderModelFragSize, .layouts = instancedLayout, .layoutCount = 3, .vertexInfo = &modelVertexInfo, .fill = false, .type = VK2D_PIPELINE_TYPE_3D},
+
+			// Texture pipeline
+			{.pipe = &gRenderer->instancedPipe, .vert = shaderInstancedVert, .vertSize = shaderInstancedVertSize, .frag = shaderInstancedFrag, .fragSize = shaderInstancedFragSize, .layouts = instancedLayout, .layoutCount = 4, .vertexInfo = &instanceVertexInfo, .fill = true, .type = VK2D_PIPELINE_TYPE_INSTANCING},
+
+			// Primitive batch pipelines, shapes come from polygon vertex buffers and each instance is read from the SBO
+			{.pipe = &gRenderer->shapeFillPipe, .vert = shaderInstancedShapeVert, .vertSize = shaderInstancedShapeVertSize, .frag = shaderInstancedShapeFrag, .fragSize = shaderInstancedShapeFragSize, .layouts = shapeLayout, .layoutCount = 2, .vertexInfo = &colourVertexInfo, .fill = true, .type = VK2D_PIPELINE_TYPE_INSTANCING},
+			{.pipe = &gRenderer->shapeLinePipe, .vert = shaderInstancedShapeVert, .vertSize = shaderInstancedShapeVertSize, .frag = shaderInstancedShapeFrag, .fragSize = shaderInstancedShapeFragSize, .layouts = shapeLayout, .layoutCount = 2, .vertexInfo = &colourVertexInfo, .fill = false, .type = VK2D_PIPELINE_TYPE_INSTANCING},
+
+			// Shadows pipeline
+			{.pipe = &gRenderer->shadowsPipe, .vert = shaderShadowsVert, .vertSize = shaderShadowsVertSize, .frag = shaderShadowsFrag, .fragSize = shaderShadowsFragSize, .layouts = instancedLayout, .layoutCount = 1, .vertexInfo = &shadowsVertexInfo, .fill = true, .type = VK2D_PIPELINE_TYPE_SHADOWS},
+
+			// Compute
+			{.pipe = &gRenderer->spriteBatchPipe, .vert = shaderSpriteBatchComp, .vertSize = shaderSpriteBatchCompSize, .layouts = &gRenderer->dslSpriteBatch, .layoutCount = 1, .compute = true, .pushBufferSize = sizeof(VK2DComputePushBuffer)},
+	};
+	const uint32_t builtInCount = sizeof(builtInJobs) / sizeof(_VK2DPipelineJob);
+	_VK2DPipelineJobList list = {0};
+	list.jobs = malloc(sizeof(_VK2DPipelineJob) * (builtInCount + gRenderer->shaderListSize));
+	if (list.jobs == NULL) {
+		vk2dRaise(VK2D_STATUS_OUT_OF_RAM, "Failed to allocate pipeline job list.");
+		return;
+	}
+	for (i = 0; i < builtInCount; i++)
+		list.jobs[list.count++] = builtInJobs[i];
 
 	// Shader pipelines
 	for (i = 0; i < gRenderer->shaderListSize; i++) {
 		if (gRenderer->customShaders[i] != NULL) {
 			vk2dPipelineFree(gRenderer->customShaders[i]->pipe);
-			_vk2dShaderBuildPipe(gRenderer->customShaders[i]);
+			gRenderer->customShaders[i]->pipe = NULL;
+			_VK2DPipelineJob job = {.shader = gRenderer->customShaders[i]};
+			list.jobs[list.count++] = job;
 		}
 	}
 
+	// This thread works through the list too, so a worker that fails to start just means fewer threads
+	SDL_Thread *workers[VK2D_MAX_PIPELINE_WORKERS];
+	int workerCount = SDL_GetNumLogicalCPUCores() - 1;
+	if (workerCount > VK2D_MAX_PIPELINE_WORKERS)
+		workerCount = VK2D_MAX_PIPELINE_WORKERS;
+	if (workerCount > (int)list.count - 1)
+		workerCount = (int)list.count - 1;
+	SDL_SetAtomicInt(&list.next, 0);
+	for (i = 0; (int)i < workerCount; i++)
+		workers[i] = SDL_CreateThread(_vk2dPipelineWorker, "VK2D_Pipeline", &list);
+	_vk2dPipelineWorker(&list);
+	for (i = 0; (int)i < workerCount; i++)
+		if (workers[i] != NULL)
+			SDL_WaitThread(workers[i], NULL);
+	free(list.jobs);
+
     // In case something somewhere failed
     if (!vk2dStatusFatal())
-        vk2dLog("Pipelines initialized...");
+        vk2dLog("Pipelines initialized in %.2fms on %i threads...", ((double)(SDL_GetPerformanceCounter() - startTime) / (double)SDL_GetPerformanceFrequency()) * 1000, workerCount + 1);
+
+	_vk2dRendererStartPipelinePrecompile();
 }
 
 void _vk2dRendererDestroyPipelines(bool preserveCustomPipes) {
 	VK2DRenderer gRenderer = vk2dRendererGetPointer();
+	_vk2dRendererStopPipelinePrecompile();
 	vk2dPipelineFree(gRenderer->primLinePipe);
 	vk2dPipelineFree(gRenderer->primFillPipe);
 	vk2dPipelineFree(gRenderer->modelPipe);
 	vk2dPipelineFree(gRenderer->wireframePipe);
     vk2dPipelineFree(gRenderer->instancedPipe);
+    vk2dPipelineFree(gRenderer->shapeFillPipe);
+    vk2dPipelineFree(gRenderer->shapeLinePipe);
     vk2dPipelineFree(gRenderer->shadowsPipe);
     vk2dPipelineFree(gRenderer->spriteBatchPipe);
 
@@ -1028,6 +1140,65 @@ void _vk2dRendererDestroyPipelines(bool preserveCustomPipes) {
 		free(gRenderer->customShaders);
 }
 
+static int _vk2dPipelinePrecompileThread(void *data) {
+	VK2DRenderer gRenderer = data;
+	const uint64_t startTime = SDL_GetPerformanceCounter();
+	uint32_t i, j;
+	for (i = 0; i < gRenderer->precompileCount; i++) {
+		for (j = 0; j < VK2D_BLEND_MODE_MAX; j++) {
+			if (SDL_GetAtomicInt(&gRenderer->precompileStop) || vk2dStatusFatal())
+				return 0;
+			vk2dPipelineGetPipe(gRenderer->precompileList[i], (VK2DBlendMode)j);
+		}
+	}
+	vk2dLog("Precompiled blend modes for %i pipelines in %.2fms...", gRenderer->precompileCount, ((double)(SDL_GetPerformanceCounter() - startTime) / (double)SDL_GetPerformanceFrequency()) * 1000);
+	return 0;
+}
+
+void _vk2dRendererStartPipelinePrecompile() {
+	VK2DRenderer gRenderer = vk2dRendererGetPointer();
+	if (vk2dStatusFatal() || !gRenderer->options.precompileBlendModes || gRenderer->precompileThread != NULL)
+		return;
+	uint32_t i;
+
+	// Snapshot of every graphics pipeline, the thread is stopped before any of them are freed
+	VK2DPipeline builtIn[] = {gRenderer->primFillPipe, gRenderer->primLinePipe, gRenderer->modelPipe, gRenderer->wireframePipe, gRenderer->instancedPipe, gRenderer->shapeFillPipe, gRenderer->shapeLinePipe, gRenderer->shadowsPipe};
+	const uint32_t builtInCount = sizeof(builtIn) / sizeof(VK2DPipeline);
+	gRenderer->precompileList = malloc(sizeof(VK2DPipeline) * (builtInCount + gRenderer->shaderListSize));
+	if (gRenderer->precompileList == NULL) {
+		vk2dRaise(VK2D_STATUS_OUT_OF_RAM, "Failed to allocate pipeline precompile list.");
+		return;
+	}
+	gRenderer->precompileCount = 0;
+	for (i = 0; i < builtInCount; i++)
+		if (builtIn[i] != NULL)
+			gRenderer->precompileList[gRenderer->precompileCount++] = builtIn[i];
+	for (i = 0; i < gRenderer->shaderListSize; i++)
+		if (gRenderer->customShaders[i] != NULL && gRenderer->customShaders[i]->pipe != NULL)
+			gRenderer->precompileList[gRenderer->precompileCount++] = gRenderer->customShaders[i]->pipe;
+
+	SDL_SetAtomicInt(&gRenderer->precompileStop, 0);
+	gRenderer->precompileThread = SDL_CreateThread(_vk2dPipelinePrecompileThread, "VK2D_Precompile", gRenderer);
+	if (gRenderer->precompileThread == NULL) {
+		vk2dRaise(VK2D_STATUS_SDL_ERROR, "Failed to start pipeline precompile thread, SDL error: %s", SDL_GetError());
+		free(gRenderer->precompileList);
+		gRenderer->precompileList = NULL;
+		gRenderer->precompileCount = 0;
+	}
+}
+
+void _vk2dRendererStopPipelinePrecompile() {
+	VK2DRenderer gRenderer = vk2dRendererGetPointer();
+	if (gRenderer->precompileThread != NULL) {
+		SDL_SetAtomicInt(&gRenderer->precompileStop, 1);
+		SDL_WaitThread(gRenderer->precompileThread, NULL);
+		gRenderer->precompileThread = NULL;
+	}
+	free(gRenderer->precompileList);
+	gRenderer->precompileList = NULL;
+	gRenderer->precompileCount = 0;
+}
+
 void _vk2dRendererCreateFrameBuffer() {
 	VK2DRenderer gRenderer = vk2dRendererGetPointer();
     if (vk2dStatusFatal())
@@ -1078,9 +1249,19 @@ void _vk2dRendererDestroyFrameBuffer() {
         for (i = 0; i < gRenderer->swapchainImageCount; i++)
             vkDestroyFramebuffer(gRenderer->ld->dev, gRenderer->framebuffers[i], VK_NULL_HANDLE);
         free(gRenderer->framebuffers);
+        gRenderer->framebuffers = NULL;
     }
 }
 
+// Keeps the default camera covering the whole window
+static void _vk2dRendererFitDefaultCamera() {
+	VK2DRenderer gRenderer = vk2dRendererGetPointer();
+	gRenderer->cameras[VK2D_DEFAULT_CAMERA].spec.wOnScreen = gRenderer->surfaceWidth;
+	gRenderer->cameras[VK2D_DEFAULT_CAMERA].spec.hOnScreen = gRenderer->surfaceHeight;
+	gRenderer->cameras[VK2D_DEFAULT_CAMERA].spec.w = gRenderer->surfaceWidth;
+	gRenderer->cameras[VK2D_DEFAULT_CAMERA].spec.h = gRenderer->surfaceHeight;
+}
+
 void _vk2dRendererCreateUniformBuffers(bool newCamera) {
 	VK2DRenderer gRenderer = vk2dRendererGetPointer();
     if (vk2dStatusFatal())
@@ -1115,10 +1296,7 @@ void _vk2dRendererCreateUniformBuffers(bool newCamera) {
 	}
 
 	// Set default camera new viewport/scissor
-	gRenderer->cameras[VK2D_DEFAULT_CAMERA].spec.wOnScreen = gRenderer->surfaceWidth;
-	gRenderer->cameras[VK2D_DEFAULT_CAMERA].spec.hOnScreen = gRenderer->surfaceHeight;
-	gRenderer->cameras[VK2D_DEFAULT_CAMERA].spec.w = gRenderer->surfaceWidth;
-	gRenderer->cameras[VK2D_DEFAULT_CAMERA].spec.h = gRenderer->surfaceHeight;
+	_vk2dRendererFitDefaultCamera();
 
 	if (!vk2dStatusFatal())
         vk2dLog("UBO initialized...");
@@ -1134,17 +1312,62 @@ void _vk2dRendererDestroyUniformBuffers() {
 
 void _vk2dRendererCreateSpriteBatching() {
     VK2DRenderer gRenderer = vk2dRendererGetPointer();
-    gRenderer->drawCommands = malloc(sizeof(struct VK2DDrawCommand) * gRenderer->limits.maxInstancedDraws);
+    // Draw commands live in the descriptor buffer's staging memory, so there is nothing to allocate up front
+    gRenderer->drawCommands = NULL;
     gRenderer->drawCommandCount = 0;
-
-    if (gRenderer->drawCommands == NULL) {
-        vk2dRaise(VK2D_STATUS_OUT_OF_RAM, "Failed to allocate sprite batch of count %i.", gRenderer->limits.maxInstancedDraws);
-    }
+    gRenderer->drawCommandCapacity = 0;
+
+    // Deferred draw queue
+    gRenderer->drawQueue = malloc(sizeof(struct VK2DQueuedDraw) * VK2D_DEFAULT_DRAW_QUEUE_SIZE);
+    gRenderer->drawQueueKeys = malloc(sizeof(struct VK2DQueuedDrawKey) * VK2D_DEFAULT_DRAW_QUEUE_SIZE);
+    gRenderer->drawQueueCount = 0;
+    gRenderer->drawQueueSize = VK2D_DEFAULT_DRAW_QUEUE_SIZE;
+    gRenderer->drawQueueFlushing = false;
+    if (gRenderer->drawQueue == NULL || gRenderer->drawQueueKeys == NULL)
+        vk2dRaise(VK2D_STATUS_OUT_OF_RAM, "Failed to allocate draw queue.");
+
+    // Primitive batch
+    gRenderer->shapeInstances = malloc(sizeof(struct VK2DShapeInstance) * VK2D_DEFAULT_SHAPE_BATCH_SIZE);
+    gRenderer->shapeRuns = malloc(sizeof(struct VK2DShapeRun) * VK2D_DEFAULT_SHAPE_BATCH_SIZE);
+    gRenderer->shapeInstanceCount = 0;
+    gRenderer->shapeRunCount = 0;
+    gRenderer->shapeInstanceCapacity = VK2D_DEFAULT_SHAPE_BATCH_SIZE;
+    gRenderer->shapeRunCapacity = VK2D_DEFAULT_SHAPE_BATCH_SIZE;
+    if (gRenderer->shapeInstances == NULL || gRenderer->shapeRuns == NULL)
+        vk2dRaise(VK2D_STATUS_OUT_OF_RAM, "Failed to allocate primitive batch.");
 }
 
 void _vk2dRendererDestroySpriteBatching() {
     VK2DRenderer gRenderer = vk2dRendererGetPointer();
-    free(gRenderer->drawCommands);
+    gRenderer->drawCommands = NULL;
+    gRenderer->drawCommandCount = 0;
+    gRenderer->drawCommandCapacity = 0;
+    free(gRenderer->drawQueue);
+    free(gRenderer->drawQueueKeys);
+    free(gRenderer->drawQueueData);
+    free(gRenderer->batchShaderData);
+    gRenderer->drawQueue = NULL;
+    gRenderer->drawQueueKeys = NULL;
+    gRenderer->drawQueueData = NULL;
+    gRenderer->batchShaderData = NULL;
+    gRenderer->drawQueueCount = 0;
+    gRenderer->drawQueueSize = 0;
+    gRenderer->drawQueueDataSize = 0;
+    gRenderer->drawQueueDataCapacity = 0;
+    gRenderer->batchShaderDataSize = 0;
+    gRenderer->batchShaderDataCapacity = 0;
+    free(gRenderer->shapeInstances);
+    free(gRenderer->shapeRuns);
+    free(gRenderer->geometryData);
+    gRenderer->shapeInstances = NULL;
+    gRenderer->shapeRuns = NULL;
+    gRenderer->geometryData = NULL;
+    gRenderer->geometryDataSize = 0;
+    gRenderer->geometryDataCapacity = 0;
+    gRenderer->shapeInstanceCount = 0;
+    gRenderer->shapeRunCount = 0;
+    gRenderer->shapeInstanceCapacity = 0;
+    gRenderer->shapeRunCapacity = 0;
 }
 
 void _vk2dRendererCreateDescriptorPool(bool preserveDescCons) {
@@ -1154,11 +1377,16 @@ void _vk2dRendererCreateDescriptorPool(bool preserveDescCons) {
 	if (!preserveDescCons) {
 		gRenderer->descConSamplers = vk2dDescConCreate(gRenderer->ld, gRenderer->dslTexture, VK2D_NO_LOCATION, 2, VK2D_NO_LOCATION);
 		gRenderer->descConSamplersOff = vk2dDescConCreate(gRenderer->ld, gRenderer->dslTexture, VK2D_NO_LOCATION, 2, VK2D_NO_LOCATION);
-		gRenderer->descConVP = vk2dDescConCreate(gRenderer->ld, gRenderer->dslBufferVP, 0, VK2D_NO_LOCATION, VK2D_NO_LOCATION);
-		gRenderer->descConUser = vk2dDescConCreate(gRenderer->ld, gRenderer->dslBufferUser, 3, VK2D_NO_LOCATION, VK2D_NO_LOCATION);
-		for (int i = 0; i < VK2D_MAX_FRAMES_IN_FLIGHT; i++) {
+		gRenderer->descConVP = vk2dDescConCreateDynamic(gRenderer->ld, gRenderer->dslBufferVP, 0);
+		if (gRenderer->limits.supportsPushDescriptors)
+			gRenderer->descConUser = vk2dDescConCreate(gRenderer->ld, gRenderer->dslBufferUser, 3, VK2D_NO_LOCATION, VK2D_NO_LOCATION);
+		else
+			gRenderer->descConUser = vk2dDescConCreateDynamic(gRenderer->ld, gRenderer->dslBufferUser, 3);
+
+		// Per-draw sets don't need pools at all if they're pushed
+		for (int i = 0; i < VK2D_MAX_FRAMES_IN_FLIGHT && !gRenderer->limits.supportsPushDescriptors; i++) {
             gRenderer->descConCompute[i] = vk2dDescConCreate(gRenderer->ld, gRenderer->dslSpriteBatch, VK2D_NO_LOCATION, VK2D_NO_LOCATION, 0);
-            gRenderer->descConShaders[i] = vk2dDescConCreate(gRenderer->ld, gRenderer->dslBufferUser, 3, VK2D_NO_LOCATION, VK2D_NO_LOCATION);
+            gRenderer->descConShaders[i] = vk2dDescConCreateDynamic(gRenderer->ld, gRenderer->dslBufferUser, 3);
             gRenderer->descConSBO[i] = vk2dDescConCreate(gRenderer->ld, gRenderer->dslBufferSBO, VK2D_NO_LOCATION, VK2D_NO_LOCATION, 3);
         }
 
@@ -1220,9 +1448,11 @@ void _vk2dRendererCreateDescriptorPool(bool preserveDescCons) {
             vk2dRaise(VK2D_STATUS_OUT_OF_RAM, "Failed to allocate texture info for %i potential textures.", gRenderer->options.maxTextures);
         }
 
-        // Make the viewproj descriptor sets
-        for (int i = 0; i < VK2D_MAX_FRAMES_IN_FLIGHT; i++)
-            gRenderer->uboDescriptorSets[i] = vk2dDescConGetSet(gRenderer->descConVP);
+        // Make the viewproj descriptor sets, normally the descriptor buffer pages have their own
+        for (int i = 0; i < VK2D_MAX_FRAMES_IN_FLIGHT; i++) {
+            gRenderer->uboFallbackSets[i] = vk2dDescConGetSet(gRenderer->descConVP);
+            gRenderer->uboDescriptorSets[i] = gRenderer->uboFallbackSets[i];
+        }
 	} else {
         vk2dLog("Descriptor controllers preserved...");
 	}
@@ -1256,29 +1486,38 @@ void _vk2dRendererCreateSynchronization() {
 	gRenderer->imageAvailableSemaphores = calloc(1, sizeof(VkSemaphore) * VK2D_MAX_FRAMES_IN_FLIGHT);
 	gRenderer->renderFinishedSemaphores = calloc(1, sizeof(VkSemaphore) * VK2D_MAX_FRAMES_IN_FLIGHT);
 	gRenderer->inFlightFences = calloc(1, sizeof(VkFence) * VK2D_MAX_FRAMES_IN_FLIGHT);
+	gRenderer->uploadSemaphores = calloc(1, sizeof(VkSemaphore) * VK2D_MAX_FRAMES_IN_FLIGHT);
 	gRenderer->imagesInFlight = calloc(1, sizeof(VkFence) * gRenderer->swapchainImageCount);
 	gRenderer->commandBuffer = calloc(1, sizeof(VkCommandBuffer) * gRenderer->swapchainImageCount);
     gRenderer->dbCommandBuffer = calloc(1, sizeof(VkCommandBuffer) * gRenderer->swapchainImageCount);
     gRenderer->computeCommandBuffer = calloc(1, sizeof(VkCommandBuffer) * gRenderer->swapchainImageCount);
+    gRenderer->uploadCommandBuffer = calloc(1, sizeof(VkCommandBuffer) * gRenderer->swapchainImageCount);
 
     if (gRenderer->imageAvailableSemaphores != NULL && gRenderer->renderFinishedSemaphores != NULL
-		&& gRenderer->inFlightFences != NULL && gRenderer->imagesInFlight != NULL) {
+		&& gRenderer->inFlightFences != NULL && gRenderer->imagesInFlight != NULL && gRenderer->uploadSemaphores != NULL) {
 		for (i = 0; i < VK2D_MAX_FRAMES_IN_FLIGHT; i++) {
 			VkResult r1 = vkCreateSemaphore(gRenderer->ld->dev, &semaphoreCreateInfo, VK_NULL_HANDLE, &gRenderer->imageAvailableSemaphores[i]);
 			VkResult r2 = vkCreateSemaphore(gRenderer->ld->dev, &semaphoreCreateInfo, VK_NULL_HANDLE, &gRenderer->renderFinishedSemaphores[i]);
 			VkResult r3 = vkCreateFence(gRenderer->ld->dev, &fenceCreateInfo, VK_NULL_HANDLE, &gRenderer->inFlightFences[i]);
 			if (r1 != VK_SUCCESS || r2 != VK_SUCCESS || r3 != VK_SUCCESS)
 			    vk2dRaise(VK2D_STATUS_VULKAN_ERROR, "Failed to create synchronization objects, Vulkan error %i/%i/%i.", r1, r2, r3);
+			if (gRenderer->limits.supportsTransferQueue) {
+				VkResult r4 = vkCreateSemaphore(gRenderer->ld->dev, &semaphoreCreateInfo, VK_NULL_HANDLE, &gRenderer->uploadSemaphores[i]);
+				if (r4 != VK_SUCCESS)
+					vk2dRaise(VK2D_STATUS_VULKAN_ERROR, "Failed to create upload semaphore, Vulkan error %i.", r4);
+			}
 		}
 	} else {
 	    vk2dRaise(VK2D_STATUS_OUT_OF_RAM, "Failed to allocate synchronization objects.");
 	}
 
-	if (gRenderer->commandBuffer != NULL && gRenderer->dbCommandBuffer != NULL) {
+	if (gRenderer->commandBuffer != NULL && gRenderer->dbCommandBuffer != NULL && gRenderer->computeCommandBuffer != NULL && gRenderer->uploadCommandBuffer != NULL) {
 		for (i = 0; i < gRenderer->swapchainImageCount; i++) {
 			gRenderer->commandBuffer[i] = vk2dLogicalDeviceGetCommandBuffer(gRenderer->ld, true);
             gRenderer->dbCommandBuffer[i] = vk2dLogicalDeviceGetCommandBuffer(gRenderer->ld, true);
             gRenderer->computeCommandBuffer[i] = vk2dLogicalDeviceGetCommandBuffer(gRenderer->ld, true);
+            if (gRenderer->limits.supportsTransferQueue)
+                gRenderer->uploadCommandBuffer[i] = vk2dLogicalDeviceGetTransferCommandBuffer(gRenderer->ld);
         }
 	} else {
         vk2dRaise(VK2D_STATUS_OUT_OF_RAM, "Failed to allocate synchronization objects.");
@@ -1297,15 +1536,19 @@ void _vk2dRendererDestroySynchronization() {
             vkDestroySemaphore(gRenderer->ld->dev, gRenderer->renderFinishedSemaphores[i], VK_NULL_HANDLE);
             vkDestroySemaphore(gRenderer->ld->dev, gRenderer->imageAvailableSemaphores[i], VK_NULL_HANDLE);
             vkDestroyFence(gRenderer->ld->dev, gRenderer->inFlightFences[i], VK_NULL_HANDLE);
+            if (gRenderer->uploadSemaphores != NULL && gRenderer->uploadSemaphores[i] != VK_NULL_HANDLE)
+                vkDestroySemaphore(gRenderer->ld->dev, gRenderer->uploadSemaphores[i], VK_NULL_HANDLE);
         }
     }
 	free(gRenderer->imagesInFlight);
+	free(gRenderer->uploadSemaphores);
 	free(gRenderer->inFlightFences);
 	free(gRenderer->imageAvailableSemaphores);
 	free(gRenderer->renderFinishedSemaphores);
     free(gRenderer->commandBuffer);
     free(gRenderer->dbCommandBuffer);
     free(gRenderer->computeCommandBuffer);
+    free(gRenderer->uploadCommandBuffer);
 }
 
 void _vk2dRendererCreateSampler() {
@@ -1431,6 +1674,52 @@ void _vk2dRendererDestroyTargetsList() {
 	free(gRenderer->targets);
 }
 
+// Rebuilds only what depends on the window size, returning false if the config or surface format changed something the
+// render pass needs, in which case whatever this tore down is left for the full rebuild to recreate
+static bool _vk2dRendererResizeInPlace(uint64_t startTime) {
+	VK2DRenderer gRenderer = vk2dRendererGetPointer();
+	if (gRenderer->newConfig.msaa != gRenderer->config.msaa || gRenderer->newConfig.filterMode != gRenderer->config.filterMode)
+		return false;
+	const uint32_t imageCount = gRenderer->swapchainImageCount;
+	const VkSurfaceFormatKHR surfaceFormat = gRenderer->surfaceFormat;
+
+	// Render pass, pipelines, descriptors, samplers and render targets don't care about the size
+	_vk2dRendererDestroyFrameBuffer();
+	_vk2dRendererDestroyDepthBuffer();
+	_vk2dRendererDestroyColourResources();
+	_vk2dRendererDestroySwapchain();
+
+	// Screen mode is the only other thing that can change and only the swapchain uses it
+	gRenderer->config = gRenderer->newConfig;
+
+	_vk2dRendererGetSurfaceSize();
+	_vk2dRendererCreateSwapchain();
+
+	// The render pass, pipelines and render target framebuffers are all built against the surface format
+	if (gRenderer->surfaceFormat.format != surfaceFormat.format || gRenderer->surfaceFormat.colorSpace != surfaceFormat.colorSpace) {
+		_vk2dRendererDestroySwapchain();
+		vk2dLog("Surface format changed, recreating all swapchain assets...");
+		return false;
+	}
+
+	_vk2dRendererCreateColourResources();
+	_vk2dRendererCreateDepthBuffer();
+	_vk2dRendererCreateFrameBuffer();
+	_vk2dRendererFitDefaultCamera();
+
+	// Per-image command buffers only need to be remade if the driver gave us a different number of images
+	if (gRenderer->swapchainImageCount != imageCount) {
+		_vk2dRendererDestroySynchronization();
+		_vk2dRendererCreateSynchronization();
+	} else {
+		memset(gRenderer->imagesInFlight, 0, sizeof(VkFence) * imageCount);
+	}
+
+	if (!vk2dStatusFatal())
+		vk2dLog("Resized swapchain assets in %.2fms...", ((double)(SDL_GetPerformanceCounter() - startTime) / (double)SDL_GetPerformanceFrequency()) * 1000);
+	return true;
+}
+
 // If the window is resized or minimized or whatever
 void _vk2dRendererResetSwapchain() {
 	VK2DRenderer gRenderer = vk2dRendererGetPointer();
@@ -1444,6 +1733,7 @@ void _vk2dRendererResetSwapchain() {
 		flags = SDL_GetWindowFlags(gRenderer->window);
 		SDL_PumpEvents();
 	}
+	const uint64_t startTime = SDL_GetPerformanceCounter();
 	VkResult result = vkDeviceWaitIdle(gRenderer->ld->dev);
     if (result == VK_ERROR_OUT_OF_HOST_MEMORY) {
         vk2dRaise(VK2D_STATUS_OUT_OF_RAM,"Out of memory.");
@@ -1456,6 +1746,10 @@ void _vk2dRendererResetSwapchain() {
         return;
     }
 
+	// Only size-dependent assets need rebuilding if MSAA, filtering and the surface format didn't change
+	if (_vk2dRendererResizeInPlace(startTime))
+		return;
+
 	// Free swapchain
 	_vk2dRendererDestroySynchronization();
 	_vk2dRendererDestroySampler();
@@ -1488,7 +1782,7 @@ void _vk2dRendererResetSwapchain() {
 	_vk2dRendererCreateSynchronization();
 
 	if (!vk2dStatusFatal())
-        vk2dLog("Recreated swapchain assets...");
+        vk2dLog("Recreated swapchain assets in %.2fms...", ((double)(SDL_GetPerformanceCounter() - startTime) / (double)SDL_GetPerformanceFrequency()) * 1000);
 }
 
 void _vk2dRendererResetSwapchainWX() {
@@ -1496,6 +1790,7 @@ void _vk2dRendererResetSwapchainWX() {
     if (vk2dStatusFatal())
         return;
 
+    const uint64_t startTime = SDL_GetPerformanceCounter();
     VkResult result = vkDeviceWaitIdle(gRenderer->ld->dev);
     if (result == VK_ERROR_OUT_OF_HOST_MEMORY) {
         vk2dRaise(VK2D_STATUS_OUT_OF_RAM,"Out of memory.");
@@ -1508,6 +1803,10 @@ void _vk2dRendererResetSwapchainWX() {
         return;
     }
 
+    // Only size-dependent assets need rebuilding if MSAA, filtering and the surface format didn't change
+    if (_vk2dRendererResizeInPlace(startTime))
+        return;
+
     // Free swapchain
     _vk2dRendererDestroySynchronization();
     _vk2dRendererDestroySampler();
@@ -1540,41 +1839,43 @@ void _vk2dRendererResetSwapchainWX() {
     _vk2dRendererCreateSynchronization();
 
     if (!vk2dStatusFatal())
-        vk2dLog("Recreated swapchain assets...");
+        vk2dLog("Recreated swapchain assets in %.2fms...", ((double)(SDL_GetPerformanceCounter() - startTime) / (double)SDL_GetPerformanceFrequency()) * 1000);
 }
 
-void _vk2dRendererDrawRaw(VkDescriptorSet *sets, uint32_t setCount, VK2DPolygon poly, VK2DPipeline pipe, float x, float y, float xscale, float yscale, float rot, float originX, float originY, float lineWidth, float xInTex, float yInTex, float texWidth, float texHeight, VK2DCameraIndex cam) {
-    VK2DRenderer gRenderer = vk2dRendererGetPointer();
-    if (vk2dStatusFatal())
-        return;
-    VkCommandBuffer buf = gRenderer->commandBuffer[gRenderer->scImageIndex];
-
+void _vk2dRendererGetModelMatrix(mat4 model, float x, float y, float xscale, float yscale, float rot, float originX, float originY) {
     // Account for various coordinate-based qualms
     originX *= -xscale;
     originY *= yscale;
-    //originX -= xInTex;
-    //originY -= yInTex;
 
-    // Push constants
-    VK2DPushBuffer push = {0};
-    identityMatrix(push.model);
+    identityMatrix(model);
     // Only do rotation matrices if a rotation is specified for optimization purposes
     if (rot != 0) {
         vec3 axis = {0, 0, 1};
         vec3 origin = {-originX + x, originY + y, 0};
         vec3 originTranslation = {originX, -originY, 0};
-        translateMatrix(push.model, origin);
-        rotateMatrix(push.model, axis, rot);
-        translateMatrix(push.model, originTranslation);
+        translateMatrix(model, origin);
+        rotateMatrix(model, axis, rot);
+        translateMatrix(model, originTranslation);
     } else {
         vec3 origin = {x, y, 0};
-        translateMatrix(push.model, origin);
+        translateMatrix(model, origin);
     }
     // Only scale matrix if specified for optimization purposes
     if (xscale != 1 || yscale != 1) {
         vec3 scale = {xscale, yscale, 1};
-        scaleMatrix(push.model, scale);
+        scaleMatrix(model, scale);
     }
+}
+
+void _vk2dRendererDrawRaw(VkDescriptorSet *sets, uint32_t setCount, VK2DPolygon poly, VK2DPipeline pipe, float x, float y, float xscale, float yscale, float rot, float originX, float originY, float lineWidth, float xInTex, float yInTex, float texWidth, float texHeight, VK2DCameraIndex cam) {
+    VK2DRenderer gRenderer = vk2dRendererGetPointer();
+    if (vk2dStatusFatal())
+        return;
+    VkCommandBuffer buf = gRenderer->commandBuffer[gRenderer->scImageIndex];
+
+    // Push constants
+    VK2DPushBuffer push = {0};
+    _vk2dRendererGetModelMatrix(push.model, x, y, xscale, yscale, rot, originX, originY);
     push.colourMod[0] = gRenderer->colourBlend[0];
     push.colourMod[1] = gRenderer->colourBlend[1];
     push.colourMod[2] = gRenderer->colourBlend[2];
@@ -1588,7 +1889,8 @@ void _vk2dRendererDrawRaw(VkDescriptorSet *sets, uint32_t setCount, VK2DPolygon
         gRenderer->prevPipe = vk2dPipelineGetPipe(pipe, gRenderer->blendMode);
     }
     if (gRenderer->prevSetHash != hash) {
-        vkCmdBindDescriptorSets(buf, VK_PIPELINE_BIND_POINT_GRAPHICS, pipe->layout, 0, setCount, sets, 0, VK_NULL_HANDLE);
+        const uint32_t uboOffset = _vk2dRendererGetUBOOffset(sets[0]);
+        vkCmdBindDescriptorSets(buf, VK_PIPELINE_BIND_POINT_GRAPHICS, pipe->layout, 0, setCount, sets, 1, &uboOffset);
         gRenderer->prevSetHash = hash;
     }
     if (poly != NULL && gRenderer->prevVBO != poly->vertices->buf) {
@@ -1687,7 +1989,8 @@ void _vk2dRendererDrawRawShader(VkDescriptorSet *sets, uint32_t setCount, VK2DTe
         gRenderer->prevPipe = vk2dPipelineGetPipe(pipe, gRenderer->blendMode);
     }
     if (gRenderer->prevSetHash != hash) {
-        vkCmdBindDescriptorSets(buf, VK_PIPELINE_BIND_POINT_GRAPHICS, pipe->layout, 0, setCount, sets, 0, VK_NULL_HANDLE);
+        const uint32_t uboOffset = _vk2dRendererGetUBOOffset(sets[0]);
+        vkCmdBindDescriptorSets(buf, VK_PIPELINE_BIND_POINT_GRAPHICS, pipe->layout, 0, setCount, sets, 1, &uboOffset);
         gRenderer->prevSetHash = hash;
     }
 
@@ -1755,7 +2058,8 @@ void _vk2dRendererDrawRawShadows(VkDescriptorSet set, VK2DShadowEnvironment shad
     VkDeviceSize offsets = shadowEnvironment->vbo->offset;
     vkCmdBindVertexBuffers(buf, 0, 1, &shadowEnvironment->vbo->buf, &offsets);
     gRenderer->prevVBO = NULL;
-    vkCmdBindDescriptorSets(buf, VK_PIPELINE_BIND_POINT_GRAPHICS, gRenderer->shadowsPipe->layout, 0, 1, &set, 0, VK_NULL_HANDLE);
+    const uint32_t uboOffset = _vk2dRendererGetUBOOffset(set);
+    vkCmdBindDescriptorSets(buf, VK_PIPELINE_BIND_POINT_GRAPHICS, gRenderer->shadowsPipe->layout, 0, 1, &set, 1, &uboOffset);
 
     // Dynamic state that can't be optimized further and the draw call
     cam = cam == VK2D_INVALID_CAMERA ? VK2D_DEFAULT_CAMERA : cam; // Account for invalid camera
@@ -1799,7 +2103,8 @@ void _vk2dRendererDrawRawInstanced(VkDescriptorSet *sets, uint32_t setCount, VK2
 	// We don't do any binding saving for instanced drawing
 	_vk2dRendererResetBoundPointers();
 	vkCmdBindPipeline(buf, VK_PIPELINE_BIND_POINT_GRAPHICS, vk2dPipelineGetPipe(gRenderer->instancedPipe, gRenderer->blendMode));
-	vkCmdBindDescriptorSets(buf, VK_PIPELINE_BIND_POINT_GRAPHICS, gRenderer->instancedPipe->layout, 0, setCount, sets, 0, VK_NULL_HANDLE);
+	const uint32_t uboOffset = _vk2dRendererGetUBOOffset(sets[0]);
+	vkCmdBindDescriptorSets(buf, VK_PIPELINE_BIND_POINT_GRAPHICS, gRenderer->instancedPipe->layout, 0, setCount, sets, 1, &uboOffset);
 
 	// Dynamic state that can't be optimized further and the draw call
 	cam = cam == VK2D_INVALID_CAMERA ? VK2D_DEFAULT_CAMERA : cam; // Account for invalid camera
@@ -1879,7 +2184,8 @@ void _vk2dRendererDrawRaw3D(VkDescriptorSet *sets, uint32_t setCount, VK2DModel
 		gRenderer->prevPipe = vk2dPipelineGetPipe(pipe, gRenderer->blendMode);
 	}
 	if (gRenderer->prevSetHash != hash) {
-		vkCmdBindDescriptorSets(buf, VK_PIPELINE_BIND_POINT_GRAPHICS, pipe->layout, 0, setCount, sets, 0, VK_NULL_HANDLE);
+		const uint32_t uboOffset = _vk2dRendererGetUBOOffset(sets[0]);
+		vkCmdBindDescriptorSets(buf, VK_PIPELINE_BIND_POINT_GRAPHICS, pipe->layout, 0, setCount, sets, 1, &uboOffset);
 		gRenderer->prevSetHash = hash;
 	}
 	VkDeviceSize offsets[] = {model->vertexOffset};
@@ -2002,30 +2308,86 @@ void _vk2dRendererDrawShadows(VK2DShadowEnvironment shadowEnvironment, vec4 colo
     }
 }
 
-static void _vk2dRendererAddDrawCommandInternal(VK2DDrawCommand *command) {
+// Opens a batch region in the current frame's descriptor buffer that draw commands are written to directly
+static bool _vk2dRendererOpenBatchRegion() {
     VK2DRenderer gRenderer = vk2dRendererGetPointer();
-    memcpy(&gRenderer->drawCommands[gRenderer->drawCommandCount++], command, sizeof(struct VK2DDrawCommand));
+    const uint64_t minimum = gRenderer->limits.maxInstancedDraws < VK2D_MINIMUM_BATCH_REGION ? gRenderer->limits.maxInstancedDraws : VK2D_MINIMUM_BATCH_REGION;
+    VkDeviceSize size;
+    gRenderer->drawCommands = vk2dDescriptorBufferBeginRegion(
+            gRenderer->descriptorBuffers[gRenderer->currentFrame],
+            minimum * sizeof(struct VK2DDrawCommand),
+            gRenderer->limits.maxInstancedDraws * sizeof(struct VK2DDrawCommand),
+            &size,
+            &gRenderer->drawCommandsBuffer,
+            &gRenderer->drawCommandsOffset
+    );
+    gRenderer->drawCommandCapacity = size / sizeof(struct VK2DDrawCommand);
+    return gRenderer->drawCommands != NULL;
 }
 
-void _vk2dRendererAddDrawCommand(VK2DDrawCommand *command) {
+VK2DDrawCommand *_vk2dRendererAddDrawCommand() {
     VK2DRenderer gRenderer = vk2dRendererGetPointer();
     if (vk2dStatusFatal())
-        return;
-    _vk2dRendererAddDrawCommandInternal(command);
+        return NULL;
+    if (gRenderer->drawCommands == NULL && !_vk2dRendererOpenBatchRegion())
+        return NULL;
+    return &gRenderer->drawCommands[gRenderer->drawCommandCount++];
 }
 
 void _vk2dRendererResetBatch() {
     VK2DRenderer gRenderer = vk2dRendererGetPointer();
     gRenderer->currentBatchPipeline = NULL;
     gRenderer->currentBatchPipelineID = VK2D_PIPELINE_ID_NONE;
+    gRenderer->drawCommands = NULL;
     gRenderer->drawCommandCount = 0;
+    gRenderer->drawCommandCapacity = 0;
+    gRenderer->drawQueueCount = 0;
+    gRenderer->drawQueueFlushing = false;
+    gRenderer->drawQueueDataSize = 0;
+    gRenderer->batchShaderDataSize = 0;
+    gRenderer->shapeInstanceCount = 0;
+    gRenderer->shapeRunCount = 0;
+    gRenderer->geometryDataSize = 0;
+}
+
+void *_vk2dRendererAppendData(uint8_t **buffer, VkDeviceSize *size, VkDeviceSize *capacity, const void *data, VkDeviceSize dataSize) {
+    if (*size + dataSize > *capacity) {
+        VkDeviceSize newCapacity = *capacity == 0 ? 1024 : *capacity;
+        while (newCapacity < *size + dataSize)
+            newCapacity *= 2;
+        uint8_t *newBuffer = realloc(*buffer, newCapacity);
+        if (newBuffer == NULL) {
+            vk2dRaise(VK2D_STATUS_OUT_OF_RAM, "Failed to extend data buffer to %i bytes.", (int)newCapacity);
+            return NULL;
+        }
+        *buffer = newBuffer;
+        *capacity = newCapacity;
+    }
+    void *out = *buffer + *size;
+    if (data != NULL)
+        memcpy(out, data, dataSize);
+    *size += dataSize;
+    return out;
 }
 
 void _vk2dRendererFlushBatchIfNeeded(VK2DPipeline pipe) {
     VK2DRenderer gRenderer = vk2dRendererGetPointer();
-    if (vk2dPipelineGetID(pipe, gRenderer->blendMode) != gRenderer->currentBatchPipelineID || gRenderer->drawCommandCount >= gRenderer->limits.maxInstancedDraws) {
+    if (vk2dPipelineGetID(pipe, gRenderer->blendMode) != gRenderer->currentBatchPipelineID || (gRenderer->drawCommands != NULL && gRenderer->drawCommandCount >= gRenderer->drawCommandCapacity)) {
         vk2dRendererFlushSpriteBatch();
-        gRenderer->currentBatchPipelineID = vk2dPipelineGetID(pipe, 0);
+        gRenderer->currentBatchPipelineID = vk2dPipelineGetID(pipe, gRenderer->blendMode);
         gRenderer->currentBatchPipeline = pipe;
     }
 }
+
+void _vk2dRendererBindTransientSet(VkCommandBuffer buf, VkPipelineBindPoint bindPoint, VkPipelineLayout layout, uint32_t set, VK2DDescCon descCon, VkWriteDescriptorSet *write) {
+    VK2DRenderer gRenderer = vk2dRendererGetPointer();
+    if (gRenderer->limits.supportsPushDescriptors) {
+        write->dstSet = VK_NULL_HANDLE;
+        gRenderer->ld->cmdPushDescriptorSet(buf, bindPoint, layout, set, 1, write);
+    } else {
+        VkDescriptorSet descriptorSet = vk2dDescConGetSet(descCon);
+        write->dstSet = descriptorSet;
+        vkUpdateDescriptorSets(gRenderer->ld->dev, 1, write, 0, VK_NULL_HANDLE);
+        vkCmdBindDescriptorSets(buf, bindPoint, layout, set, 1, &descriptorSet, 0, VK_NULL_HANDLE);
+    }
+}
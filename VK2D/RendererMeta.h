@@ -22,9 +22,15 @@ void _vk2dTransitionImageLayout(VkImage img, VkImageLayout old, VkImageLayout ne
 // Rebuilds the matrices for a given buffer and camera
 void _vk2dCameraUpdateUBO(VK2DUniformBufferObject *ubo, VK2DCameraSpec *camera, int index);
 
+// Finds the world-space bounding box (min x, min y, max x, max y) a 2D camera can see
+void _vk2dCameraGetView(vec4 view, VK2DCameraSpec *camera);
+
 // Flushes the data from a ubo to its respective buffer, frame being the swapchain buffer to flush
 void _vk2dRendererFlushUBOBuffers();
 
+// Gets the dynamic offset a view-projection set (set 0) has to be bound with, render targets' own sets use 0
+uint32_t _vk2dRendererGetUBOOffset(VkDescriptorSet set);
+
 // Grabs a preferred present mode if available returning FIFO if its unavailable
 VkPresentModeKHR _vk2dRendererGetPresentMode(VkPresentModeKHR mode);
 
@@ -62,8 +68,12 @@ void _vk2dRendererCreateRenderPass();
 void _vk2dRendererDestroyRenderPass();
 void _vk2dRendererCreateDescriptorSetLayouts();
 void _vk2dRendererDestroyDescriptorSetLayout();
+void _vk2dRendererCreatePipelineCache();
+void _vk2dRendererDestroyPipelineCache();
 void _vk2dRendererCreatePipelines();
 void _vk2dRendererDestroyPipelines(bool preserveCustomPipes);
+void _vk2dRendererStartPipelinePrecompile();
+void _vk2dRendererStopPipelinePrecompile();
 void _vk2dRendererCreateFrameBuffer();
 void _vk2dRendererDestroyFrameBuffer();
 void _vk2dRendererCreateUniformBuffers(bool newCamera);
@@ -85,15 +95,26 @@ void _vk2dRendererResetSwapchainWX();
 
 /****************************** Back-end Drawing ******************************/
 
-// Adds a copy of a given draw command for each active camera
-void _vk2dRendererAddDrawCommand(VK2DDrawCommand *command);
+// Returns the next draw command slot in the current batch for the caller to fill in, or NULL on failure
+VK2DDrawCommand *_vk2dRendererAddDrawCommand();
 
 // Resets current batch information
 void _vk2dRendererResetBatch();
 
+// Appends data to a growable byte buffer, returning where it was copied to or NULL if the buffer couldn't grow. If
+// data is NULL the space is reserved but left for the caller to fill.
+void *_vk2dRendererAppendData(uint8_t **buffer, VkDeviceSize *size, VkDeviceSize *capacity, const void *data, VkDeviceSize dataSize);
+
 // Flushes the current batch if its necessary, pipe is the pipeline of the current draw command
 void _vk2dRendererFlushBatchIfNeeded(VK2DPipeline pipe);
 
+// Binds a set that only lives for one draw at index set of layout, described by write. The set is pushed straight into
+// buf if push descriptors are supported, otherwise it is allocated from descCon, written, and bound.
+void _vk2dRendererBindTransientSet(VkCommandBuffer buf, VkPipelineBindPoint bindPoint, VkPipelineLayout layout, uint32_t set, VK2DDescCon descCon, VkWriteDescriptorSet *write);
+
+// Builds the model matrix polygons are drawn with
+void _vk2dRendererGetModelMatrix(mat4 model, float x, float y, float xscale, float yscale, float rot, float originX, float originY);
+
 void _vk2dRendererDrawRaw(VkDescriptorSet *sets, uint32_t setCount, VK2DPolygon poly, VK2DPipeline pipe, float x, float y, float xscale, float yscale, float rot, float originX, float originY, float lineWidth, float xInTex, float yInTex, float texWidth, float texHeight, VK2DCameraIndex cam);
 void _vk2dRendererDrawRawShader(VkDescriptorSet *sets, uint32_t setCount, VK2DTexture tex, VK2DPipeline pipe, float x, float y, float xscale, float yscale, float rot, float originX, float originY, float lineWidth, float xInTex, float yInTex, float texWidth, float texHeight, VK2DCameraIndex cam);
 void _vk2dRendererDrawRawShadows(VkDescriptorSet set, VK2DShadowEnvironment shadowEnvironment, VK2DShadowObject object, vec4 colour, vec2 lightSource, VK2DCameraIndex cam);
@@ -29,6 +29,27 @@ void _vk2dShaderBuildPipe(VK2DShader shader) {
     if (vk2dStatusFatal())
         return;
 	VK2DRenderer renderer = vk2dRendererGetPointer();
+	if (shader->instanced) {
+		// Same layout as the built-in instanced pipeline so it can be drawn by the sprite batch
+		VkPipelineVertexInputStateCreateInfo instanceVertexInfo = _vk2dGetInstanceVertexInputState();
+		VkDescriptorSetLayout instancedLayout[] = {renderer->dslBufferVP, renderer->dslSampler, renderer->dslTextureArray, renderer->dslBufferSBO};
+		shader->pipe = vk2dPipelineCreate(
+				renderer->ld,
+				renderer->renderPass,
+				renderer->surfaceWidth,
+				renderer->surfaceHeight,
+				shader->spvVert,
+				shader->spvVertSize,
+				shader->spvFrag,
+				shader->spvFragSize,
+				instancedLayout,
+				4,
+				&instanceVertexInfo,
+				true,
+				renderer->config.msaa,
+				VK2D_PIPELINE_TYPE_INSTANCING);
+		return;
+	}
 	VkPipelineVertexInputStateCreateInfo textureVertexInfo = _vk2dGetTextureVertexInputState();
 
 	VkDescriptorSetLayout layout[] = {renderer->dslBufferVP, renderer->dslSampler, renderer->dslTextureArray, renderer->dslBufferUser};
@@ -55,7 +76,7 @@ void _vk2dShaderBuildPipe(VK2DShader shader) {
             VK2D_PIPELINE_TYPE_USER_SHADER);
 }
 
-VK2DShader vk2dShaderFrom(uint8_t *vertexShaderBuffer, int vertexShaderBufferSize, uint8_t *fragmentShaderBuffer, int fragmentShaderBufferSize, uint32_t uniformBufferSize) {
+static VK2DShader _vk2dShaderFrom(uint8_t *vertexShaderBuffer, int vertexShaderBufferSize, uint8_t *fragmentShaderBuffer, int fragmentShaderBufferSize, uint32_t uniformBufferSize, bool instanced) {
 	VK2DRenderer gRenderer = vk2dRendererGetPointer();
 	if (vk2dStatusFatal() || gRenderer == NULL)
         return NULL;
@@ -92,17 +113,15 @@ VK2DShader vk2dShaderFrom(uint8_t *vertexShaderBuffer, int vertexShaderBufferSiz
         out->spvFragSize = fragmentShaderBufferSize;
         out->uniformSize = uniformBufferSize;
         out->dev = dev;
-
-        if (!gRenderer->limits.supportsMultiThreadLoading || SDL_TryLockMutex(dev->shaderMutex)) {
-            _vk2dRendererAddShader(out);
-            _vk2dShaderBuildPipe(out);
-            if (gRenderer->limits.supportsMultiThreadLoading)
-                SDL_UnlockMutex(dev->shaderMutex);
-        } else {
-            vk2dRaise(VK2D_STATUS_SDL_ERROR, "Failed to lock mutex, SDL error: %s.", SDL_GetError());
-            free(out);
-            out = NULL;
-        }
+        out->instanced = instanced;
+
+        // Several loader threads may be creating shaders at once
+        if (gRenderer->limits.supportsMultiThreadLoading)
+            SDL_LockMutex(dev->shaderMutex);
+        _vk2dRendererAddShader(out);
+        _vk2dShaderBuildPipe(out);
+        if (gRenderer->limits.supportsMultiThreadLoading)
+            SDL_UnlockMutex(dev->shaderMutex);
     } else {
         vk2dRaise(VK2D_STATUS_OUT_OF_RAM, "Failed to allocate shader.");
     }
@@ -110,7 +129,7 @@ VK2DShader vk2dShaderFrom(uint8_t *vertexShaderBuffer, int vertexShaderBufferSiz
 	return out;
 }
 
-VK2DShader vk2dShaderLoad(const char *vertexShader, const char *fragmentShader, uint32_t uniformBufferSize) {
+static VK2DShader _vk2dShaderLoad(const char *vertexShader, const char *fragmentShader, uint32_t uniformBufferSize, bool instanced) {
 	VK2DRenderer gRenderer = vk2dRendererGetPointer();
 	if (vk2dStatusFatal() || gRenderer == NULL)
         return NULL;
@@ -145,17 +164,15 @@ VK2DShader vk2dShaderLoad(const char *vertexShader, const char *fragmentShader,
 			out->spvFragSize = fragFileSize;
 			out->uniformSize = uniformBufferSize;
 			out->dev = dev;
+			out->instanced = instanced;
 
-            if (!gRenderer->limits.supportsMultiThreadLoading || SDL_TryLockMutex(dev->shaderMutex)) {
-                _vk2dRendererAddShader(out);
-                _vk2dShaderBuildPipe(out);
-                if (gRenderer->limits.supportsMultiThreadLoading)
-                    SDL_UnlockMutex(dev->shaderMutex);
-            } else {
-                vk2dRaise(VK2D_STATUS_SDL_ERROR, "Failed to lock mutex, SDL error: %s.", SDL_GetError());
-                free(out);
-                out = NULL;
-            }
+            // Several loader threads may be creating shaders at once
+            if (gRenderer->limits.supportsMultiThreadLoading)
+                SDL_LockMutex(dev->shaderMutex);
+            _vk2dRendererAddShader(out);
+            _vk2dShaderBuildPipe(out);
+            if (gRenderer->limits.supportsMultiThreadLoading)
+                SDL_UnlockMutex(dev->shaderMutex);
 		}
 	} else {
         vk2dRaise(VK2D_STATUS_OUT_OF_RAM, "Failed to allocate shader.");
@@ -164,6 +181,22 @@ VK2DShader vk2dShaderLoad(const char *vertexShader, const char *fragmentShader,
 	return out;
 }
 
+VK2DShader vk2dShaderLoad(const char *vertexShader, const char *fragmentShader, uint32_t uniformBufferSize) {
+	return _vk2dShaderLoad(vertexShader, fragmentShader, uniformBufferSize, false);
+}
+
+VK2DShader vk2dShaderFrom(uint8_t *vertexShaderBuffer, int vertexShaderBufferSize, uint8_t *fragmentShaderBuffer, int fragmentShaderBufferSize, uint32_t uniformBufferSize) {
+	return _vk2dShaderFrom(vertexShaderBuffer, vertexShaderBufferSize, fragmentShaderBuffer, fragmentShaderBufferSize, uniformBufferSize, false);
+}
+
+VK2DShader vk2dShaderLoadInstanced(const char *vertexShader, const char *fragmentShader, uint32_t uniformBufferSize) {
+	return _vk2dShaderLoad(vertexShader, fragmentShader, uniformBufferSize, true);
+}
+
+VK2DShader vk2dShaderFromInstanced(uint8_t *vertexShaderBuffer, int vertexShaderBufferSize, uint8_t *fragmentShaderBuffer, int fragmentShaderBufferSize, uint32_t uniformBufferSize) {
+	return _vk2dShaderFrom(vertexShaderBuffer, vertexShaderBufferSize, fragmentShaderBuffer, fragmentShaderBufferSize, uniformBufferSize, true);
+}
+
 void vk2dShaderFree(VK2DShader shader) {
 	uint32_t i;
 	if (vk2dRendererGetPointer() != NULL)
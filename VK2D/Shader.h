@@ -39,6 +39,33 @@ VK2DShader vk2dShaderLoad(const char *vertexShader, const char *fragmentShader,
 /// you specify a uniform buffer size of 0.
 VK2DShader vk2dShaderFrom(uint8_t *vertexShaderBuffer, int vertexShaderBufferSize, uint8_t *fragmentShaderBuffer, int fragmentShaderBufferSize, uint32_t uniformBufferSize);
 
+/// \brief Creates a shader that is drawn through the instanced sprite batch
+/// \param vertexShader File containing the compiled SPIR-V vertex shader
+/// \param fragmentShader File containing the compiled SPIR-V fragment shader
+/// \param uniformBufferSize Size of the data given to each vk2dRendererDrawShader call (0 is valid)
+/// \return Returns a new shader or NULL
+/// \warning uniformBufferSize must be a multiple of 4 and match the std430 array stride of the shader's data struct
+///
+/// Consecutive vk2dRendererDrawShader calls with an instanced shader are batched exactly like
+/// vk2dRendererDrawTexture, so thousands of draws become a single draw call. Instead of push constants
+/// and a uniform buffer, the vertex shader is set up like shaders/instanced.vert (or instancedcompact.vert/
+/// instancedcommands.vert if `compactInstances`/`computeFreeSprites` are enabled) and the data passed to
+/// each draw is found at `layout(std430, set = 3, binding = 5) readonly buffer` as an array indexed by the
+/// instance. Pass the instance index to the fragment shader as a flat varying if it needs the data too.
+VK2DShader vk2dShaderLoadInstanced(const char *vertexShader, const char *fragmentShader, uint32_t uniformBufferSize);
+
+/// \brief Creates a shader that is drawn through the instanced sprite batch from an in-memory buffer
+/// \param vertexShaderBuffer Buffer containing compiled SPIR-V shader code
+/// \param vertexShaderBufferSize Size of the vertexShaderBuffer buffer in bytes
+/// \param fragmentShaderBuffer File containing the compiled SPIR-V fragment shader
+/// \param fragmentShaderBufferSize Size of the fragmentShaderBuffer buffer in bytes
+/// \param uniformBufferSize Size of the data given to each vk2dRendererDrawShader call (0 is valid)
+/// \return Returns a new shader or NULL
+/// \warning uniformBufferSize must be a multiple of 4 and match the std430 array stride of the shader's data struct
+///
+/// See vk2dShaderLoadInstanced for how the shaders should be set up.
+VK2DShader vk2dShaderFromInstanced(uint8_t *vertexShaderBuffer, int vertexShaderBufferSize, uint8_t *fragmentShaderBuffer, int fragmentShaderBufferSize, uint32_t uniformBufferSize);
+
 /// \brief Frees a shader from memory
 /// \param shader Shader to free
 void vk2dShaderFree(VK2DShader shader);
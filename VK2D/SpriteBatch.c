@@ -0,0 +1,302 @@
+/// \file SpriteBatch.c
+/// \author Paolo Mazzon
+#include "VK2D/SpriteBatch.h"
+#include "VK2D/Validation.h"
+#include "VK2D/Buffer.h"
+#include "VK2D/Constants.h"
+#include "VK2D/Renderer.h"
+#include "VK2D/RendererMeta.h"
+#include "VK2D/DescriptorControl.h"
+#include "VK2D/PhysicalDevice.h"
+#include "VK2D/Opaque.h"
+
+#include <string.h>
+#ifndef __APPLE__
+#include <malloc.h>
+#else
+#include <sys/cdefs.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <malloc/_malloc.h>
+#include <malloc/malloc.h>
+#include <memory.h>
+#endif
+
+// Marks a slot as needing to be uploaded to the GPU
+static void _vk2dSpriteBatchMarkDirty(VK2DSpriteBatch batch, uint32_t slot) {
+    if (batch->dirtyStart == batch->dirtyEnd) {
+        batch->dirtyStart = slot;
+        batch->dirtyEnd = slot + 1;
+    } else {
+        if (slot < batch->dirtyStart)
+            batch->dirtyStart = slot;
+        if (slot + 1 > batch->dirtyEnd)
+            batch->dirtyEnd = slot + 1;
+    }
+}
+
+VK2DSpriteBatch vk2dSpriteBatchCreate(uint32_t capacity) {
+    VK2DRenderer gRenderer = vk2dRendererGetPointer();
+    if (vk2dStatusFatal() || gRenderer == NULL)
+        return NULL;
+    if (capacity == 0) {
+        vk2dRaise(VK2D_STATUS_BEYOND_LIMIT, "Sprite batch capacity must be greater than 0.");
+        return NULL;
+    }
+
+    VK2DSpriteBatch batch = calloc(1, sizeof(struct VK2DSpriteBatch_t));
+    if (batch == NULL) {
+        vk2dRaise(VK2D_STATUS_OUT_OF_RAM, "Failed to allocate sprite batch.");
+        return NULL;
+    }
+
+    VK2DLogicalDevice dev = vk2dRendererGetDevice();
+    batch->capacity = capacity;
+    batch->commands = malloc(sizeof(struct VK2DDrawCommand) * capacity);
+    batch->slotToSprite = malloc(sizeof(VK2DSprite) * capacity);
+    batch->spriteToSlot = malloc(sizeof(int32_t) * capacity);
+    batch->freeSprites = malloc(sizeof(VK2DSprite) * capacity);
+    if (batch->commands == NULL || batch->slotToSprite == NULL || batch->spriteToSlot == NULL || batch->freeSprites == NULL) {
+        vk2dRaise(VK2D_STATUS_OUT_OF_RAM, "Failed to allocate sprite batch of capacity %i.", capacity);
+        vk2dSpriteBatchFree(batch);
+        return NULL;
+    }
+    vk2dSpriteBatchClear(batch);
+
+    // GPU side
+    batch->commandBuffer = vk2dBufferCreate(
+            dev,
+            sizeof(struct VK2DDrawCommand) * capacity,
+            VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    if (!gRenderer->options.computeFreeSprites) {
+        batch->instanceBuffer = vk2dBufferCreate(
+                dev,
+                gRenderer->drawInstanceSize * capacity,
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    }
+    for (int i = 0; i < VK2D_MAX_FRAMES_IN_FLIGHT; i++) {
+        batch->stageBuffers[i] = vk2dBufferCreate(
+                dev,
+                sizeof(struct VK2DDrawCommand) * capacity,
+                VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        if (batch->stageBuffers[i] != NULL) {
+            VkResult result = vmaMapMemory(gRenderer->vma, batch->stageBuffers[i]->mem, &batch->stageData[i]);
+            if (result != VK_SUCCESS) {
+                vk2dRaise(VK2D_STATUS_VULKAN_ERROR, "Failed to map memory, VMA error %i.", result);
+                batch->stageData[i] = NULL;
+            }
+        }
+    }
+
+    if (vk2dStatusFatal() || batch->commandBuffer == NULL || (batch->instanceBuffer == NULL && !gRenderer->options.computeFreeSprites) || batch->stageData[0] == NULL || batch->stageData[VK2D_MAX_FRAMES_IN_FLIGHT - 1] == NULL) {
+        vk2dSpriteBatchFree(batch);
+        return NULL;
+    }
+
+    return batch;
+}
+
+void vk2dSpriteBatchFree(VK2DSpriteBatch batch) {
+    VK2DRenderer gRenderer = vk2dRendererGetPointer();
+    if (batch != NULL) {
+        if (gRenderer != NULL) {
+            vk2dRendererWait();
+            for (int i = 0; i < VK2D_MAX_FRAMES_IN_FLIGHT; i++) {
+                if (batch->stageData[i] != NULL)
+                    vmaUnmapMemory(gRenderer->vma, batch->stageBuffers[i]->mem);
+                vk2dBufferFree(batch->stageBuffers[i]);
+            }
+            vk2dBufferFree(batch->commandBuffer);
+            vk2dBufferFree(batch->instanceBuffer);
+        }
+        free(batch->commands);
+        free(batch->slotToSprite);
+        free(batch->spriteToSlot);
+        free(batch->freeSprites);
+        free(batch);
+    }
+}
+
+VK2DSprite vk2dSpriteBatchInsert(VK2DSpriteBatch batch, const VK2DDrawCommand *command) {
+    if (batch == NULL || command == NULL) {
+        vk2dRaise(VK2D_STATUS_BAD_ASSET, "Sprite batch or command does not exist.");
+        return VK2D_INVALID_SPRITE;
+    }
+    if (batch->freeCount == 0) {
+        vk2dRaise(VK2D_STATUS_BEYOND_LIMIT, "Sprite batch of capacity %i is full.", batch->capacity);
+        return VK2D_INVALID_SPRITE;
+    }
+
+    // Sprites are always appended so the batch stays densely packed for the draw
+    const VK2DSprite sprite = batch->freeSprites[--batch->freeCount];
+    const uint32_t slot = batch->count++;
+    batch->spriteToSlot[sprite] = slot;
+    batch->slotToSprite[slot] = sprite;
+    memcpy(&batch->commands[slot], command, sizeof(struct VK2DDrawCommand));
+    _vk2dSpriteBatchMarkDirty(batch, slot);
+    return sprite;
+}
+
+void vk2dSpriteBatchUpdate(VK2DSpriteBatch batch, VK2DSprite sprite, const VK2DDrawCommand *command) {
+    if (batch == NULL || command == NULL || sprite < 0 || (uint32_t)sprite >= batch->capacity || batch->spriteToSlot[sprite] == -1) {
+        vk2dRaise(VK2D_STATUS_BAD_ASSET, "Sprite %i does not exist.", sprite);
+        return;
+    }
+
+    const uint32_t slot = batch->spriteToSlot[sprite];
+    memcpy(&batch->commands[slot], command, sizeof(struct VK2DDrawCommand));
+    _vk2dSpriteBatchMarkDirty(batch, slot);
+}
+
+void vk2dSpriteBatchRemove(VK2DSpriteBatch batch, VK2DSprite sprite) {
+    if (batch == NULL || sprite < 0 || (uint32_t)sprite >= batch->capacity || batch->spriteToSlot[sprite] == -1) {
+        vk2dRaise(VK2D_STATUS_BAD_ASSET, "Sprite %i does not exist.", sprite);
+        return;
+    }
+
+    // Move the last sprite into the hole so the batch stays densely packed
+    const uint32_t slot = batch->spriteToSlot[sprite];
+    const uint32_t last = batch->count - 1;
+    if (slot != last) {
+        const VK2DSprite moved = batch->slotToSprite[last];
+        memcpy(&batch->commands[slot], &batch->commands[last], sizeof(struct VK2DDrawCommand));
+        batch->slotToSprite[slot] = moved;
+        batch->spriteToSlot[moved] = slot;
+        _vk2dSpriteBatchMarkDirty(batch, slot);
+    }
+    batch->spriteToSlot[sprite] = -1;
+    batch->freeSprites[batch->freeCount++] = sprite;
+    batch->count--;
+
+    // Nothing past the end needs to go up anymore
+    if (batch->dirtyEnd > batch->count)
+        batch->dirtyEnd = batch->count;
+    if (batch->dirtyStart >= batch->dirtyEnd)
+        batch->dirtyStart = batch->dirtyEnd = 0;
+}
+
+void vk2dSpriteBatchClear(VK2DSpriteBatch batch) {
+    if (batch == NULL)
+        return;
+    batch->count = 0;
+    batch->dirtyStart = 0;
+    batch->dirtyEnd = 0;
+    batch->freeCount = batch->capacity;
+    for (uint32_t i = 0; i < batch->capacity; i++) {
+        // Handed out lowest first
+        batch->freeSprites[i] = batch->capacity - 1 - i;
+        batch->spriteToSlot[i] = -1;
+    }
+}
+
+uint32_t vk2dSpriteBatchCount(VK2DSpriteBatch batch) {
+    return batch != NULL ? batch->count : 0;
+}
+
+void _vk2dSpriteBatchSync(VK2DSpriteBatch batch, VkDescriptorBufferInfo *sboInfos) {
+    VK2DRenderer gRenderer = vk2dRendererGetPointer();
+
+    if (batch->dirtyStart < batch->dirtyEnd) {
+        VkCommandBuffer copyBuf = gRenderer->dbCommandBuffer[gRenderer->scImageIndex];
+        VkCommandBuffer computeBuf = gRenderer->computeCommandBuffer[gRenderer->scImageIndex];
+
+        // Both the command and instance offsets of the first slot must be properly aligned storage buffer offsets
+        const VkDeviceSize alignment = gRenderer->pd->props.limits.minStorageBufferOffsetAlignment;
+        uint32_t step = 1;
+        while ((step * sizeof(struct VK2DDrawCommand)) % alignment != 0 || (step * gRenderer->drawInstanceSize) % alignment != 0)
+            step++;
+        const uint32_t start = batch->dirtyStart - (batch->dirtyStart % step);
+        const uint32_t count = batch->dirtyEnd - start;
+        const VkDeviceSize commandOffset = start * sizeof(struct VK2DDrawCommand);
+        const VkDeviceSize commandSize = count * sizeof(struct VK2DDrawCommand);
+        const VkDeviceSize instanceOffset = start * gRenderer->drawInstanceSize;
+        const VkDeviceSize instanceSize = count * gRenderer->drawInstanceSize;
+
+        // Only the dirty range is staged, the fence for this frame guarantees the staging buffer is free
+        memcpy((uint8_t*)batch->stageData[gRenderer->currentFrame] + commandOffset, &batch->commands[start], commandSize);
+
+        // Previous frames may still be reading the batch so wait for them before overwriting anything
+        vkCmdPipelineBarrier(
+                copyBuf,
+                VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                0, 0, VK_NULL_HANDLE, 0, VK_NULL_HANDLE, 0, VK_NULL_HANDLE);
+        VkBufferCopy bufferCopy = {
+                .srcOffset = commandOffset,
+                .dstOffset = commandOffset,
+                .size = commandSize
+        };
+        vkCmdCopyBuffer(copyBuf, batch->stageBuffers[gRenderer->currentFrame]->buf, batch->commandBuffer->buf, 1, &bufferCopy);
+        VkBufferMemoryBarrier copyBarrier = {
+                .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+                .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+                .dstAccessMask = VK_ACCESS_SHADER_READ_BIT,
+                .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .buffer = batch->commandBuffer->buf,
+                .offset = commandOffset,
+                .size = commandSize
+        };
+
+        if (gRenderer->options.computeFreeSprites) {
+            // The vertex shader reads the commands directly so there is nothing to rebuild
+            vkCmdPipelineBarrier(copyBuf, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_VERTEX_SHADER_BIT, 0, 0, VK_NULL_HANDLE, 1, &copyBarrier, 0, VK_NULL_HANDLE);
+        } else {
+            vkCmdPipelineBarrier(copyBuf, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, VK_NULL_HANDLE, 1, &copyBarrier, 0, VK_NULL_HANDLE);
+
+            // Rebuild the instances for the dirty range, retained batches are not culled so the
+            // culling bindings just need something valid in them
+            VkDescriptorBufferInfo computeInfos[5];
+            computeInfos[0].buffer = batch->commandBuffer->buf;
+            computeInfos[0].offset = commandOffset;
+            computeInfos[0].range = commandSize;
+            computeInfos[1].buffer = batch->instanceBuffer->buf;
+            computeInfos[1].offset = instanceOffset;
+            computeInfos[1].range = instanceSize;
+            computeInfos[2] = computeInfos[0];
+            computeInfos[3] = computeInfos[1];
+            computeInfos[4] = computeInfos[1];
+            VkWriteDescriptorSet computeWrite = {
+                    .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                    .dstBinding = 0,
+                    .descriptorCount = 5,
+                    .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                    .pBufferInfo = computeInfos
+            };
+            VK2DComputePushBuffer push = { .drawCount = count, .viewCount = 0 };
+            vkCmdPushConstants(computeBuf, gRenderer->spriteBatchPipe->layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(VK2DComputePushBuffer), &push);
+            _vk2dRendererBindTransientSet(computeBuf, VK_PIPELINE_BIND_POINT_COMPUTE, gRenderer->spriteBatchPipe->layout, 0, gRenderer->descConCompute[gRenderer->currentFrame], &computeWrite);
+            vkCmdDispatch(computeBuf, (count / 64) + 1, 1, 1);
+            VkBufferMemoryBarrier computeBarrier = {
+                    .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+                    .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+                    .dstAccessMask = VK_ACCESS_SHADER_READ_BIT,
+                    .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                    .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                    .buffer = batch->instanceBuffer->buf,
+                    .offset = instanceOffset,
+                    .size = instanceSize
+            };
+            vkCmdPipelineBarrier(computeBuf, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_VERTEX_SHADER_BIT, 0, 0, VK_NULL_HANDLE, 1, &computeBarrier, 0, VK_NULL_HANDLE);
+        }
+
+        batch->dirtyStart = 0;
+        batch->dirtyEnd = 0;
+    }
+
+    // Buffers the instanced pipeline reads instances (or the commands themselves) from, the visible
+    // list binding is unused since retained batches are drawn without culling
+    sboInfos[0].offset = 0;
+    if (gRenderer->options.computeFreeSprites) {
+        sboInfos[0].buffer = batch->commandBuffer->buf;
+        sboInfos[0].range = batch->count * sizeof(struct VK2DDrawCommand);
+    } else {
+        sboInfos[0].buffer = batch->instanceBuffer->buf;
+        sboInfos[0].range = batch->count * gRenderer->drawInstanceSize;
+    }
+    sboInfos[1] = sboInfos[0];
+    sboInfos[2] = sboInfos[0];
+}
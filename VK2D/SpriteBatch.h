@@ -0,0 +1,54 @@
+/// \file SpriteBatch.h
+/// \author Paolo Mazzon
+/// \brief Retained sprite batches that live on the GPU across frames
+#pragma once
+#include "VK2D/Structs.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// \brief Creates a new, empty sprite batch that lives in device-local memory
+/// \param capacity Maximum number of sprites the batch may hold at once
+/// \return Returns a new sprite batch or NULL if it fails
+///
+/// Unlike vk2dRendererAddBatch, the draw commands in a sprite batch persist across frames
+/// and only the sprites that change between draws are uploaded to the GPU. This makes it
+/// ideal for large layers of sprites that rarely move. Changes made to a batch after it has
+/// been drawn in a frame apply to every draw of that batch in the frame.
+VK2DSpriteBatch vk2dSpriteBatchCreate(uint32_t capacity);
+
+/// \brief Frees a sprite batch, waiting for the GPU to be done with it first
+/// \param batch Sprite batch to free
+void vk2dSpriteBatchFree(VK2DSpriteBatch batch);
+
+/// \brief Inserts a sprite into a sprite batch
+/// \param batch Sprite batch to insert into
+/// \param command Draw command describing the sprite
+/// \return Returns a handle to the sprite, or VK2D_INVALID_SPRITE if the batch is full
+VK2DSprite vk2dSpriteBatchInsert(VK2DSpriteBatch batch, const VK2DDrawCommand *command);
+
+/// \brief Replaces the draw command of a sprite in a sprite batch
+/// \param batch Sprite batch the sprite belongs to
+/// \param sprite Handle returned by vk2dSpriteBatchInsert
+/// \param command New draw command for the sprite
+void vk2dSpriteBatchUpdate(VK2DSpriteBatch batch, VK2DSprite sprite, const VK2DDrawCommand *command);
+
+/// \brief Removes a sprite from a sprite batch, its handle may be reused by later inserts
+/// \param batch Sprite batch the sprite belongs to
+/// \param sprite Handle returned by vk2dSpriteBatchInsert
+void vk2dSpriteBatchRemove(VK2DSpriteBatch batch, VK2DSprite sprite);
+
+/// \brief Removes every sprite from a sprite batch
+/// \param batch Sprite batch to clear
+/// \warning This invalidates all handles previously got from vk2dSpriteBatchInsert
+void vk2dSpriteBatchClear(VK2DSpriteBatch batch);
+
+/// \brief Returns the number of sprites currently in a sprite batch
+/// \param batch Sprite batch to check
+/// \return Number of sprites in the batch
+uint32_t vk2dSpriteBatchCount(VK2DSpriteBatch batch);
+
+#ifdef __cplusplus
+}
+#endif
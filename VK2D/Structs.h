@@ -151,6 +151,12 @@ typedef enum {
 	VK2D_ASSET_TYPE_NONE = 2,    ///< This slot is empty
 } VK2DAssetState;
 
+/// \brief How a descriptor buffer's cursor moves on when the current page is full
+typedef enum {
+	VK2D_DESCRIPTOR_BUFFER_MODE_LINEAR = 0, ///< Always move on to the next page, whatever is left in the full page is wasted
+	VK2D_DESCRIPTOR_BUFFER_MODE_RING = 1,   ///< Look through the pages already in use this frame in order from the cursor, wrapping around, before moving on to a new page
+} VK2DDescriptorBufferMode;
+
 // VK2D pointers
 VK2D_OPAQUE_POINTER(VK2DRenderer)
 VK2D_OPAQUE_POINTER(VK2DImage)
@@ -165,6 +171,8 @@ VK2D_OPAQUE_POINTER(VK2DShader)
 VK2D_OPAQUE_POINTER(VK2DModel)
 VK2D_OPAQUE_POINTER(VK2DDescriptorBuffer)
 VK2D_OPAQUE_POINTER(VK2DShadowEnvironment)
+VK2D_OPAQUE_POINTER(VK2DSpriteBatch)
+VK2D_OPAQUE_POINTER(VK2DUploadBatch)
 
 /// \brief 2D vector of floats
 typedef float vec2[2];
@@ -184,6 +192,12 @@ typedef int32_t VK2DShadowObject;
 /// \brief Type used for referencing cameras
 typedef int32_t VK2DCameraIndex;
 
+/// \brief Type used for referencing groups of assets queued with vk2dAssetsQueue
+typedef int32_t VK2DAssetGroup;
+
+/// \brief Type used for referencing sprites in a sprite batch
+typedef int32_t VK2DSprite;
+
 /// \brief Vertex data for rendering shapes
 struct VK2DVertexColour {
 	vec3 pos;    ///< Position of this vertex
@@ -255,9 +269,55 @@ struct VK2DStartupOptions {
 	/// Determines the size of a video-memory page in bytes. This can cap the max uniform
 	/// buffer size for shaders, max instances in one instanced call, and max vertices in
 	/// a single geometry render. You may leave this as 0, in which case the renderer will
-	/// make it 256kb.
+	/// make it 256kb. This is only the starting size, pages grow when a frame needs more than
+	/// one and allocations larger than a page get a page of their own.
 	uint64_t vramPageSize;
 
+	/// Uses VK2DDrawInstanceCompact instead of VK2DDrawInstance for sprite batches, which cuts the
+	/// size of each instance from 112 bytes to 40. Colour mods are clamped to 0-1 with 8 bits of
+	/// precision and texture coordinates are rounded to whole texels (up to 65535) in this mode.
+	bool compactInstances;
+
+	/// Builds sprite transforms in the vertex shader straight from the draw commands instead of
+	/// running the sprite batch compute shader first. This removes a compute dispatch, its
+	/// barriers, and the instance buffer from every flush, which is usually faster on integrated
+	/// and software GPUs. compactInstances has no effect when this is enabled.
+	bool computeFreeSprites;
+
+	/// How the per-frame descriptor buffers move on to a new vram page when the current one is
+	/// full. Linear (the default) never looks back, ring also fills leftover space in earlier
+	/// pages which saves memory when allocation sizes vary a lot.
+	VK2DDescriptorBufferMode descriptorBufferMode;
+
+	/// Number of frames in a row a descriptor buffer page may go unused before its video memory
+	/// is given back. You may leave this as 0, in which case the renderer will make it 120.
+	uint32_t descriptorBufferIdleFrames;
+
+	/// Records the copies from the descriptor buffers' staging memory to video memory on a
+	/// dedicated transfer queue, which the frame's compute and graphics work waits on with a
+	/// semaphore. Only has an effect on devices with a transfer-only queue family (usually
+	/// discrete GPUs) that don't already write video memory directly, otherwise the copies stay
+	/// on the graphics queue. Check VK2DRendererLimits.supportsTransferQueue to see if it's used.
+	bool transferQueueUploads;
+
+	/// File compiled pipelines are loaded from at startup and saved to on quit, so later runs skip
+	/// most shader compilation and window resizes don't compile anything twice. The file is
+	/// ignored if it was written by a different device or driver version. You may leave this as
+	/// NULL, in which case pipelines are still cached in memory for the life of the renderer.
+	const char *pipelineCachePath;
+
+	/// Pipelines are only created for a blend mode the first time something draws with it, which
+	/// can cause a small hitch on that frame. Enabling this creates every blend mode that hasn't
+	/// been used yet on a background thread after the renderer starts (and after every resize),
+	/// trading some driver memory for never compiling in the middle of a frame.
+	bool precompileBlendModes;
+
+	/// Number of threads that load the assets given to vk2dAssetsLoad. Textures, models and
+	/// shaders are decoded in parallel, and each thread records its GPU uploads into its own
+	/// upload batch that is sent off in one submission every few assets. You may leave this
+	/// as 0, in which case the renderer will use one less than the number of logical cores
+	/// (up to VK2D_MAX_LOAD_THREADS).
+	uint32_t loadThreads;
 };
 
 /// \brief User configurable settings
@@ -306,6 +366,9 @@ struct VK2DRendererLimits {
 	uint64_t maxGeometryVertices;    ///< Maximum vertices that can be used in one vk2dRendererDrawGeometryCall, if you use more vertices than this nothing will happen.
 	bool supportsMultiThreadLoading; ///< Whether or not the host supports loading assets in another thread, if attempt to load assets in another thread and this is false, assets will be loaded on the main thread instead
 	bool supportsVRAMUsage;          ///< Whether or not the host supports accurate VRAM usage, if this is false VMA will provide a less accurate estimate
+	bool supportsGPUCulling;         ///< Whether or not sprite batches are culled against each camera on the GPU, requires multi-draw indirect and the compute sprite path
+	bool supportsTransferQueue;      ///< Whether or not descriptor buffer uploads run on a dedicated transfer queue, requires VK2DStartupOptions.transferQueueUploads and a transfer-only queue family
+	bool supportsPushDescriptors;    ///< Whether or not per-draw descriptor sets are pushed straight into command buffers with VK_KHR_push_descriptor instead of allocated from pools
 };
 
 /// \brief Represents the data you need for each element in an instanced draw
@@ -317,6 +380,16 @@ struct VK2DDrawInstance {
 	mat4 model;            ///< Model for this instance, generally shouldn't contain translations
 };
 
+/// \brief Packed alternative to VK2DDrawInstance, used when VK2DStartupOptions::compactInstances is enabled
+struct VK2DDrawInstanceCompact {
+	vec2 xAxis;             ///< First column of the 2x3 affine transform for this instance
+	vec2 yAxis;             ///< Second column of the 2x3 affine transform for this instance
+	vec2 translation;       ///< Translation of the 2x3 affine transform for this instance
+	uint32_t colour;        ///< Colour mod of this draw packed as RGBA8
+	uint32_t textureIndex;  ///< Which texture this instance is using
+	uint16_t texturePos[4]; ///< x in tex, y in tex, w in tex, and h in tex in whole texels
+};
+
 /// \brief Represents a user's draw command which will later be processed into an instance
 struct VK2DDrawCommand {
     vec4 texturePos;       ///< x in tex, y in tex, w in tex, and h in tex
@@ -331,11 +404,13 @@ struct VK2DDrawCommand {
 /// \brief A push buffer for an instanced draw
 struct VK2DInstancedPushBuffer {
     uint32_t cameraIndex; ///< Index of the camera for this draw
+    uint32_t culled;      ///< Whether or not instances are looked up through the visible list written by the culling pass
 };
 
 /// \brief Push buffer for the sprite batch compute shader
 struct VK2DComputePushBuffer {
     uint32_t drawCount; ///< Number of draws being processed in this compute pass
+    uint32_t viewCount; ///< Number of camera views to cull against, 0 to skip culling
 };
 
 /// \brief Info for the shadow environment to keep track of
@@ -346,6 +421,68 @@ struct VK2DShadowObjectInfo {
     mat4 model;         ///< Model for this shadow object
 };
 
+/// \brief Counters for the deferred draw queue, see vk2dRendererSetDeferredDraws
+struct VK2DDrawQueueStats {
+	uint32_t queuedDraws;  ///< Number of draws that went through the draw queue
+	uint32_t batches;      ///< Number of batches the queued draws were flushed in after sorting
+	uint32_t flushesSaved; ///< Number of batch flushes sorting avoided compared to drawing in submission order
+};
+
+/// \brief A draw recorded to the deferred draw queue
+struct VK2DQueuedDraw {
+	VK2DShader shader;              ///< Shader to draw with, or NULL if this is a regular sprite
+	VK2DTexture tex;                ///< Texture for shader draws (sprites store the texture index in command)
+	VK2DBlendMode blendMode;        ///< Blend mode at the time of the draw
+	VkDeviceSize dataOffset;        ///< Offset of the shader's uniform data in the draw queue's data buffer
+	struct VK2DDrawCommand command; ///< Transform, colour, and texture region of the draw
+};
+
+/// \brief Sort key for a draw in the deferred draw queue
+struct VK2DQueuedDrawKey {
+	uint64_t key;   ///< Layer in the top 32 bits, pipeline ID (which includes the blend mode) in the bottom 32
+	uint32_t index; ///< Index of the draw in the queue, sorting on this keeps submission order within a key
+};
+
+/// \brief Per-frame usage counters for a descriptor buffer
+struct VK2DDescriptorBufferStats {
+	uint32_t allocations;        ///< Number of copies, reservations, and regions served
+	uint32_t pagesUsed;          ///< Number of pages that had anything placed in them
+	uint32_t pageCount;          ///< Number of pages the descriptor buffer owns
+	VkDeviceSize bytesRequested; ///< Bytes asked for by allocations
+	VkDeviceSize bytesUsed;      ///< Bytes taken from pages, including alignment padding
+	VkDeviceSize bytesWasted;    ///< Bytes left free in pages the cursor is no longer in
+	uint32_t oversizeAllocations; ///< Number of allocations too large for a standard page that got their own page
+	VkDeviceSize pageSize;       ///< Size of a standard page at the end of the frame, it grows when frames outgrow one page
+};
+
+/// \brief Counters for a descriptor controller, kept since it was created
+struct VK2DDescConStats {
+	uint64_t setsAllocated;    ///< Number of sets allocated from the controller's pools
+	uint64_t failedAllocations; ///< Number of allocations a pool turned down, each one moves the cursor to the next pool
+	uint32_t poolCount;        ///< Number of pools the controller owns
+	uint64_t cacheHits;        ///< Number of sampler sets served from the content cache
+	uint64_t cacheMisses;      ///< Number of sampler sets that had to be allocated and written while the cache was enabled
+};
+
+/// \brief One shape in the instanced primitive batch
+struct VK2DShapeInstance {
+	vec4 colour;      ///< Colour mod at the time the shape was drawn
+	vec2 xAxis;       ///< First column of the 2x3 affine transform for this shape
+	vec2 yAxis;       ///< Second column of the 2x3 affine transform for this shape
+	vec2 translation; ///< Translation of the 2x3 affine transform for this shape
+	vec2 padding;     ///< Padding
+};
+
+/// \brief Consecutive shapes in the primitive batch that share a polygon and line width
+struct VK2DShapeRun {
+	VkBuffer vertices;      ///< Vertex buffer of the polygon, or VK_NULL_HANDLE for vertices in the geometry stream
+	VkDeviceSize offset;    ///< Offset of the polygon in the vertex buffer or the geometry stream
+	uint32_t vertexCount;   ///< Number of vertices in the polygon
+	float lineWidth;        ///< Line width for outlines
+	uint32_t firstInstance; ///< First shape instance of this run
+	uint32_t instanceCount; ///< Number of shape instances in this run
+};
+
 /// \brief Information needed to queue an asset loading off-thread
 struct VK2DAssetLoad {
 	VK2DAssetType type;   ///< Type of asset this is
@@ -392,11 +529,19 @@ VK2D_USER_STRUCT(VK2DRendererConfig)
 VK2D_USER_STRUCT(VK2DCameraSpec)
 VK2D_USER_STRUCT(VK2DRendererLimits)
 VK2D_USER_STRUCT(VK2DDrawInstance)
+VK2D_USER_STRUCT(VK2DDrawInstanceCompact)
 VK2D_USER_STRUCT(VK2DDrawCommand)
 VK2D_USER_STRUCT(VK2DAssetLoad)
 VK2D_USER_STRUCT(VK2DShadowObjectInfo)
 VK2D_USER_STRUCT(VK2DInstancedPushBuffer)
 VK2D_USER_STRUCT(VK2DComputePushBuffer)
+VK2D_USER_STRUCT(VK2DDrawQueueStats)
+VK2D_USER_STRUCT(VK2DQueuedDraw)
+VK2D_USER_STRUCT(VK2DQueuedDrawKey)
+VK2D_USER_STRUCT(VK2DDescriptorBufferStats)
+VK2D_USER_STRUCT(VK2DDescConStats)
+VK2D_USER_STRUCT(VK2DShapeInstance)
+VK2D_USER_STRUCT(VK2DShapeRun)
 
 #ifdef __cplusplus
 }
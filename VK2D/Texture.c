@@ -12,6 +12,7 @@
 #include "VK2D/stb_image.h"
 #include "VK2D/Opaque.h"
 #include "VK2D/Util.h"
+#include "VK2D/UploadBatch.h"
 
 #ifndef __APPLE__
 #include <malloc.h>
@@ -29,6 +30,9 @@ static void _vk2dTextureAddToTextureArray(VK2DTexture tex) {
     if (tex == NULL || vk2dStatusFatal())
         return;
 
+    // Loader threads register textures too
+    SDL_LockMutex(gRenderer->ld->uploadMutex);
+
     // Find an available slot
     int spot = -1;
     for (int i = 0; i < gRenderer->options.maxTextures; i++) {
@@ -60,6 +64,7 @@ static void _vk2dTextureAddToTextureArray(VK2DTexture tex) {
         };
         vkUpdateDescriptorSets(gRenderer->ld->dev, 1, &write, 0, VK_NULL_HANDLE);
     }
+    SDL_UnlockMutex(gRenderer->ld->uploadMutex);
 }
 
 VK2DTexture _vk2dTextureLoadFromImageInternal(VK2DImage image, bool mainThread) {
@@ -82,16 +87,19 @@ VK2DTexture vk2dTextureLoadFromImage(VK2DImage image) {
 	return _vk2dTextureLoadFromImageInternal(image, true);
 }
 
-VK2DTexture _vk2dTextureFromInternal(void *data, int size, bool mainThread) {
+VK2DTexture _vk2dTextureFromInternal(void *data, int size, VK2DUploadBatch batch) {
 	VK2DImage image;
 	VK2DTexture out = NULL;
 
 	int x, y, channels;
 	void *pixels = stbi_load_from_memory(data, size, &x, &y, &channels, 4);
 	if (pixels != NULL) {
-		image = vk2dImageFromPixels(vk2dRendererGetDevice(), pixels, x, y, mainThread);
+		if (batch != NULL)
+			image = vk2dUploadBatchAddImage(batch, pixels, x, y);
+		else
+			image = vk2dImageFromPixels(vk2dRendererGetDevice(), pixels, x, y, true);
 		if (image != NULL) {
-			out = _vk2dTextureLoadFromImageInternal(image, mainThread);
+			out = _vk2dTextureLoadFromImageInternal(image, batch == NULL);
 			if (out != NULL)
 				out->imgHandled = true;
 			else
@@ -109,7 +117,7 @@ VK2DTexture _vk2dTextureFromInternal(void *data, int size, bool mainThread) {
 }
 
 VK2DTexture vk2dTextureFrom(void *data, int size) {
-	VK2DTexture tex = _vk2dTextureFromInternal(data, size, true);
+	VK2DTexture tex = _vk2dTextureFromInternal(data, size, NULL);
 	if (tex == NULL)
         vk2dLog("Failed to load texture from data of size %i.", size);
 	else
@@ -122,7 +130,7 @@ VK2DTexture vk2dTextureLoad(const char *filename) {
     VK2DTexture tex = NULL;
     void *data = _vk2dLoadFile(filename, &size);
 	if (data != NULL) {
-        tex = _vk2dTextureFromInternal(data, size, true);
+        tex = _vk2dTextureFromInternal(data, size, NULL);
         _vk2dTextureAddToTextureArray(tex);
         free(data);
     }
@@ -228,7 +236,9 @@ void vk2dTextureFree(VK2DTexture tex) {
 		}
         VK2DRenderer renderer = vk2dRendererGetPointer();
 		int val = SDL_GetAtomicInt(&tex->descriptorIndex);
+		SDL_LockMutex(renderer->ld->uploadMutex);
 		renderer->textureArray[val].active = false;
+		SDL_UnlockMutex(renderer->ld->uploadMutex);
 		free(tex);
 	}
 }
@@ -0,0 +1,369 @@
+/// \file UploadBatch.c
+/// \author Paolo Mazzon
+#include "VK2D/UploadBatch.h"
+#include "VK2D/Buffer.h"
+#include "VK2D/Image.h"
+#include "VK2D/LogicalDevice.h"
+#include "VK2D/Initializers.h"
+#include "VK2D/Validation.h"
+#include "VK2D/Constants.h"
+#include "VK2D/Renderer.h"
+#include "VK2D/Opaque.h"
+
+#include <string.h>
+#ifndef __APPLE__
+#include <malloc.h>
+#else
+#include <sys/cdefs.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <malloc/_malloc.h>
+#include <malloc/malloc.h>
+#include <memory.h>
+#endif
+
+// Replaces the ring's buffer with a new one of the given size, the ring must have nothing in flight
+static bool _vk2dStagingRingCreateBuffer(_VK2DStagingRing *ring, VkDeviceSize size) {
+    void *mapped;
+    bool coherent;
+    VK2DBuffer buffer = vk2dBufferCreateMapped(ring->dev, size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &mapped, &coherent, false);
+    if (buffer == NULL)
+        return false;
+    vk2dBufferFree(ring->buffer);
+    ring->buffer = buffer;
+    ring->data = mapped;
+    ring->size = size;
+    ring->head = 0;
+    ring->tail = 0;
+    ring->openStart = 0;
+    return true;
+}
+
+// Waits for the oldest span to finish and gives its memory and command buffer back to the ring
+static void _vk2dStagingRingRetire(_VK2DStagingRing *ring) {
+    _VK2DStagingSpan *span = &ring->spans[ring->firstSpan];
+    VkResult result = vkWaitForFences(ring->dev->dev, 1, &span->fence, VK_TRUE, UINT64_MAX);
+    if (result != VK_SUCCESS)
+        vk2dRaise(VK2D_STATUS_VULKAN_ERROR, "Failed to wait on staging ring, Vulkan error %i.", result);
+    vkResetFences(ring->dev->dev, 1, &span->fence);
+    if (span->commandBuffer != VK_NULL_HANDLE)
+        vkFreeCommandBuffers(ring->dev->dev, ring->pool, 1, &span->commandBuffer);
+    span->commandBuffer = VK_NULL_HANDLE;
+    ring->tail = span->end;
+    ring->firstSpan = (ring->firstSpan + 1) % VK2D_STAGING_RING_SPANS;
+    ring->spanCount--;
+}
+
+bool _vk2dStagingRingCreate(_VK2DStagingRing *ring, VK2DLogicalDevice dev, VkDeviceSize size) {
+    memset(ring, 0, sizeof(_VK2DStagingRing));
+    ring->dev = dev;
+    VkCommandPoolCreateInfo poolCreateInfo = vk2dInitCommandPoolCreateInfo(dev->pd->QueueFamily.graphicsFamily, VK_COMMAND_POOL_CREATE_TRANSIENT_BIT);
+    VkResult result = vkCreateCommandPool(dev->dev, &poolCreateInfo, VK_NULL_HANDLE, &ring->pool);
+    if (result != VK_SUCCESS) {
+        vk2dRaise(VK2D_STATUS_VULKAN_ERROR, "Failed to create staging ring command pool, Vulkan error %i.", result);
+        ring->dev = NULL;
+        return false;
+    }
+    for (uint32_t i = 0; i < VK2D_STAGING_RING_SPANS; i++)
+        ring->spans[i].fence = vk2dLogicalDeviceGetFence(dev, 0);
+    if (!_vk2dStagingRingCreateBuffer(ring, size)) {
+        vk2dRaise(VK2D_STATUS_OUT_OF_VRAM, "Failed to create staging ring of size %0.2fkb.", (float)size / 1024.0f);
+        _vk2dStagingRingDestroy(ring);
+        return false;
+    }
+    return true;
+}
+
+void _vk2dStagingRingDestroy(_VK2DStagingRing *ring) {
+    if (ring->dev == NULL)
+        return;
+    while (ring->spanCount > 0)
+        _vk2dStagingRingRetire(ring);
+    for (uint32_t i = 0; i < VK2D_STAGING_RING_SPANS; i++)
+        vk2dLogicalDeviceFreeFence(ring->dev, ring->spans[i].fence);
+    vkDestroyCommandPool(ring->dev->dev, ring->pool, VK_NULL_HANDLE);
+    vk2dBufferFree(ring->buffer);
+    ring->buffer = NULL;
+    ring->dev = NULL;
+}
+
+// Reserves size bytes of the ring, only blocking if the allocation would land on a span still in flight. This
+// returns NULL if the only thing in the way is the caller's own unsubmitted allocations, which it must submit first.
+static void *_vk2dStagingRingAlloc(_VK2DStagingRing *ring, VkDeviceSize size, VkDeviceSize *offset) {
+    // Free up whatever the GPU is already done with
+    while (ring->spanCount > 0 && vkGetFenceStatus(ring->dev->dev, ring->spans[ring->firstSpan].fence) == VK_SUCCESS)
+        _vk2dStagingRingRetire(ring);
+
+    // Uploads bigger than the whole ring make it grow once everything in it is done
+    if (size >= ring->size) {
+        if (ring->openStart != ring->head)
+            return NULL;
+        while (ring->spanCount > 0)
+            _vk2dStagingRingRetire(ring);
+        VkDeviceSize newSize = ring->size;
+        while (newSize <= size)
+            newSize *= 2;
+        if (!_vk2dStagingRingCreateBuffer(ring, newSize))
+            return NULL;
+    }
+
+    while (true) {
+        const bool empty = ring->spanCount == 0 && ring->openStart == ring->head;
+        if (empty) {
+            ring->head = 0;
+            ring->tail = 0;
+            ring->openStart = 0;
+        }
+
+        // If the head is past the tail the free space is from the head to the end and then from the start
+        // to the tail, otherwise it's just between the head and the tail. The head never catches up to the
+        // tail exactly so they're only equal when the ring is empty.
+        VkDeviceSize start = (ring->head + VK2D_STAGING_RING_ALIGNMENT - 1) & ~((VkDeviceSize)VK2D_STAGING_RING_ALIGNMENT - 1);
+        bool found = false;
+        if (empty || ring->head > ring->tail) {
+            if (start + size <= ring->size) {
+                found = true;
+            } else if (size < ring->tail) {
+                start = 0;
+                found = true;
+            }
+        } else if (start + size < ring->tail) {
+            found = true;
+        }
+
+        if (found) {
+            ring->head = start + size;
+            *offset = start;
+            return ring->data + start;
+        } else if (ring->spanCount == 0) {
+            return NULL;
+        }
+        _vk2dStagingRingRetire(ring);
+    }
+}
+
+// Makes sure there's a free span slot and returns the fence the next submission must signal
+static VkFence _vk2dStagingRingNextFence(_VK2DStagingRing *ring) {
+    if (ring->spanCount == VK2D_STAGING_RING_SPANS)
+        _vk2dStagingRingRetire(ring);
+    return ring->spans[(ring->firstSpan + ring->spanCount) % VK2D_STAGING_RING_SPANS].fence;
+}
+
+// Turns everything allocated since the last submission into a span once it's been submitted with _vk2dStagingRingNextFence
+static void _vk2dStagingRingClose(_VK2DStagingRing *ring, VkCommandBuffer commandBuffer) {
+    _VK2DStagingSpan *span = &ring->spans[(ring->firstSpan + ring->spanCount) % VK2D_STAGING_RING_SPANS];
+    span->end = ring->head;
+    span->commandBuffer = commandBuffer;
+    ring->openStart = ring->head;
+    ring->spanCount++;
+}
+
+// Retires spans up to and including the one signalled by fence, which may already be gone
+static void _vk2dStagingRingWaitFence(_VK2DStagingRing *ring, VkFence fence) {
+    for (uint32_t i = 0; i < ring->spanCount; i++) {
+        if (ring->spans[(ring->firstSpan + i) % VK2D_STAGING_RING_SPANS].fence == fence) {
+            for (uint32_t j = 0; j <= i; j++)
+                _vk2dStagingRingRetire(ring);
+            return;
+        }
+    }
+}
+
+// Starts recording if the batch isn't already
+static bool _vk2dUploadBatchBegin(VK2DUploadBatch batch) {
+    if (batch->buffer != VK_NULL_HANDLE)
+        return true;
+    VkCommandBufferAllocateInfo allocInfo = vk2dInitCommandBufferAllocateInfo(batch->ring->pool, 1);
+    VkResult result = vkAllocateCommandBuffers(batch->dev->dev, &allocInfo, &batch->buffer);
+    if (result != VK_SUCCESS) {
+        vk2dRaise(VK2D_STATUS_VULKAN_ERROR, "Failed to allocate upload batch command buffer, Vulkan error %i.", result);
+        batch->buffer = VK_NULL_HANDLE;
+        return false;
+    }
+    VkCommandBufferBeginInfo beginInfo = vk2dInitCommandBufferBeginInfo(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT, VK_NULL_HANDLE);
+    result = vkBeginCommandBuffer(batch->buffer, &beginInfo);
+    if (result != VK_SUCCESS) {
+        vk2dRaise(VK2D_STATUS_VULKAN_ERROR, "Failed to begin upload batch command buffer, Vulkan error %i.", result);
+        vkFreeCommandBuffers(batch->dev->dev, batch->ring->pool, 1, &batch->buffer);
+        batch->buffer = VK_NULL_HANDLE;
+        return false;
+    }
+    return true;
+}
+
+// Finds room for size bytes in the batch's ring, submitting what the batch has so far if that's what's in the way.
+// Recording is started before anything is taken from the ring so a failure never leaves bytes no span owns.
+static void *_vk2dUploadBatchReserve(VK2DUploadBatch batch, VkDeviceSize size, VkDeviceSize *offset) {
+    if (!_vk2dUploadBatchBegin(batch))
+        return NULL;
+    void *data = _vk2dStagingRingAlloc(batch->ring, size, offset);
+    if (data == NULL) {
+        vk2dUploadBatchSubmit(batch);
+        if (!_vk2dUploadBatchBegin(batch))
+            return NULL;
+        data = _vk2dStagingRingAlloc(batch->ring, size, offset);
+    }
+    return data;
+}
+
+VK2DUploadBatch vk2dUploadBatchCreate(VK2DLogicalDevice dev, bool mainThread) {
+    _VK2DStagingRing *ring = mainThread ? &dev->stagingRing : vk2dLogicalDeviceAcquireLoadRing(dev);
+    if (ring == NULL || ring->dev == NULL) {
+        vk2dRaise(VK2D_STATUS_VULKAN_ERROR, "No staging ring available for upload batch.");
+        return NULL;
+    }
+    VK2DUploadBatch batch = calloc(1, sizeof(struct VK2DUploadBatch_t));
+    if (batch == NULL) {
+        vk2dRaise(VK2D_STATUS_OUT_OF_RAM, "Failed to allocate upload batch.");
+        if (!mainThread)
+            vk2dLogicalDeviceReleaseLoadRing(dev, ring);
+        return NULL;
+    }
+    batch->dev = dev;
+    batch->mainThread = mainThread;
+    batch->ring = ring;
+    return batch;
+}
+
+VK2DImage vk2dUploadBatchAddImage(VK2DUploadBatch batch, const void *pixels, int w, int h) {
+    if (batch == NULL || pixels == NULL || vk2dStatusFatal())
+        return NULL;
+    const VkDeviceSize size = (VkDeviceSize)w * h * 4;
+    VK2DImage out = vk2dImageCreate(batch->dev, w, h, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_ASPECT_COLOR_BIT,
+                                    VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, 1);
+    VkDeviceSize offset;
+    if (out == NULL)
+        return NULL;
+    void *stage = _vk2dUploadBatchReserve(batch, size, &offset);
+    if (stage == NULL) {
+        vk2dImageFree(out);
+        return NULL;
+    }
+    memcpy(stage, pixels, size);
+
+    VkImageMemoryBarrier barrier = {0};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = out->img;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.baseMipLevel = 0;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = 1;
+    vkCmdPipelineBarrier(batch->buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, VK_NULL_HANDLE, 0, VK_NULL_HANDLE, 1, &barrier);
+
+    VkBufferImageCopy region = {0};
+    region.bufferOffset = offset;
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.layerCount = 1;
+    region.imageExtent.width = w;
+    region.imageExtent.height = h;
+    region.imageExtent.depth = 1;
+    vkCmdCopyBufferToImage(batch->buffer, batch->ring->buffer->buf, out->img, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    vkCmdPipelineBarrier(batch->buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, VK_NULL_HANDLE, 0, VK_NULL_HANDLE, 1, &barrier);
+
+    return out;
+}
+
+VK2DBuffer vk2dUploadBatchAddBuffer(VK2DUploadBatch batch, VkBufferUsageFlags usage, const void *data, VkDeviceSize size, const void *data2, VkDeviceSize size2) {
+    if (batch == NULL || vk2dStatusFatal())
+        return NULL;
+    if (data2 == NULL)
+        size2 = 0;
+    VK2DBuffer out = vk2dBufferCreate(batch->dev, size + size2, usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    VkDeviceSize offset;
+    if (out == NULL)
+        return NULL;
+    uint8_t *stage = _vk2dUploadBatchReserve(batch, size + size2, &offset);
+    if (stage == NULL) {
+        vk2dBufferFree(out);
+        return NULL;
+    }
+    memcpy(stage, data, size);
+    if (data2 != NULL)
+        memcpy(stage + size, data2, size2);
+
+    VkBufferCopy region = {0};
+    region.srcOffset = offset;
+    region.dstOffset = 0;
+    region.size = size + size2;
+    vkCmdCopyBuffer(batch->buffer, batch->ring->buffer->buf, out->buf, 1, &region);
+
+    // Anything submitted after this may read the buffer
+    VkBufferMemoryBarrier barrier = {0};
+    barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.buffer = out->buf;
+    barrier.offset = 0;
+    barrier.size = VK_WHOLE_SIZE;
+    vkCmdPipelineBarrier(batch->buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, VK_NULL_HANDLE, 1, &barrier, 0, VK_NULL_HANDLE);
+
+    return out;
+}
+
+void vk2dUploadBatchSubmit(VK2DUploadBatch batch) {
+    if (batch == NULL || batch->buffer == VK_NULL_HANDLE)
+        return;
+    VkCommandBuffer buffer = batch->buffer;
+    batch->buffer = VK_NULL_HANDLE;
+    VkResult result = vkEndCommandBuffer(buffer);
+    if (result != VK_SUCCESS) {
+        vk2dRaise(VK2D_STATUS_VULKAN_ERROR, "Failed to end upload batch command buffer, Vulkan error %i.", result);
+        vkFreeCommandBuffers(batch->dev->dev, batch->ring->pool, 1, &buffer);
+        return;
+    }
+
+    // Loader threads all share the load queue
+    VkFence fence = _vk2dStagingRingNextFence(batch->ring);
+    VkSubmitInfo submitInfo = vk2dInitSubmitInfo(&buffer, 1, VK_NULL_HANDLE, 0, VK_NULL_HANDLE, 0, VK_NULL_HANDLE);
+    if (batch->mainThread) {
+        result = vkQueueSubmit(batch->dev->queue, 1, &submitInfo, fence);
+    } else {
+        SDL_LockMutex(batch->dev->uploadMutex);
+        result = vkQueueSubmit(batch->dev->loadQueue, 1, &submitInfo, fence);
+        SDL_UnlockMutex(batch->dev->uploadMutex);
+    }
+
+    // The ring now looks after the staging memory and command buffer until the fence signals
+    if (result == VK_SUCCESS) {
+        _vk2dStagingRingClose(batch->ring, buffer);
+        batch->fence = fence;
+    } else {
+        vk2dRaise(VK2D_STATUS_VULKAN_ERROR, "Failed to submit upload batch, Vulkan error %i.", result);
+        vkFreeCommandBuffers(batch->dev->dev, batch->ring->pool, 1, &buffer);
+    }
+}
+
+void vk2dUploadBatchWait(VK2DUploadBatch batch) {
+    if (batch == NULL || batch->fence == VK_NULL_HANDLE)
+        return;
+    _vk2dStagingRingWaitFence(batch->ring, batch->fence);
+    batch->fence = VK_NULL_HANDLE;
+}
+
+void vk2dUploadBatchFlush(VK2DUploadBatch batch) {
+    vk2dUploadBatchSubmit(batch);
+    vk2dUploadBatchWait(batch);
+}
+
+void vk2dUploadBatchFree(VK2DUploadBatch batch) {
+    if (batch != NULL) {
+        vk2dUploadBatchSubmit(batch);
+        if (!batch->mainThread)
+            vk2dLogicalDeviceReleaseLoadRing(batch->dev, batch->ring);
+        free(batch);
+    }
+}
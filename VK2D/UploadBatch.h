@@ -0,0 +1,83 @@
+/// \file UploadBatch.h
+/// \author Paolo Mazzon
+/// \brief Groups many buffer and image uploads into one staging buffer and one submission
+#pragma once
+#include <vulkan/vulkan.h>
+#include "VK2D/Structs.h"
+#include "VK2D/Opaque.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// \brief Creates a staging ring
+/// \param ring Ring to initialize
+/// \param dev Device the ring belongs to
+/// \param size Starting size in bytes of the ring
+/// \return Returns true if the ring was created
+bool _vk2dStagingRingCreate(_VK2DStagingRing *ring, VK2DLogicalDevice dev, VkDeviceSize size);
+
+/// \brief Waits for everything in a staging ring to finish and frees it, does nothing if the ring was never created
+/// \param ring Ring to free
+void _vk2dStagingRingDestroy(_VK2DStagingRing *ring);
+
+/// \brief Creates an upload batch
+/// \param dev Device the uploads go to
+/// \param mainThread Whether or not the batch is used on the main thread, which decides the queue and staging ring it uses
+/// \return Returns a new upload batch or NULL if it failed
+///
+/// Uploads added to a batch are copied into a staging ring owned by the logical device and
+/// their copies and layout transitions are recorded into a single command buffer. Nothing is
+/// sent to the GPU until the ring fills up or the batch is submitted, at which point everything
+/// goes in one submission tracked by one fence. A batch may only be used by one thread at a time
+/// and only one main thread batch may exist at a time. Off-thread batches each check out one of
+/// the loader threads' staging rings until they're freed.
+VK2DUploadBatch vk2dUploadBatchCreate(VK2DLogicalDevice dev, bool mainThread);
+
+/// \brief Creates an image and queues its pixels to be uploaded
+/// \param batch Batch to upload with
+/// \param pixels Pixels to create the image with, should be 32 bit RGBA
+/// \param w Width in pixels of the image
+/// \param h Height in pixels of the image
+/// \return Returns a new image or NULL if it failed
+/// \warning The image may not be used until the batch has been submitted (main thread) or waited on (other threads)
+///
+/// The image is left in shader read-only layout once the upload completes.
+VK2DImage vk2dUploadBatchAddImage(VK2DUploadBatch batch, const void *pixels, int w, int h);
+
+/// \brief Creates a device-local buffer and queues up to two blocks of data to be uploaded back to back
+/// \param batch Batch to upload with
+/// \param usage How the buffer will be used (transfer destination is added automatically)
+/// \param data First block of data
+/// \param size Size in bytes of the first block
+/// \param data2 Second block of data, placed right after the first, or NULL
+/// \param size2 Size in bytes of the second block, ignored if data2 is NULL
+/// \return Returns a new buffer or NULL if it failed
+/// \warning The buffer may not be used until the batch has been submitted (main thread) or waited on (other threads)
+VK2DBuffer vk2dUploadBatchAddBuffer(VK2DUploadBatch batch, VkBufferUsageFlags usage, const void *data, VkDeviceSize size, const void *data2, VkDeviceSize size2);
+
+/// \brief Submits everything recorded so far without waiting for it
+/// \param batch Batch to submit
+///
+/// The staging memory stays reserved until the submission's fence signals, and the batch may
+/// keep recording straight away. Uploads submitted from the main thread are visible to anything
+/// submitted to the main queue afterwards without waiting.
+void vk2dUploadBatchSubmit(VK2DUploadBatch batch);
+
+/// \brief Waits for the batch's last submission to finish, after which its uploads are safe to use
+/// \param batch Batch to wait on
+void vk2dUploadBatchWait(VK2DUploadBatch batch);
+
+/// \brief Submits everything recorded so far and waits for it to finish
+/// \param batch Batch to flush
+void vk2dUploadBatchFlush(VK2DUploadBatch batch);
+
+/// \brief Submits any pending uploads and frees the batch
+/// \param batch Batch to free
+///
+/// This doesn't wait on the last submission, the staging ring keeps track of it.
+void vk2dUploadBatchFree(VK2DUploadBatch batch);
+
+#ifdef __cplusplus
+};
+#endif
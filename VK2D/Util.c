@@ -24,8 +24,7 @@
 #include "VK2D/Texture.h"
 #include "VK2D/Shader.h"
 #include "VK2D/Model.h"
-
-static float gLoadStatus = 0;
+#include "VK2D/UploadBatch.h"
 
 // Gets the vertex input information for VK2DVertexTexture (Uses static variables to persist attached descriptions)
 VkPipelineVertexInputStateCreateInfo _vk2dGetTextureVertexInputState() {
@@ -159,6 +158,14 @@ unsigned char* _vk2dLoadFile(const char *filename, uint32_t *size) {
 	return buffer;
 }
 
+bool _vk2dSaveFile(const char *filename, const void *data, size_t size) {
+	FILE* file = fopen(filename, "wb");
+	if (file == NULL)
+		return false;
+	const bool written = fwrite(data, 1, size, file) == size;
+	return fclose(file) == 0 && written;
+}
+
 unsigned char *_vk2dCopyBuffer(void *buffer, int size) {
 	unsigned char *new = NULL;
 	if (buffer != NULL && size != 0) {
@@ -172,147 +179,359 @@ unsigned char *_vk2dCopyBuffer(void *buffer, int size) {
 	return new;
 }
 
-extern VK2DLogicalDevice gDeviceFromMainThread;
+bool _vk2dAssetQueueCreate(_VK2DAssetQueue *queue, uint32_t capacity) {
+	queue->cells = malloc(sizeof(_VK2DAssetQueueCell) * capacity);
+	if (queue->cells == NULL)
+		return false;
+	queue->mask = capacity - 1;
+	for (uint32_t i = 0; i < capacity; i++)
+		SDL_SetAtomicInt(&queue->cells[i].sequence, (int)i);
+	SDL_SetAtomicInt(&queue->enqueuePos, 0);
+	SDL_SetAtomicInt(&queue->dequeuePos, 0);
+	return true;
+}
+
+void _vk2dAssetQueueDestroy(_VK2DAssetQueue *queue) {
+	free(queue->cells);
+	queue->cells = NULL;
+}
+
+// Each cell's sequence is its position while it's free and position + 1 once it holds an asset,
+// so a thread can claim a cell by moving the head forward without ever taking a lock
+bool _vk2dAssetQueuePush(_VK2DAssetQueue *queue, VK2DAssetLoad *asset, _VK2DLoadGroup *group) {
+	uint32_t pos = (uint32_t)SDL_GetAtomicInt(&queue->enqueuePos);
+	_VK2DAssetQueueCell *cell;
+	while (true) {
+		cell = &queue->cells[pos & queue->mask];
+		const int32_t diff = (int32_t)((uint32_t)SDL_GetAtomicInt(&cell->sequence) - pos);
+		if (diff == 0) {
+			if (SDL_CompareAndSwapAtomicInt(&queue->enqueuePos, (int)pos, (int)(pos + 1)))
+				break;
+		} else if (diff < 0) {
+			return false; // Full
+		}
+		pos = (uint32_t)SDL_GetAtomicInt(&queue->enqueuePos);
+	}
+	cell->asset = asset;
+	cell->group = group;
+	SDL_SetAtomicInt(&cell->sequence, (int)(pos + 1));
+	return true;
+}
+
+VK2DAssetLoad *_vk2dAssetQueuePop(_VK2DAssetQueue *queue, _VK2DLoadGroup **group) {
+	uint32_t pos = (uint32_t)SDL_GetAtomicInt(&queue->dequeuePos);
+	_VK2DAssetQueueCell *cell;
+	while (true) {
+		cell = &queue->cells[pos & queue->mask];
+		const int32_t diff = (int32_t)((uint32_t)SDL_GetAtomicInt(&cell->sequence) - (pos + 1));
+		if (diff == 0) {
+			if (SDL_CompareAndSwapAtomicInt(&queue->dequeuePos, (int)pos, (int)(pos + 1)))
+				break;
+		} else if (diff < 0) {
+			return NULL; // Empty
+		}
+		pos = (uint32_t)SDL_GetAtomicInt(&queue->dequeuePos);
+	}
+	VK2DAssetLoad *asset = cell->asset;
+	*group = cell->group;
+	SDL_SetAtomicInt(&cell->sequence, (int)(pos + queue->mask + 1));
+	return asset;
+}
+
+bool _vk2dAssetQueueEmpty(_VK2DAssetQueue *queue) {
+	return SDL_GetAtomicInt(&queue->enqueuePos) == SDL_GetAtomicInt(&queue->dequeuePos);
+}
+
+static bool _vk2dAssetIsModel(VK2DAssetLoad *asset) {
+	return asset->type == VK2D_ASSET_TYPE_MODEL_FILE || asset->type == VK2D_ASSET_TYPE_MODEL_MEMORY;
+}
+
+// Loads a single asset, its uploads are only recorded into batch so they aren't usable until it's flushed
+static void _vk2dAssetLoad(VK2DAssetLoad *asset, VK2DUploadBatch batch) {
+	if (asset->type == VK2D_ASSET_TYPE_TEXTURE_FILE) {
+		uint32_t size;
+		uint8_t *fileData = _vk2dLoadFile(asset->Load.filename, &size);
+		*asset->Output.texture = _vk2dTextureFromInternal(fileData, size, batch);
+		if (*asset->Output.texture == NULL)
+			vk2dLog("Failed to load texture \"%s\".", asset->Load.filename);
+		free(fileData);
+	} else if (asset->type == VK2D_ASSET_TYPE_TEXTURE_MEMORY) {
+		*asset->Output.texture = _vk2dTextureFromInternal(asset->Load.data, asset->Load.size, batch);
+		if (*asset->Output.texture == NULL)
+			vk2dLog("Failed to load texture from buffer.");
+	} else if (asset->type == VK2D_ASSET_TYPE_MODEL_FILE) {
+		uint32_t size;
+		uint8_t *fileData = _vk2dLoadFile(asset->Load.filename, &size);
+		*asset->Output.model = _vk2dModelFromInternal(fileData, size, *asset->Data.Model.tex, batch);
+		if (*asset->Output.model == NULL)
+			vk2dLog("Failed to load model \"%s\".", asset->Load.filename);
+		free(fileData);
+	} else if (asset->type == VK2D_ASSET_TYPE_MODEL_MEMORY) {
+		*asset->Output.model = _vk2dModelFromInternal(asset->Load.data, asset->Load.size, *asset->Data.Model.tex, batch);
+		if (*asset->Output.model == NULL)
+			vk2dLog("Failed to load model from buffer.");
+	} else if (asset->type == VK2D_ASSET_TYPE_SHADER_FILE) {
+		// Shaders are internally synchronized
+		*asset->Output.shader = vk2dShaderLoad(asset->Load.filename, asset->Load.fragmentFilename, asset->Data.Shader.uniformBufferSize);
+	} else if (asset->type == VK2D_ASSET_TYPE_SHADER_MEMORY) {
+		// Shaders are internally synchronized
+		*asset->Output.shader = vk2dShaderFrom(asset->Load.data, asset->Load.size, asset->Load.fragmentData, asset->Load.fragmentSize, asset->Data.Shader.uniformBufferSize);
+	}
+}
+
+// Sets a skipped asset's output to NULL so the user can tell it wasn't loaded
+static void _vk2dAssetSkip(VK2DAssetLoad *asset) {
+	if (asset->type == VK2D_ASSET_TYPE_TEXTURE_FILE || asset->type == VK2D_ASSET_TYPE_TEXTURE_MEMORY)
+		*asset->Output.texture = NULL;
+	else if (asset->type == VK2D_ASSET_TYPE_SHADER_FILE || asset->type == VK2D_ASSET_TYPE_SHADER_MEMORY)
+		*asset->Output.shader = NULL;
+	else if (asset->type == VK2D_ASSET_TYPE_MODEL_FILE || asset->type == VK2D_ASSET_TYPE_MODEL_MEMORY)
+		*asset->Output.model = NULL;
+}
+
+// Finds a group that still has assets left, loadListMutex must be held
+static _VK2DLoadGroup *_vk2dLoadGroupFind(VK2DLogicalDevice dev, VK2DAssetGroup id) {
+	for (_VK2DLoadGroup *group = dev->loadGroups; group != NULL; group = group->next)
+		if (group->id == id)
+			return group;
+	return NULL;
+}
+
+// Moves assets from the load groups into the queue until every loader thread has a few waiting, loadListMutex
+// must be held. Keeping the queue shallow means a new high priority group only waits on a handful of assets.
+static void _vk2dAssetQueueFill(VK2DLogicalDevice dev) {
+	const uint32_t target = dev->workerCount * VK2D_ASSET_QUEUE_AHEAD;
+	bool queued = false;
+	for (_VK2DLoadGroup *group = dev->loadGroups; group != NULL && dev->queuedAssets < target; group = group->next) {
+		// Models may use textures from the same group so they're only let through once everything else is done
+		const uint32_t limit = group->earlyLoads == 0 ? group->count : group->earlyCount;
+		while (group->nextToQueue < limit && dev->queuedAssets < target) {
+			// Popped assets are only counted off after the pop completes, so this never finds the queue full
+			if (!_vk2dAssetQueuePush(&dev->assetQueue, &group->assets[group->nextToQueue], group))
+				break;
+			group->nextToQueue++;
+			dev->queuedAssets++;
+			queued = true;
+		}
+	}
+	if (queued)
+		SDL_BroadcastCondition(dev->loadCondition);
+}
+
+// Frees every group with nothing left to load, loadListMutex must be held
+static void _vk2dLoadGroupsPrune(VK2DLogicalDevice dev) {
+	_VK2DLoadGroup **link = &dev->loadGroups;
+	bool removed = false;
+	while (*link != NULL) {
+		_VK2DLoadGroup *group = *link;
+		if (group->loads == 0) {
+			*link = group->next;
+			free(group->assets);
+			free(group);
+			removed = true;
+		} else {
+			link = &group->next;
+		}
+	}
+
+	// Overall progress starts over once the loader is idle
+	if (dev->loadGroups == NULL) {
+		dev->totalAssets = 0;
+		dev->finishedAssets = 0;
+	}
+	if (removed)
+		SDL_BroadcastCondition(dev->doneCondition);
+}
+
+// Marks assets as loaded once their uploads have finished
+static void _vk2dAssetsFinish(VK2DLogicalDevice dev, _VK2DLoadGroup **groups, int count) {
+	SDL_LockMutex(dev->loadListMutex);
+	for (int i = 0; i < count; i++)
+		groups[i]->loads--;
+	dev->finishedAssets += count;
+	_vk2dLoadGroupsPrune(dev);
+	SDL_UnlockMutex(dev->loadListMutex);
+}
+
 int _vk2dWorkerThread(void *data) {
 	// Data is the logical device
-	VK2DLogicalDevice dev = gDeviceFromMainThread;
-	int loaded = 0;
-
-	// Setup the command pool
-	VkCommandPoolCreateInfo commandPoolCreateInfo2 = vk2dInitCommandPoolCreateInfo(dev->pd->QueueFamily.graphicsFamily, VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
-	VkResult result = vkCreateCommandPool(dev->dev, &commandPoolCreateInfo2, VK_NULL_HANDLE, &dev->loadPool);
-    if (result != VK_SUCCESS) {
-        vk2dRaise(VK2D_STATUS_VULKAN_ERROR, "Failed to create command buffer for worker thread.");
-    }
+	VK2DLogicalDevice dev = data;
+
+	// Each thread records its uploads into its own batch and only submits every so often, the
+	// batch only lives while there's work since these threads outlive the renderer's allocator
+	VK2DUploadBatch batch = NULL;
+	_VK2DLoadGroup *pending[VK2D_UPLOAD_BATCH_ASSETS];
+	int pendingCount = 0;
+
 	while (SDL_GetAtomicInt(&dev->quitThread) == 0) {
-		if (SDL_GetAtomicInt(&dev->loads) > 0) {
-			// Find an asset to load
-			VK2DAssetLoad asset = {0};
-			int spot = -1;
-			bool found = false;
+		_VK2DLoadGroup *group;
+		VK2DAssetLoad *asset = _vk2dAssetQueuePop(&dev->assetQueue, &group);
+
+		// Sleep until there is something to load, but send off anything batched up first
+		if (asset == NULL && pendingCount > 0) {
+			vk2dUploadBatchFlush(batch);
+			_vk2dAssetsFinish(dev, pending, pendingCount);
+			pendingCount = 0;
+			continue;
+		} else if (asset == NULL) {
+			vk2dUploadBatchFree(batch);
+			batch = NULL;
 			SDL_LockMutex(dev->loadListMutex);
-			for (int i = 0; i < SDL_GetAtomicInt(&dev->loadListSize) && !found; i++) {
-				if (dev->loadList[i].state == VK2D_ASSET_TYPE_ASSET) {
-					spot = i;
-					// This ensures that models will always be prioritized last
-					if (dev->loadList[i].type != VK2D_ASSET_TYPE_MODEL_FILE && dev->loadList[i].type != VK2D_ASSET_TYPE_MODEL_MEMORY)
-						found = true;
-				}
-			}
-
-			// Remove this asset from the list kinda
-			dev->loadList[spot].state = VK2D_ASSET_TYPE_PENDING;
-			memcpy(&asset, &dev->loadList[spot], sizeof(VK2DAssetLoad));
-
-			SDL_AddAtomicInt(&dev->loads, -1);
+			while (SDL_GetAtomicInt(&dev->quitThread) == 0 && _vk2dAssetQueueEmpty(&dev->assetQueue))
+				SDL_WaitCondition(dev->loadCondition, dev->loadListMutex);
 			SDL_UnlockMutex(dev->loadListMutex);
-
-			// Now we load the asset based on its type
-			if (asset.type == VK2D_ASSET_TYPE_TEXTURE_FILE) {
-				uint32_t size;
-				uint8_t *fileData = _vk2dLoadFile(asset.Load.filename, &size);
-				*asset.Output.texture = _vk2dTextureFromInternal(fileData, size, false);
-				if (*asset.Output.texture == NULL)
-                    vk2dLog("Failed to load texture \"%s\".", asset.Load.filename);
-				free(fileData);
-			} else if (asset.type == VK2D_ASSET_TYPE_TEXTURE_MEMORY) {
-				*asset.Output.texture = _vk2dTextureFromInternal(asset.Load.data, asset.Load.size, false);
-				if (*asset.Output.texture == NULL)
-                    vk2dLog("Failed to load texture from buffer.");
-			} else if (asset.type == VK2D_ASSET_TYPE_MODEL_FILE) {
-				uint32_t size;
-				uint8_t *fileData = _vk2dLoadFile(asset.Load.filename, &size);
-				*asset.Output.model = _vk2dModelFromInternal(fileData, size, *asset.Data.Model.tex, false);
-				if (*asset.Output.model == NULL)
-                    vk2dLog("Failed to load model \"%s\".", asset.Load.filename);
-				free(fileData);
-			} else if (asset.type == VK2D_ASSET_TYPE_MODEL_MEMORY) {
-				*asset.Output.model = _vk2dModelFromInternal(asset.Load.data, asset.Load.size, *asset.Data.Model.tex, false);
-				if (*asset.Output.model == NULL)
-                    vk2dLog("Failed to load model from buffer.");
-			} else if (asset.type == VK2D_ASSET_TYPE_SHADER_FILE) {
-				// Shaders are internally synchronized
-				*asset.Output.shader = vk2dShaderLoad(asset.Load.filename, asset.Load.fragmentFilename, asset.Data.Shader.uniformBufferSize);
-			} else if (asset.type == VK2D_ASSET_TYPE_SHADER_MEMORY) {
-				// Shaders are internally synchronized
-				*asset.Output.shader = vk2dShaderFrom(asset.Load.data, asset.Load.size, asset.Load.fragmentData, asset.Load.fragmentSize, asset.Data.Shader.uniformBufferSize);
-			}
-
-			loaded++;
-			gLoadStatus = (float)loaded / (float)SDL_GetAtomicInt(&dev->loadListSize);
+			continue;
 		}
 
-		// Signify the end of loading
-		if (SDL_GetAtomicInt(&dev->loads) == 0 && loaded > 0) {
-			SDL_LockMutex(dev->loadListMutex);
-
-            SDL_SetAtomicInt(&dev->doneLoading, 1);
+		// Keep the queue topped up for the other threads before starting on this one
+		SDL_LockMutex(dev->loadListMutex);
+		dev->queuedAssets--;
+		_vk2dAssetQueueFill(dev);
+		const bool cancelled = group->cancelled;
+		SDL_UnlockMutex(dev->loadListMutex);
 
-			// We now don't need the list anymore so we can delete it
-			free(dev->loadList);
-			dev->loadList = NULL;
-			SDL_SetAtomicInt(&dev->loads, 0);
-			SDL_SetAtomicInt(&dev->loadListSize, 0);
+		// If there's no batch nothing can be uploaded so the asset is skipped, vk2dUploadBatchCreate already raised the error
+		if (!cancelled && batch == NULL)
+			batch = vk2dUploadBatchCreate(dev, false);
+		if (!cancelled && batch != NULL)
+			_vk2dAssetLoad(asset, batch);
+		else
+			_vk2dAssetSkip(asset);
+		pending[pendingCount++] = group;
+
+		// Models only need the texture handles so they can be let through before the uploads finish
+		if (!_vk2dAssetIsModel(asset)) {
+			SDL_LockMutex(dev->loadListMutex);
+			if (--group->earlyLoads == 0)
+				_vk2dAssetQueueFill(dev);
 			SDL_UnlockMutex(dev->loadListMutex);
 		}
+
+		if (pendingCount >= VK2D_UPLOAD_BATCH_ASSETS) {
+			vk2dUploadBatchFlush(batch);
+			_vk2dAssetsFinish(dev, pending, pendingCount);
+			pendingCount = 0;
+		}
 	}
 
+	vk2dUploadBatchFree(batch);
 	return 0;
 }
 
-void vk2dAssetsLoad(VK2DAssetLoad *assets, uint32_t count) {
+VK2DAssetGroup vk2dAssetsQueue(VK2DAssetLoad *assets, uint32_t count, int32_t priority) {
 	VK2DLogicalDevice dev = vk2dRendererGetDevice();
 	VK2DRenderer gRenderer = vk2dRendererGetPointer();
+	if (count == 0)
+		return VK2D_INVALID_ASSET_GROUP;
 
 	if (gRenderer->limits.supportsMultiThreadLoading) {
-		// We only accept lists when the current one is done
-		if (SDL_GetAtomicInt(&dev->loadListSize) > 0)
-			return;
+		_VK2DLoadGroup *group = calloc(1, sizeof(struct _VK2DLoadGroup));
+		VK2DAssetLoad *list = malloc(sizeof(VK2DAssetLoad) * count);
+		if (group == NULL || list == NULL) {
+			free(group);
+			free(list);
+			vk2dRaise(VK2D_STATUS_OUT_OF_RAM, "Failed to create load group for worker threads.");
+			return VK2D_INVALID_ASSET_GROUP;
+		}
 
-        SDL_SetAtomicInt(&dev->doneLoading, 0);
+		// Models go last since they may be waiting on a texture from the same group
+		uint32_t j = 0;
+		for (uint32_t i = 0; i < count; i++)
+			if (!_vk2dAssetIsModel(&assets[i]))
+				list[j++] = assets[i];
+		group->earlyCount = j;
+		for (uint32_t i = 0; i < count; i++)
+			if (_vk2dAssetIsModel(&assets[i]))
+				list[j++] = assets[i];
+		group->assets = list;
+		group->count = count;
+		group->earlyLoads = group->earlyCount;
+		group->loads = count;
+		group->priority = priority;
+
+		// Groups go after every group with the same or higher priority so equal priorities load in order
 		SDL_LockMutex(dev->loadListMutex);
-		SDL_SetAtomicInt(&dev->loadListSize, count);
-		SDL_SetAtomicInt(&dev->loads, count);
-		dev->loadList = malloc(sizeof(VK2DAssetLoad) * count);
-		if (dev->loadList == NULL) {
-            vk2dRaise(VK2D_STATUS_OUT_OF_RAM, "Failed to create load list for worker thread.");
-		}
-		memcpy(dev->loadList, assets, sizeof(VK2DAssetLoad) * count);
+		const VK2DAssetGroup id = dev->nextLoadGroup++;
+		group->id = id;
+		_VK2DLoadGroup **link = &dev->loadGroups;
+		while (*link != NULL && (*link)->priority >= priority)
+			link = &(*link)->next;
+		group->next = *link;
+		*link = group;
+		dev->totalAssets += count;
+		_vk2dAssetQueueFill(dev);
 		SDL_UnlockMutex(dev->loadListMutex);
-	} else {
-		for (int i = 0; i < count; i++) {
-			VK2DAssetLoad asset;
-			memcpy(&asset, &assets[i], sizeof(struct VK2DAssetLoad));
-			if (asset.type == VK2D_ASSET_TYPE_TEXTURE_FILE) {
-				uint32_t size;
-				uint8_t *fileData = _vk2dLoadFile(asset.Load.filename, &size);
-				*asset.Output.texture = _vk2dTextureFromInternal(fileData, size, true);
-				if (*asset.Output.texture == NULL)
-                    vk2dLog("Failed to load texture \"%s\".", asset.Load.filename);
-				free(fileData);
-			} else if (asset.type == VK2D_ASSET_TYPE_TEXTURE_MEMORY) {
-				*asset.Output.texture = _vk2dTextureFromInternal(asset.Load.data, asset.Load.size, true);
-				if (*asset.Output.texture == NULL)
-                    vk2dLog("Failed to load texture from buffer.");
-			} else if (asset.type == VK2D_ASSET_TYPE_MODEL_FILE) {
-				uint32_t size;
-				uint8_t *fileData = _vk2dLoadFile(asset.Load.filename, &size);
-				*asset.Output.model = _vk2dModelFromInternal(fileData, size, *asset.Data.Model.tex, true);
-				if (*asset.Output.model == NULL)
-                    vk2dLog("Failed to load model \"%s\".", asset.Load.filename);
-				free(fileData);
-			} else if (asset.type == VK2D_ASSET_TYPE_MODEL_MEMORY) {
-				*asset.Output.model = _vk2dModelFromInternal(asset.Load.data, asset.Load.size, *asset.Data.Model.tex, true);
-				if (*asset.Output.model == NULL)
-                    vk2dLog("Failed to load model from buffer.");
-			} else if (asset.type == VK2D_ASSET_TYPE_SHADER_FILE) {
-				// Shaders are internally synchronized
-				*asset.Output.shader = vk2dShaderLoad(asset.Load.filename, asset.Load.fragmentFilename, asset.Data.Shader.uniformBufferSize);
-			} else if (asset.type == VK2D_ASSET_TYPE_SHADER_MEMORY) {
-				// Shaders are internally synchronized
-				*asset.Output.shader = vk2dShaderFrom(asset.Load.data, asset.Load.size, asset.Load.fragmentData, asset.Load.fragmentSize, asset.Data.Shader.uniformBufferSize);
-			}
+		return id;
+	}
+
+	VK2DUploadBatch batch = vk2dUploadBatchCreate(dev, true);
+	if (batch == NULL)
+		return VK2D_INVALID_ASSET_GROUP;
+	for (int i = 0; i < count; i++) {
+		VK2DAssetLoad asset;
+		memcpy(&asset, &assets[i], sizeof(struct VK2DAssetLoad));
+		_vk2dAssetLoad(&asset, batch);
+	}
+	vk2dUploadBatchFree(batch);
+
+	// Everything is already loaded, the handle is only given out so it can be waited on like any other
+	return dev->nextLoadGroup++;
+}
+
+void vk2dAssetsLoad(VK2DAssetLoad *assets, uint32_t count) {
+	vk2dAssetsQueue(assets, count, 0);
+}
+
+float vk2dAssetsGroupStatus(VK2DAssetGroup group) {
+	VK2DLogicalDevice dev = vk2dRendererGetDevice();
+	float status = 1;
+	SDL_LockMutex(dev->loadListMutex);
+	_VK2DLoadGroup *loadGroup = _vk2dLoadGroupFind(dev, group);
+	if (loadGroup != NULL)
+		status = (float)(loadGroup->count - loadGroup->loads) / (float)loadGroup->count;
+	SDL_UnlockMutex(dev->loadListMutex);
+	return status;
+}
+
+bool vk2dAssetsGroupComplete(VK2DAssetGroup group) {
+	VK2DLogicalDevice dev = vk2dRendererGetDevice();
+	SDL_LockMutex(dev->loadListMutex);
+	const bool complete = _vk2dLoadGroupFind(dev, group) == NULL;
+	SDL_UnlockMutex(dev->loadListMutex);
+	return complete;
+}
+
+void vk2dAssetsGroupWait(VK2DAssetGroup group) {
+	VK2DRenderer gRenderer = vk2dRendererGetPointer();
+	if (gRenderer->limits.supportsMultiThreadLoading) {
+		VK2DLogicalDevice dev = vk2dRendererGetDevice();
+		SDL_LockMutex(dev->loadListMutex);
+		while (_vk2dLoadGroupFind(dev, group) != NULL)
+			SDL_WaitCondition(dev->doneCondition, dev->loadListMutex);
+		SDL_UnlockMutex(dev->loadListMutex);
+	}
+}
+
+void vk2dAssetsCancel(VK2DAssetGroup group) {
+	VK2DRenderer gRenderer = vk2dRendererGetPointer();
+	if (gRenderer->limits.supportsMultiThreadLoading) {
+		VK2DLogicalDevice dev = vk2dRendererGetDevice();
+		SDL_LockMutex(dev->loadListMutex);
+		_VK2DLoadGroup *loadGroup = _vk2dLoadGroupFind(dev, group);
+		if (loadGroup != NULL && !loadGroup->cancelled) {
+			loadGroup->cancelled = true;
+
+			// Nothing past nextToQueue has reached a loader thread yet so it can be skipped right here,
+			// anything already queued is skipped by whichever thread pops it
+			const uint32_t skipped = loadGroup->count - loadGroup->nextToQueue;
+			for (uint32_t i = loadGroup->nextToQueue; i < loadGroup->count; i++)
+				_vk2dAssetSkip(&loadGroup->assets[i]);
+			loadGroup->nextToQueue = loadGroup->count;
+			loadGroup->loads -= skipped;
+			dev->finishedAssets += skipped;
+			_vk2dLoadGroupsPrune(dev);
 		}
+		SDL_UnlockMutex(dev->loadListMutex);
 	}
 }
 
@@ -320,16 +539,21 @@ void vk2dAssetsWait() {
 	VK2DRenderer gRenderer = vk2dRendererGetPointer();
 	if (gRenderer->limits.supportsMultiThreadLoading) {
 		VK2DLogicalDevice dev = vk2dRendererGetDevice();
-		while (SDL_GetAtomicInt(&dev->doneLoading) == 0) {
-			volatile int i = 0;
-		}
+		SDL_LockMutex(dev->loadListMutex);
+		while (dev->loadGroups != NULL)
+			SDL_WaitCondition(dev->doneCondition, dev->loadListMutex);
+		SDL_UnlockMutex(dev->loadListMutex);
 	}
 }
 
 bool vk2dAssetsLoadComplete() {
 	VK2DRenderer gRenderer = vk2dRendererGetPointer();
 	if (gRenderer->limits.supportsMultiThreadLoading) {
-		return SDL_GetAtomicInt(&vk2dRendererGetDevice()->doneLoading) != 0;
+		VK2DLogicalDevice dev = vk2dRendererGetDevice();
+		SDL_LockMutex(dev->loadListMutex);
+		const bool complete = dev->loadGroups == NULL;
+		SDL_UnlockMutex(dev->loadListMutex);
+		return complete;
 	}
 	return true;
 }
@@ -337,7 +561,13 @@ bool vk2dAssetsLoadComplete() {
 float vk2dAssetsLoadStatus() {
 	VK2DRenderer gRenderer = vk2dRendererGetPointer();
 	if (gRenderer->limits.supportsMultiThreadLoading) {
-		return gLoadStatus;
+		VK2DLogicalDevice dev = vk2dRendererGetDevice();
+		float status = 1;
+		SDL_LockMutex(dev->loadListMutex);
+		if (dev->totalAssets > 0)
+			status = (float)dev->finishedAssets / (float)dev->totalAssets;
+		SDL_UnlockMutex(dev->loadListMutex);
+		return status;
 	}
 	return 1;
 }
@@ -5,6 +5,7 @@
 #include <stdbool.h>
 #include <stdio.h>
 #include "VK2D/Structs.h"
+#include "VK2D/Opaque.h"
 
 /// \brief Gets the vertex input information for VK2DVertexTexture (Uses static variables to persist attached descriptions)
 VkPipelineVertexInputStateCreateInfo _vk2dGetTextureVertexInputState();
@@ -33,14 +34,32 @@ bool _vk2dFileExists(const char *filename);
 /// \brief Loads a file into a buffer and returns it (as well as its size)
 unsigned char* _vk2dLoadFile(const char *filename, uint32_t *size);
 
+/// \brief Writes a buffer to a file, replacing it if it exists, and returns whether or not it worked
+bool _vk2dSaveFile(const char *filename, const void *data, size_t size);
+
 /// \brief Copies a string
 unsigned char *_vk2dCopyBuffer(void *buffer, int size);
 
-/// \brief Worker thread for off-thread loading
+/// \brief Creates an asset queue, capacity must be a power of two
+bool _vk2dAssetQueueCreate(_VK2DAssetQueue *queue, uint32_t capacity);
+
+/// \brief Frees an asset queue's slots
+void _vk2dAssetQueueDestroy(_VK2DAssetQueue *queue);
+
+/// \brief Pushes an asset and the group it belongs to onto a queue from any thread, returns false if the queue is full
+bool _vk2dAssetQueuePush(_VK2DAssetQueue *queue, VK2DAssetLoad *asset, _VK2DLoadGroup *group);
+
+/// \brief Pops an asset and its group off a queue from any thread, returns NULL if the queue is empty
+VK2DAssetLoad *_vk2dAssetQueuePop(_VK2DAssetQueue *queue, _VK2DLoadGroup **group);
+
+/// \brief Checks if a queue is empty (which may have changed by the time this returns)
+bool _vk2dAssetQueueEmpty(_VK2DAssetQueue *queue);
+
+/// \brief Worker thread for off-thread loading, data is the logical device
 int _vk2dWorkerThread(void *data);
 
-/// \brief The internal texture creation function
-VK2DTexture _vk2dTextureFromInternal(void *data, int size, bool mainThread);
+/// \brief The internal texture creation function, uploads through batch or right away on the main thread if it's NULL
+VK2DTexture _vk2dTextureFromInternal(void *data, int size, VK2DUploadBatch batch);
 
-/// \brief The internal model creation function
-VK2DModel _vk2dModelFromInternal(const void *objFile, uint32_t objFileSize, VK2DTexture texture, bool mainThread);
\ No newline at end of file
+/// \brief The internal model creation function, uploads through batch or right away on the main thread if it's NULL
+VK2DModel _vk2dModelFromInternal(const void *objFile, uint32_t objFileSize, VK2DTexture texture, VK2DUploadBatch batch);
\ No newline at end of file
@@ -10,4 +10,5 @@
 #include "VK2D/Shader.h"
 #include "VK2D/Model.h"
 #include "VK2D/Camera.h"
-#include "VK2D/ShadowEnvironment.h"
\ No newline at end of file
+#include "VK2D/ShadowEnvironment.h"
+#include "VK2D/SpriteBatch.h"
\ No newline at end of file
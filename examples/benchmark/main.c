@@ -0,0 +1,91 @@
+#define SDL_MAIN_HANDLED
+#include <SDL3/SDL_vulkan.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include "VK2D/VK2D.h"
+
+/************************ Constants ************************/
+
+const int WINDOW_WIDTH  = 800;
+const int WINDOW_HEIGHT = 600;
+const int SPRITE_COUNT  = 100000;
+const int WARMUP_FRAMES = 60;
+const int BENCH_FRAMES  = 600;
+
+// Runs the sprite benchmark with either sprite path, returning the average frame time in ms
+static double runBenchmark(SDL_Window *window, bool computeFree) {
+	VK2DRendererConfig config = {VK2D_MSAA_1X, VK2D_SCREEN_MODE_IMMEDIATE, VK2D_FILTER_TYPE_NEAREST};
+	vec4 clear = {0.0, 0.5, 1.0, 1.0};
+	VK2DStartupOptions options = {
+			.quitOnError = true,
+			.enableDebug = false,
+			.stdoutLogging = true,
+			.vramPageSize = sizeof(VK2DDrawInstance) * (SPRITE_COUNT + 10),
+			.computeFreeSprites = computeFree,
+	};
+	if (vk2dRendererInit(window, config, &options) != VK2D_SUCCESS)
+		return -1;
+
+	VK2DTexture texCaveguy = vk2dTextureLoad("assets/caveguy.png");
+	VK2DDrawCommand *commands = calloc(SPRITE_COUNT, sizeof(VK2DDrawCommand));
+	for (int i = 0; i < SPRITE_COUNT; i++) {
+		commands[i].pos[0] = 400 + sinf(i) * i * 0.005;
+		commands[i].pos[1] = 300 + cosf(i) * i * 0.005;
+		commands[i].scale[0] = 1;
+		commands[i].scale[1] = 1;
+		commands[i].rotation = i * 0.01;
+		commands[i].origin[0] = 8;
+		commands[i].origin[1] = 8;
+		commands[i].colour[0] = 1;
+		commands[i].colour[1] = 1;
+		commands[i].colour[2] = 1;
+		commands[i].colour[3] = 1;
+		commands[i].textureIndex = vk2dTextureGetID(texCaveguy);
+		commands[i].texturePos[2] = 16;
+		commands[i].texturePos[3] = 16;
+	}
+
+	SDL_Event e;
+	uint64_t start = 0;
+	for (int frame = 0; frame < WARMUP_FRAMES + BENCH_FRAMES && !vk2dStatusFatal(); frame++) {
+		while (SDL_PollEvent(&e));
+		if (frame == WARMUP_FRAMES) {
+			vk2dRendererWait();
+			start = SDL_GetPerformanceCounter();
+		}
+
+		vk2dRendererStartFrame(clear);
+		vk2dRendererAddBatch(commands, SPRITE_COUNT);
+		vk2dRendererEndFrame();
+	}
+
+	// Wait on the GPU so the measurement includes the last frames actually being drawn
+	vk2dRendererWait();
+	const double elapsed = (double)(SDL_GetPerformanceCounter() - start) / (double)SDL_GetPerformanceFrequency();
+
+	free(commands);
+	vk2dTextureFree(texCaveguy);
+	vk2dRendererQuit();
+	return (elapsed * 1000) / BENCH_FRAMES;
+}
+
+int main(int argc, const char *argv[]) {
+	// Basic SDL setup
+	SDL_Init(SDL_INIT_EVENTS);
+	SDL_Window *window = SDL_CreateWindow("VK2D Benchmark", WINDOW_WIDTH, WINDOW_HEIGHT, SDL_WINDOW_VULKAN);
+	if (window == NULL)
+		return -1;
+
+	const double computeTime = runBenchmark(window, false);
+	const double computeFreeTime = runBenchmark(window, true);
+
+	printf("%i sprites over %i frames\n", SPRITE_COUNT, BENCH_FRAMES);
+	printf("  Compute sprite path:      %.3fms/frame (%.1f FPS)\n", computeTime, 1000 / computeTime);
+	printf("  Compute-free sprite path: %.3fms/frame (%.1f FPS)\n", computeFreeTime, 1000 / computeFreeTime);
+
+	SDL_DestroyWindow(window);
+	SDL_Quit();
+	return 0;
+}
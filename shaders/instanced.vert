@@ -12,6 +12,7 @@ struct DrawInstance {
 
 layout(push_constant) uniform PushBuffer {
     int cameraIndex;
+    uint culled;
 } push;
 
 layout(set = 0, binding = 0) uniform UniformBufferObject {
@@ -22,6 +23,11 @@ layout(set = 3, binding = 3) readonly buffer ObjectBuffer{
     DrawInstance objects[];
 } objectBuffer;
 
+// Written by the culling pass, maps each drawn sprite to its instance
+layout(std430, set = 3, binding = 4) readonly buffer VisibleBuffer {
+    uint visible[];
+} visibleBuffer;
+
 layout(location = 1) out vec2 fragTexCoord;
 layout(location = 2) out vec4 fragColour;
 layout(location = 3) out uint textureIndex;
@@ -50,7 +56,7 @@ out gl_PerVertex {
 
 void main() {
     vec2 newPos;
-    int instance = gl_VertexIndex / 6;
+    int instance = push.culled != 0 ? int(visibleBuffer.visible[gl_VertexIndex / 6]) : gl_VertexIndex / 6;
     int vertexIndex = gl_VertexIndex % 6;
     newPos.x = vertices[vertexIndex].x * objectBuffer.objects[instance].texturePos.z;
     newPos.y = vertices[vertexIndex].y * objectBuffer.objects[instance].texturePos.w;
@@ -0,0 +1,65 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+#extension GL_EXT_scalar_block_layout : enable
+#extension GL_EXT_nonuniform_qualifier : enable
+
+// Compute-free alternative to instanced.vert, reads draw commands directly and builds
+// the same transform spritebatch.comp would for each vertex
+struct DrawCommand {
+    vec4 texturePos;
+    vec4 colour;
+    vec2 pos;
+    vec2 origin;
+    vec2 scale;
+    float rotation;
+    uint textureIndex;
+};
+
+layout(push_constant) uniform PushBuffer {
+    int cameraIndex;
+} push;
+
+layout(set = 0, binding = 0) uniform UniformBufferObject {
+    mat4 cameras[10];
+} ubo;
+
+layout(std140, set = 3, binding = 3) readonly buffer ObjectBuffer{
+    DrawCommand objects[];
+} objectBuffer;
+
+layout(location = 1) out vec2 fragTexCoord;
+layout(location = 2) out vec4 fragColour;
+layout(location = 3) out uint textureIndex;
+
+vec2 vertices[] = {
+    vec2(0.0f, 0.0f),
+    vec2(1.0f, 0.0f),
+    vec2(1.0f, 1.0f),
+    vec2(1.0f, 1.0f),
+    vec2(0.0f, 1.0f),
+    vec2(0.0f, 0.0f),
+};
+
+out gl_PerVertex {
+    vec4 gl_Position;
+};
+
+void main() {
+    int instance = gl_VertexIndex / 6;
+    int vertexIndex = gl_VertexIndex % 6;
+    DrawCommand draw = objectBuffer.objects[instance];
+
+    // Origin, rotation, and scale as a 2x3 affine
+    draw.origin.x *= -draw.scale.x;
+    draw.origin.y *= draw.scale.y;
+    vec2 origin = {-draw.origin.x + draw.pos.x, draw.origin.y + draw.pos.y};
+    vec2 originTranslation = {draw.origin.x, -draw.origin.y};
+    mat2 rotation = mat2(cos(draw.rotation), sin(draw.rotation), -sin(draw.rotation), cos(draw.rotation));
+
+    vec2 newPos = vertices[vertexIndex] * draw.texturePos.zw * draw.scale;
+    vec2 worldPos = origin + (rotation * (originTranslation + newPos));
+    gl_Position = ubo.cameras[push.cameraIndex] * vec4(worldPos, 1.0, 1.0);
+    fragTexCoord = draw.texturePos.xy + (vertices[vertexIndex] * draw.texturePos.zw);
+    fragColour = draw.colour;
+    textureIndex = draw.textureIndex;
+}
@@ -0,0 +1,65 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+#extension GL_EXT_scalar_block_layout : enable
+#extension GL_EXT_nonuniform_qualifier : enable
+
+// Same as instanced.vert, but reads the packed instance format (VK2DDrawInstanceCompact)
+struct DrawInstance {
+    vec2 xAxis;
+    vec2 yAxis;
+    vec2 translation;
+    uint colour;
+    uint textureIndex;
+    uint texturePosXY;
+    uint texturePosWH;
+};
+
+layout(push_constant) uniform PushBuffer {
+    int cameraIndex;
+    uint culled;
+} push;
+
+layout(set = 0, binding = 0) uniform UniformBufferObject {
+    mat4 cameras[10];
+} ubo;
+
+layout(std430, set = 3, binding = 3) readonly buffer ObjectBuffer{
+    DrawInstance objects[];
+} objectBuffer;
+
+// Written by the culling pass, maps each drawn sprite to its instance
+layout(std430, set = 3, binding = 4) readonly buffer VisibleBuffer {
+    uint visible[];
+} visibleBuffer;
+
+layout(location = 1) out vec2 fragTexCoord;
+layout(location = 2) out vec4 fragColour;
+layout(location = 3) out uint textureIndex;
+
+vec2 vertices[] = {
+    vec2(0.0f, 0.0f),
+    vec2(1.0f, 0.0f),
+    vec2(1.0f, 1.0f),
+    vec2(1.0f, 1.0f),
+    vec2(0.0f, 1.0f),
+    vec2(0.0f, 0.0f),
+};
+
+out gl_PerVertex {
+    vec4 gl_Position;
+};
+
+void main() {
+    int instance = push.culled != 0 ? int(visibleBuffer.visible[gl_VertexIndex / 6]) : gl_VertexIndex / 6;
+    int vertexIndex = gl_VertexIndex % 6;
+    DrawInstance object = objectBuffer.objects[instance];
+    vec2 texturePos = vec2(object.texturePosXY & 0xFFFF, object.texturePosXY >> 16);
+    vec2 textureSize = vec2(object.texturePosWH & 0xFFFF, object.texturePosWH >> 16);
+
+    vec2 newPos = vertices[vertexIndex] * textureSize;
+    vec2 worldPos = (object.xAxis * newPos.x) + (object.yAxis * newPos.y) + object.translation;
+    gl_Position = ubo.cameras[push.cameraIndex] * vec4(worldPos, 1.0, 1.0);
+    fragTexCoord = texturePos + (vertices[vertexIndex] * textureSize);
+    fragColour = unpackUnorm4x8(object.colour);
+    textureIndex = object.textureIndex;
+}
@@ -0,0 +1,38 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+struct ShapeInstance {
+    vec4 colour;
+    vec2 xAxis;
+    vec2 yAxis;
+    vec2 translation;
+};
+
+layout(push_constant) uniform PushBuffer {
+    int cameraIndex;
+    uint culled;
+} push;
+
+layout(set = 0, binding = 0) uniform UniformBufferObject {
+    mat4 cameras[10];
+} ubo;
+
+layout(std430, set = 1, binding = 3) readonly buffer ShapeBuffer {
+    ShapeInstance shapes[];
+} shapeBuffer;
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec4 inColor;
+
+layout(location = 0) out vec4 fragColor;
+
+out gl_PerVertex {
+    vec4 gl_Position;
+};
+
+void main() {
+    ShapeInstance shape = shapeBuffer.shapes[gl_InstanceIndex];
+    vec2 pos = (shape.xAxis * inPosition.x) + (shape.yAxis * inPosition.y) + shape.translation;
+    gl_Position = ubo.cameras[push.cameraIndex] * vec4(pos, inPosition.z, 1.0);
+    fragColor = inColor * shape.colour;
+}
\ No newline at end of file